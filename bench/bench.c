@@ -0,0 +1,859 @@
+/* Microbenchmark Harness for the Core Data Structures
+ *
+ * Build and run with `make bench`. Every benchmark is swept over sizes
+ * 10 .. 1M (structures with a fixed MAX_RIDES array are capped at their
+ * capacity) and reports throughput plus per-operation latency
+ * percentiles. Results are appended to bench_output.txt as CSV so runs
+ * can be diffed to catch regressions.
+ *
+ * Usage: park_bench [max_size] [output_file] [park_map]
+ * A park_map (e.g. from tools/park_gen) adds routing over a real layout.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../include/config.h"
+#include "../include/visitor.h"
+#include "../include/ride_manager.h"
+#include "../include/queue_manager.h"
+#include "../include/priority_queue.h"
+#include "../include/bst.h"
+#include "../include/graph.h"
+#include "../include/file_io.h"
+#include "../include/utils.h"
+#include "../include/metrics.h"
+#include "../include/rate_limiter.h"
+#include "../include/spatial_index.h"
+#include "../include/congestion.h"
+#include "../include/crowd_balancer.h"
+#include "../include/timing_wheel.h"
+#include "../include/virtual_queue.h"
+#include "../include/group_registry.h"
+
+#ifdef _WIN32
+#define NULL_DEVICE "NUL"
+#else
+#define NULL_DEVICE "/dev/null"
+#endif
+
+#define BENCH_OUTPUT_FILE "bench_output.txt"
+#define BENCH_MAX_SIZE 1000000
+#define BENCH_VISITOR_POOL 1024
+#define BENCH_RANGE_WIDTH 32      // Keeps range results under MAX_RIDES
+#define BENCH_SCAN_BUDGET 20000000L  // Node visits allowed per linear-scan run
+#define BENCH_METRIC_BATCH 1000   // Recordings per timed op (one is below timer resolution)
+#define BENCH_CONTRACTION_NODES 50000  // Walkway junctions across three parks
+#define BENCH_BALANCE_RUNS 50         // Optimizer runs per size, a few visitors moved between
+#define BENCH_TIMER_HORIZON 3600      // Timers spread over an hour, ticked through second by second
+#define BENCH_BOOKING_VISITORS 100000 // Visitors holding return times at once
+#define BENCH_PACKING_CYCLES 100000   // Ride cycles dispatched per seat-packing run
+#define BENCH_PACKING_CAPACITY 12     // Seats per cycle of the packed ride
+#define BENCH_REGISTRY_GROUPS 100000  // Groups in the park at once
+#define BENCH_PARTY_SIZE 4            // Visitors per registered group
+
+static const int bench_sizes[] = {10, 100, 1000, 10000, 100000, 1000000};
+#define BENCH_SIZE_COUNT ((int)(sizeof(bench_sizes) / sizeof(bench_sizes[0])))
+
+/* Per-operation latency samples for the benchmark being run */
+static long long* samples = NULL;
+static int sample_count = 0;
+static int sample_capacity = 0;
+static long long run_started = 0;
+
+static FILE* csv_file = NULL;
+static char run_stamp[32];
+static unsigned int rng_state = 12345u;
+
+/* Time one statement into the sample buffer */
+#define TIME_OP(stmt) do {                                      \
+        long long op_start_ = getMonotonicNanos();              \
+        stmt;                                                   \
+        samples[sample_count++] = getMonotonicNanos() - op_start_; \
+    } while (0)
+
+/* Small deterministic PRNG so every run does the same work */
+static unsigned int benchRandom() {
+    rng_state = rng_state * 1103515245u + 12345u;
+    return (rng_state >> 8) & 0xFFFFFF;
+}
+
+static int compareLongLong(const void* a, const void* b) {
+    long long x = *(const long long*)a;
+    long long y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+/* Start a timed run of up to max_ops operations */
+static void beginRun(int max_ops) {
+    if (max_ops > sample_capacity) {
+        long long* grown = (long long*)realloc(samples, sizeof(long long) * max_ops);
+        if (!grown) {
+            fprintf(stderr, "Error: Memory allocation failed for benchmark samples\n");
+            exit(1);
+        }
+        samples = grown;
+        sample_capacity = max_ops;
+    }
+    sample_count = 0;
+    run_started = getMonotonicNanos();
+}
+
+/* Finish a run: sort samples, print a row, append CSV */
+static void endRun(const char* name, int size) {
+    long long elapsed = getMonotonicNanos() - run_started;
+    if (sample_count == 0) return;
+
+    qsort(samples, sample_count, sizeof(long long), compareLongLong);
+
+    long long p50 = samples[(int)(sample_count * 0.50)];
+    long long p99 = samples[(int)(sample_count * 0.99)];
+    long long p999 = samples[(int)(sample_count * 0.999)];
+    long long worst = samples[sample_count - 1];
+    double ops_per_sec = elapsed > 0 ? sample_count * 1e9 / (double)elapsed : 0.0;
+
+    fprintf(stderr, "%-20s %8d %8d %14.0f %10lld %10lld %10lld %12lld\n",
+            name, size, sample_count, ops_per_sec, p50, p99, p999, worst);
+
+    if (csv_file) {
+        fprintf(csv_file, "%s,%s,%d,%d,%lld,%.0f,%lld,%lld,%lld,%lld\n",
+                run_stamp, name, size, sample_count, elapsed, ops_per_sec,
+                p50, p99, p999, worst);
+    }
+}
+
+/* Visitors are reused across queue slots; queues only hold pointers */
+static Visitor* visitor_pool[BENCH_VISITOR_POOL];
+
+static void createVisitorPool() {
+    for (int i = 0; i < BENCH_VISITOR_POOL; i++) {
+        TicketType ticket = (i % 5 == 0) ? TICKET_PREMIUM : TICKET_NORMAL;
+        visitor_pool[i] = createVisitorWithTicket(1000 + i, "Bench Visitor", 1 + i % 10, ticket);
+    }
+}
+
+/* Rides for index structures: only id and wait time matter */
+static Ride* createBenchRides(int count) {
+    Ride* rides = (Ride*)calloc(count, sizeof(Ride));
+    if (!rides) {
+        fprintf(stderr, "Error: Memory allocation failed for benchmark rides\n");
+        exit(1);
+    }
+
+    // Unique wait times in shuffled order so the BST stays reasonably shaped
+    for (int i = 0; i < count; i++) {
+        rides[i].id = i;
+        rides[i].current_wait_time = i;
+        rides[i].capacity = MIN_RIDE_CAPACITY;
+        rides[i].is_operational = 1;
+    }
+    for (int i = count - 1; i > 0; i--) {
+        int j = (int)(benchRandom() % (unsigned int)(i + 1));
+        int tmp = rides[i].current_wait_time;
+        rides[i].current_wait_time = rides[j].current_wait_time;
+        rides[j].current_wait_time = tmp;
+    }
+
+    return rides;
+}
+
+/* Queue: enqueue n, then dequeue n */
+static void benchQueue(int n) {
+    Queue* q = createQueue(1);
+
+    beginRun(n);
+    for (int i = 0; i < n; i++) {
+        TIME_OP(enqueue(q, visitor_pool[i % BENCH_VISITOR_POOL]));
+    }
+    endRun("queue_enqueue", n);
+
+    beginRun(n);
+    for (int i = 0; i < n; i++) {
+        TIME_OP(dequeue(q));
+    }
+    endRun("queue_dequeue", n);
+
+    freeQueue(q);
+}
+
+/* Dual queue: 1 in 5 visitors redeems a return time into the fast-pass lane */
+static void benchDualQueue(int n) {
+    DualQueue* dq = createDualQueue(1, 4);
+
+    beginRun(n);
+    for (int i = 0; i < n; i++) {
+        Visitor* visitor = visitor_pool[i % BENCH_VISITOR_POOL];
+        if (visitor->ticket_type == TICKET_PREMIUM) {
+            TIME_OP(enqueueFastPass(dq, visitor));
+        } else {
+            TIME_OP(enqueueDual(dq, visitor));
+        }
+    }
+    endRun("dual_enqueue", n);
+
+    beginRun(n);
+    for (int i = 0; i < n; i++) {
+        TIME_OP(dequeueDual(dq));
+    }
+    endRun("dual_dequeue", n);
+
+    freeDualQueue(dq);
+}
+
+/* Priority queue: heap array is fixed at MAX_RIDES */
+static void benchPriorityQueue(int n) {
+    Ride* rides = createBenchRides(n);
+    PriorityQueue* pq = createPriorityQueue();
+
+    beginRun(n);
+    for (int i = 0; i < n; i++) {
+        float priority = (float)(benchRandom() % 10000) / 100.0f;
+        TIME_OP(insertWithPriority(pq, &rides[i], priority));
+    }
+    endRun("pq_insert", n);
+
+    beginRun(n);
+    for (int i = 0; i < n; i++) {
+        TIME_OP(extractMax(pq));
+    }
+    endRun("pq_extract_max", n);
+
+    freePriorityQueue(pq);
+    free(rides);
+}
+
+/* Wait-time BST: n inserts, then narrow range queries */
+static void benchBST(int n) {
+    Ride* rides = createBenchRides(n);
+    BSTNode* root = NULL;
+
+    beginRun(n);
+    for (int i = 0; i < n; i++) {
+        TIME_OP(root = insertRide(root, &rides[i]));
+    }
+    endRun("bst_insert", n);
+
+    int queries = n < 10000 ? n : 10000;
+    beginRun(queries);
+    for (int i = 0; i < queries; i++) {
+        int low = (int)(benchRandom() % (unsigned int)n);
+        int count = 0;
+        Ride** found = NULL;
+        TIME_OP(found = findRideInWaitRange(root, low, low + BENCH_RANGE_WIDTH - 1, &count));
+        free(found);
+    }
+    endRun("bst_range_query", n);
+
+    freeBSTNode(root);
+    free(rides);
+}
+
+/* Random point-to-point queries over a loaded graph */
+static void runRouteQueries(Graph* g, const char* name, int size, int* node_ids, int node_count,
+                            PathInfo* (*route)(Graph*, int, int)) {
+    long budget = BENCH_SCAN_BUDGET / (size > 0 ? size : 1);
+    int queries = budget < 10 ? 10 : (budget > 1000 ? 1000 : (int)budget);
+
+    beginRun(queries);
+    for (int i = 0; i < queries; i++) {
+        int from = node_ids[benchRandom() % (unsigned int)node_count];
+        int to = node_ids[benchRandom() % (unsigned int)node_count];
+        PathInfo* path = NULL;
+        TIME_OP(path = route(g, from, to));
+        freePathInfo(path);
+    }
+    endRun(name, size);
+}
+
+/* Dijkstra: ring plus random chords */
+static void benchDijkstra(int n) {
+    Graph* g = createGraph();
+
+    for (int i = 0; i < n; i++) {
+        connectRides(g, i, (i + 1) % n, 50 + (int)(benchRandom() % 200));
+    }
+    for (int i = 0; i < n; i++) {
+        int other = (int)(benchRandom() % (unsigned int)n);
+        if (other != i) connectRides(g, i, other, 100 + (int)(benchRandom() % 400));
+    }
+
+    int* node_ids = (int*)malloc(sizeof(int) * n);
+    for (int i = 0; i < n; i++) node_ids[i] = i;
+    runRouteQueries(g, "dijkstra", n, node_ids, n, dijkstraShortestPath);
+    free(node_ids);
+
+    freeGraph(g);
+}
+
+/* Crowd moves then a fastest-route query: repaired tree vs full rebuild */
+static void benchCongestion(int n) {
+    Graph* g = createGraph();
+
+    for (int i = 0; i < n; i++) {
+        connectRides(g, i, (i + 1) % n, 50 + (int)(benchRandom() % 200));
+    }
+    for (int i = 0; i < n; i++) {
+        int other = (int)(benchRandom() % (unsigned int)n);
+        if (other != i) connectRides(g, i, other, 100 + (int)(benchRandom() % 400));
+    }
+
+    int source = 0;
+    PathInfo* path = findFastestPath(g, source, n / 2);
+    freePathInfo(path);
+
+    int queries = n < 2000 ? n : 2000;
+    beginRun(queries);
+    int moved[10];
+    for (int i = 0; i < queries; i++) {
+        // Ten visitors arrive, then leave on the next query (crowds stay bounded)
+        for (int m = 0; m < 10; m++) {
+            if (!(i & 1)) moved[m] = (int)(benchRandom() % (unsigned int)n);
+            noteCrowdChange(moved[m], (i & 1) ? -1 : 1);
+        }
+        int target = (int)(benchRandom() % (unsigned int)n);
+        TIME_OP(path = findFastestPath(g, source, target));
+        freePathInfo(path);
+    }
+    endRun("fastest_path_repair", n);
+
+    // A rebuild is a full Dijkstra, so large graphs get fewer of them
+    int rebuilds = n > 1000 ? 1000000 / n : queries;
+    if (rebuilds < 3) rebuilds = 3;
+    ShortestPathTree* tree = NULL;
+    beginRun(rebuilds);
+    for (int i = 0; i < rebuilds; i++) {
+        TIME_OP(tree = buildShortestPathTree(g, source));
+        freeShortestPathTree(tree);
+    }
+    endRun("fastest_path_rebuild", n);
+
+    resetCongestion();
+    freeGraph(g);
+}
+
+/* Crowd balancer over a full park of rides with n visitors spread across
+ * every location and thrill preference; a few move between runs */
+static void benchCrowdBalancer(int n) {
+    RideList* rides = createRideList();
+    for (int id = 0; id < MAX_RIDES; id++) {
+        int capacity = MIN_RIDE_CAPACITY + (int)(benchRandom() % 30);
+        addRideToList(rides, createRide(id, "Bench Ride", capacity, 1 + (int)(benchRandom() % 10), 5));
+    }
+
+    int* location = (int*)malloc(sizeof(int) * n);
+    int* thrill = (int*)malloc(sizeof(int) * n);
+    for (int i = 0; i < n; i++) {
+        location[i] = (int)(benchRandom() % MAX_RIDES);
+        thrill[i] = MIN_THRILL_LEVEL + (int)(benchRandom() % MAX_THRILL_LEVEL);
+        noteCrowdIntent(location[i], thrill[i], 1);
+    }
+
+    beginRun(BENCH_BALANCE_RUNS);
+    for (int r = 0; r < BENCH_BALANCE_RUNS; r++) {
+        for (int k = 0; k < 10; k++) {
+            int i = (int)(benchRandom() % (unsigned int)n);
+            noteCrowdIntent(location[i], thrill[i], -1);
+            location[i] = (int)(benchRandom() % MAX_RIDES);
+            noteCrowdIntent(location[i], thrill[i], 1);
+        }
+        TIME_OP(balanceCrowds(rides, NULL, NULL));
+    }
+    endRun("crowd_balance", n);
+
+    for (int i = 0; i < n; i++) {
+        noteCrowdIntent(location[i], thrill[i], -1);
+    }
+    resetCrowdBalancer();
+    free(location);
+    free(thrill);
+    freeRideList(rides);
+}
+
+/* Timing wheel: arm n timers over the next hour, cancel a third, re-arm
+ * a third, then tick through the hour one second at a time */
+static void benchTimingWheel(int n) {
+    Timer* timers = (Timer*)calloc(n, sizeof(Timer));
+    if (!timers) {
+        fprintf(stderr, "Error: Memory allocation failed for benchmark timers\n");
+        exit(1);
+    }
+    resetTimingWheel();
+    time_t start = time(NULL);
+    advanceTimingWheel(start);
+
+    beginRun(n);
+    for (int i = 0; i < n; i++) {
+        TIME_OP(scheduleTimer(&timers[i], start + 1 + benchRandom() % BENCH_TIMER_HORIZON));
+    }
+    endRun("timer_schedule", n);
+
+    beginRun(n);
+    for (int i = 0; i < n; i += 3) {
+        TIME_OP(cancelTimer(&timers[i]));
+    }
+    for (int i = 1; i < n; i += 3) {
+        TIME_OP(scheduleTimer(&timers[i], start + 1 + benchRandom() % BENCH_TIMER_HORIZON));
+    }
+    endRun("timer_cancel_move", n);
+
+    beginRun(BENCH_TIMER_HORIZON);
+    for (int t = 1; t <= BENCH_TIMER_HORIZON; t++) {
+        TIME_OP(advanceTimingWheel(start + t));
+    }
+    endRun("timer_tick", n);
+
+    resetTimingWheel();
+    free(timers);
+}
+
+/* Group registry: n parties of four arrive, then random visitors are
+ * looked up by id and random parties split and merge back together */
+static void benchGroupRegistry(int n) {
+    VisitorGroup** parties = (VisitorGroup**)malloc(sizeof(VisitorGroup*) * n);
+    if (!parties) {
+        fprintf(stderr, "Error: Memory allocation failed for benchmark groups\n");
+        exit(1);
+    }
+    int first_id = reserveVisitorIDs(n * BENCH_PARTY_SIZE);
+
+    beginRun(n);
+    for (int i = 0; i < n; i++) {
+        TIME_OP({
+            parties[i] = createRegisteredGroup();
+            for (int j = 0; j < BENCH_PARTY_SIZE; j++) {
+                addVisitorToGroup(parties[i], createVisitor(first_id + i * BENCH_PARTY_SIZE + j,
+                                                            "Bench Visitor", 1 + j * 3));
+            }
+        });
+    }
+    endRun("group_register", n);
+
+    beginRun(n);
+    for (int i = 0; i < n; i++) {
+        int id = first_id + (int)(benchRandom() % (unsigned int)(n * BENCH_PARTY_SIZE));
+        TIME_OP(findVisitorGroup(id));
+    }
+    endRun("group_visitor_lookup", n);
+
+    beginRun(n);
+    for (int i = 0; i < n; i++) {
+        VisitorGroup* party = parties[benchRandom() % (unsigned int)n];
+        TIME_OP({
+            VisitorGroup* rest = splitGroup(party, BENCH_PARTY_SIZE / 2);
+            mergeGroups(party, rest);
+            freeVisitorGroup(rest);
+        });
+    }
+    endRun("group_split_merge", n);
+
+    freeGroupRegistry();
+    free(parties);
+}
+
+/* Virtual queue at rope drop: n premium visitors book return times across
+ * a full park, then half rebook to a later window and half cancel */
+static void benchVirtualQueue(int n) {
+    RideList* rides = createRideList();
+    Ride* by_id[MAX_RIDES];
+    for (int id = 0; id < MAX_RIDES; id++) {
+        int capacity = MIN_RIDE_CAPACITY + (int)(benchRandom() % 30);
+        by_id[id] = createRide(id, "Bench Ride", capacity, 1 + (int)(benchRandom() % 10), 5);
+        addRideToList(rides, by_id[id]);
+    }
+
+    Visitor** visitors = (Visitor**)malloc(sizeof(Visitor*) * n);
+    if (!visitors) {
+        fprintf(stderr, "Error: Memory allocation failed for benchmark visitors\n");
+        exit(1);
+    }
+    for (int i = 0; i < n; i++) {
+        visitors[i] = createVisitorWithTicket(1000 + i, "Bench Visitor", 5, TICKET_PREMIUM);
+    }
+
+    time_t now = time(NULL);
+    time_t horizon = (time_t)VQUEUE_HORIZON_SLOTS / 2 * VQUEUE_SLOT_SECONDS;
+
+    beginRun(n);
+    for (int i = 0; i < n; i++) {
+        Ride* ride = by_id[benchRandom() % MAX_RIDES];
+        time_t earliest = now + benchRandom() % horizon;
+        TIME_OP(bookReturnTime(visitors[i], ride, earliest));
+    }
+    endRun("return_book", n);
+
+    beginRun(n);
+    for (int i = 0; i < n; i++) {
+        if (i % 2 == 0) {
+            TIME_OP(rebookReturnTime(visitors[i], by_id[benchRandom() % MAX_RIDES],
+                                     getReturnTime(visitors[i]) + VQUEUE_SLOT_SECONDS));
+        } else {
+            TIME_OP(cancelReturnTime(visitors[i]));
+        }
+    }
+    endRun("return_rebook_cancel", n);
+
+    for (int i = 0; i < n; i++) {
+        cancelReturnTime(visitors[i]);
+        freeVisitor(visitors[i]);
+    }
+    free(visitors);
+    resetVirtualQueues();
+    freeRideList(rides);
+}
+
+/* Party sizes as they arrive at a standby line: mostly twos and fours */
+static int benchPartySize() {
+    static const int sizes[] = {1, 2, 2, 2, 3, 3, 4, 4, 4, 5, 6};
+    return sizes[benchRandom() % (sizeof(sizes) / sizeof(sizes[0]))];
+}
+
+/* Seats filled over n cycles of a ride whose standby line never runs dry,
+ * with or without a single-rider lane to pack the gaps parties leave */
+static long runSeatPacking(const char* name, int n, int single_riders) {
+    DualQueue* dq = createDualQueue(1, 4);
+    Visitor* riders[BENCH_PACKING_CAPACITY];
+    Visitor* party[6];
+    int next = 0;
+    long boarded = 0;
+
+    beginRun(n);
+    for (int cycle = 0; cycle < n; cycle++) {
+        while (getQueueSize(dq->regular_queue) < 4 * BENCH_PACKING_CAPACITY) {
+            int size = benchPartySize();
+            for (int i = 0; i < size; i++) party[i] = visitor_pool[next++ % BENCH_VISITOR_POOL];
+            enqueueDualParty(dq, party, size);
+        }
+        while (single_riders && getQueueSize(dq->single_rider_queue) < BENCH_PACKING_CAPACITY) {
+            enqueueSingleRider(dq, visitor_pool[next++ % BENCH_VISITOR_POOL]);
+        }
+
+        int count = 0;
+        TIME_OP(count = boardDualQueue(dq, riders, BENCH_PACKING_CAPACITY));
+        boarded += count;
+    }
+    endRun(name, n);
+
+    freeDualQueue(dq);
+    return boarded;
+}
+
+/* Ride throughput with parties boarding whole, before and after packing
+ * empty seats from the single-rider lane, in riders per hour */
+static void benchSeatPacking(int n) {
+    Ride* ride = createRide(1, "Bench Coaster", BENCH_PACKING_CAPACITY, 5, 0);
+    long parties_only = runSeatPacking("board_parties", n, 0);
+    long packed = runSeatPacking("board_single_rider", n, 1);
+
+    double hours = (double)n * ride->ride_duration / 3600.0;
+    double seats = (double)n * BENCH_PACKING_CAPACITY;
+    fprintf(stderr, "%-20s %d seats, %d s cycles: %.0f riders/h (%.1f%% full) -> %.0f riders/h "
+            "(%.1f%% full) with single riders, +%.0f riders/h\n",
+            "seat_packing", BENCH_PACKING_CAPACITY, ride->ride_duration,
+            parties_only / hours, 100.0 * parties_only / seats, packed / hours,
+            100.0 * packed / seats, (packed - parties_only) / hours);
+    freeRide(ride);
+}
+
+/* Dijkstra vs contraction hierarchy on a generated resort-scale map:
+ * jittered grid rows of walkways joined by a third of the cross paths */
+static void benchContraction(void) {
+    int n = BENCH_CONTRACTION_NODES;
+    int cols = 1;
+    while (cols * cols < n) cols++;
+    Graph* g = createGraph();
+
+    for (int i = 0; i < n; i++) {
+        int col = i % cols;
+        if (col + 1 < cols && i + 1 < n) connectRides(g, i, i + 1, 30 + (int)(benchRandom() % 20));
+        if (i + cols < n && (col == 0 || benchRandom() % 3 == 0)) {
+            connectRides(g, i, i + cols, 30 + (int)(benchRandom() % 20));
+        }
+    }
+
+    beginRun(1);
+    int built = 0;
+    TIME_OP(built = buildGraphHierarchy(g));
+    endRun("contraction_build", n);
+
+    if (built) {
+        int* node_ids = (int*)malloc(sizeof(int) * n);
+        for (int i = 0; i < n; i++) node_ids[i] = i;
+        runRouteQueries(g, "dijkstra_resort", n, node_ids, n, dijkstraShortestPath);
+        runRouteQueries(g, "contraction_resort", n, node_ids, n, findShortestRoute);
+        free(node_ids);
+    }
+
+    freeGraph(g);
+}
+
+/* Dijkstra between rides (ids below MAX_RIDES) of a park map file */
+static void benchParkMap(const char* path) {
+    Graph* g = createGraph();
+
+    beginRun(1);
+    int edges = 0;
+    TIME_OP(edges = loadParkGraph(path, g));
+    endRun("load_park_map", edges);
+
+    int ride_nodes[MAX_RIDES];
+    int ride_count = 0;
+    for (int i = 0; i < MAX_RIDES; i++) {
+        if (hasGraphNode(g, i)) ride_nodes[ride_count++] = i;
+    }
+
+    if (ride_count > 0) {
+        runRouteQueries(g, "dijkstra_park_map", g->num_nodes, ride_nodes, ride_count, dijkstraShortestPath);
+        // loadParkGraph preprocessed it if the map is large enough
+        if (g->hierarchy) {
+            runRouteQueries(g, "contraction_park_map", g->num_nodes, ride_nodes, ride_count, findShortestRoute);
+        }
+    }
+
+    freeGraph(g);
+}
+
+/* Ride list lookup: linear scan, so lookups are limited by a work budget */
+static void benchFindRideById(int n) {
+    Ride* rides = createBenchRides(n);
+    RideList* list = createRideList();
+
+    for (int i = 0; i < n; i++) {
+        addRideToList(list, &rides[i]);
+    }
+
+    long budget = BENCH_SCAN_BUDGET / n;
+    int lookups = budget < 100 ? 100 : (budget > 100000 ? 100000 : (int)budget);
+
+    beginRun(lookups);
+    for (int i = 0; i < lookups; i++) {
+        int id = (int)(benchRandom() % (unsigned int)n);
+        TIME_OP(findRideById(list, id));
+    }
+    endRun("find_ride_by_id", n);
+
+    // Rides belong to the flat array, only the list nodes are freed here
+    RideNode* node = list->head;
+    while (node) {
+        RideNode* next = node->next;
+        free(node);
+        node = next;
+    }
+    free(list);
+    free(rides);
+}
+
+/* Ride history: n rides appended to one visitor */
+static void benchRideHistory(int n) {
+    Visitor* visitor = createVisitor(999, "History Visitor", 5);
+
+    beginRun(n);
+    for (int i = 0; i < n; i++) {
+        TIME_OP(addRideToHistory(visitor, i % MAX_RIDES));
+    }
+    endRun("add_ride_history", n);
+
+    freeVisitor(visitor);
+}
+
+/* Metrics recording: one op = a batch of BENCH_METRIC_BATCH events,
+ * so p50 / BENCH_METRIC_BATCH is the per-event cost */
+static void benchMetrics(int n) {
+    int batches = n / BENCH_METRIC_BATCH;
+    if (batches < 1) return;
+
+    beginRun(batches);
+    for (int i = 0; i < batches; i++) {
+        TIME_OP(for (int j = 0; j < BENCH_METRIC_BATCH; j++) metricAdd(METRIC_ALLOC_QUEUE_NODE, 1));
+    }
+    endRun("metric_add_x1000", n);
+
+    beginRun(batches);
+    for (int i = 0; i < batches; i++) {
+        TIME_OP(for (int j = 0; j < BENCH_METRIC_BATCH; j++) metricObserve(METRIC_DIJKSTRA_SECONDS, 100 + j * 37));
+    }
+    endRun("metric_observe_x1000", n);
+
+    resetMetrics();
+}
+
+/* Rate limiter: one op = BENCH_METRIC_BATCH checks spread over n clients,
+ * so sizes past RATE_LIMIT_TABLE_SIZE exercise eviction */
+static void benchRateLimiter(int n) {
+    static RateLimiter limiter;
+    int batches = n / BENCH_METRIC_BATCH;
+    if (batches < 1) return;
+
+    initRateLimiter(&limiter, RATE_LIMIT_PER_SECOND, RATE_LIMIT_BURST);
+    long long now = getMonotonicNanos();
+    unsigned int client = 0;
+
+    beginRun(batches);
+    for (int i = 0; i < batches; i++) {
+        TIME_OP(for (int j = 0; j < BENCH_METRIC_BATCH; j++) {
+            unsigned int address = client++ % (unsigned int)n;
+            rateLimitAllow(&limiter, &address, sizeof(address), now + j);
+        });
+    }
+    endRun("rate_limit_x1000", n);
+}
+
+/* k-d tree: one build over n random points, then 5-nearest queries */
+static void benchSpatialIndex(int n) {
+    SpatialPoint* points = (SpatialPoint*)malloc(sizeof(SpatialPoint) * n);
+    if (!points) return;
+    for (int i = 0; i < n; i++) {
+        points[i].x = (int)(benchRandom() % 100000);
+        points[i].y = (int)(benchRandom() % 100000);
+        points[i].id = i;
+    }
+
+    SpatialIndex* index = NULL;
+    beginRun(1);
+    TIME_OP(index = buildSpatialIndex(points, n));
+    endRun("kdtree_build", n);
+
+    SpatialMatch matches[5];
+    int queries = n < 100000 ? n : 100000;
+    beginRun(queries);
+    for (int i = 0; i < queries; i++) {
+        int x = (int)(benchRandom() % 100000);
+        int y = (int)(benchRandom() % 100000);
+        TIME_OP(findNearestPoints(index, x, y, 5, NULL, NULL, matches));
+    }
+    endRun("kdtree_nearest_5", n);
+
+    freeSpatialIndex(index);
+    free(points);
+}
+
+/* CSV loaders: one op = loading a whole n-row file */
+static int loaderRepetitions(int n) {
+    int reps = 200000 / n;
+    return reps < 3 ? 3 : (reps > 50 ? 50 : reps);
+}
+
+static void benchLoadRides(int n) {
+    const char* path = "bench_rides.tmp";
+    FILE* file = fopen(path, "w");
+    if (!file) return;
+
+    fprintf(file, "id,name,capacity,thrill_level,wait_time\n");
+    for (int i = 0; i < n; i++) {
+        fprintf(file, "%d,Bench Ride %d,%d,%d,%d\n", i, i,
+                MIN_RIDE_CAPACITY + i % (MAX_RIDE_CAPACITY - MIN_RIDE_CAPACITY + 1),
+                1 + i % 10, i % 90);
+    }
+    fclose(file);
+
+    int reps = loaderRepetitions(n);
+    beginRun(reps);
+    for (int r = 0; r < reps; r++) {
+        RideList* list = createRideList();
+        TIME_OP(loadRidesFromFile(path, list));
+        freeRideList(list);
+    }
+    endRun("load_rides_csv", n);
+
+    remove(path);
+}
+
+static void benchLoadVisitors(int n) {
+    const char* path = "bench_visitors.tmp";
+    FILE* file = fopen(path, "w");
+    if (!file) return;
+
+    fprintf(file, "id,name,thrill_preference\n");
+    for (int i = 0; i < n; i++) {
+        fprintf(file, "%d,Bench Visitor %d,%d\n", 1000 + i, i, 1 + i % 10);
+    }
+    fclose(file);
+
+    int reps = loaderRepetitions(n);
+    beginRun(reps);
+    for (int r = 0; r < reps; r++) {
+        VisitorGroup* group = createVisitorGroup(1);
+        TIME_OP(loadVisitorsFromFile(path, group));
+        freeVisitorGroup(group);
+    }
+    endRun("load_visitors_csv", n);
+
+    remove(path);
+}
+
+/* Run one benchmark across the size sweep, clamping to a capacity */
+static void sweep(void (*bench)(int), int max_size, int capacity) {
+    int last = 0;
+    for (int i = 0; i < BENCH_SIZE_COUNT; i++) {
+        int n = bench_sizes[i];
+        if (n > max_size) break;
+        if (capacity > 0 && n > capacity) n = capacity;
+        if (n == last) continue;  // Already measured at the cap
+        bench(n);
+        last = n;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int max_size = argc > 1 ? atoi(argv[1]) : BENCH_MAX_SIZE;
+    const char* output = argc > 2 ? argv[2] : BENCH_OUTPUT_FILE;
+    if (max_size < bench_sizes[0]) max_size = BENCH_MAX_SIZE;
+
+    // Library code logs to stdout on hot paths; keep it out of the timings
+    fflush(stdout);
+    if (!freopen(NULL_DEVICE, "w", stdout)) {
+        fprintf(stderr, "Warning: could not silence stdout\n");
+    }
+
+    FILE* existing = fopen(output, "r");
+    int write_header = existing == NULL;
+    if (existing) fclose(existing);
+
+    csv_file = fopen(output, "a");
+    if (!csv_file) {
+        fprintf(stderr, "Warning: could not open %s, printing results only\n", output);
+    } else if (write_header) {
+        fprintf(csv_file, "run,benchmark,size,ops,total_ns,ops_per_sec,p50_ns,p99_ns,p999_ns,max_ns\n");
+    }
+
+    time_t now = time(NULL);
+    strftime(run_stamp, sizeof(run_stamp), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+    createVisitorPool();
+
+    fprintf(stderr, "\n%-20s %8s %8s %14s %10s %10s %10s %12s\n",
+            "benchmark", "size", "ops", "ops/sec", "p50 ns", "p99 ns", "p99.9 ns", "max ns");
+    fprintf(stderr, "-------------------------------------------------------------------------------------------------\n");
+
+    sweep(benchQueue, max_size, 0);
+    sweep(benchDualQueue, max_size, 0);
+    sweep(benchPriorityQueue, max_size, MAX_RIDES);
+    sweep(benchBST, max_size, 0);
+    sweep(benchDijkstra, max_size, 0);
+    sweep(benchFindRideById, max_size, 0);
+    sweep(benchRideHistory, max_size, 0);
+    sweep(benchLoadRides, max_size, 0);
+    sweep(benchLoadVisitors, max_size, 0);
+    sweep(benchMetrics, max_size, 0);
+    sweep(benchRateLimiter, max_size, 0);
+    sweep(benchSpatialIndex, max_size, 0);
+    sweep(benchCongestion, max_size, 0);
+    sweep(benchCrowdBalancer, max_size, 0);
+    sweep(benchTimingWheel, max_size, 0);
+    sweep(benchVirtualQueue, max_size, BENCH_BOOKING_VISITORS);
+    sweep(benchGroupRegistry, max_size, BENCH_REGISTRY_GROUPS);
+    benchSeatPacking(max_size < BENCH_PACKING_CYCLES ? max_size : BENCH_PACKING_CYCLES);
+    benchContraction();
+    if (argc > 3) benchParkMap(argv[3]);
+
+    for (int i = 0; i < BENCH_VISITOR_POOL; i++) {
+        freeVisitor(visitor_pool[i]);
+    }
+    free(samples);
+
+    if (csv_file) {
+        fclose(csv_file);
+        fprintf(stderr, "\nResults appended to %s\n", output);
+    }
+
+    return 0;
+}
@@ -5,6 +5,11 @@ echo.
 REM Create build directory if it doesn't exist
 if not exist "build" mkdir build
 
+REM Pack web/ into the binary (precompressed, served without disk reads)
+echo Packing web assets...
+gcc -Wall -Wextra -std=c99 tools/pack_web.c -o pack_web.exe
+pack_web.exe web build/web_assets.c
+
 REM Compile all source files
 echo Compiling source files...
 
@@ -20,13 +25,32 @@ gcc -Wall -Wextra -Iinclude -std=c99 -DMG_ENABLE_PACKED_FS=0 -c src/stack.c -o b
 gcc -Wall -Wextra -Iinclude -std=c99 -DMG_ENABLE_PACKED_FS=0 -c src/bst.c -o build/bst.o
 gcc -Wall -Wextra -Iinclude -std=c99 -DMG_ENABLE_PACKED_FS=0 -c src/file_io.c -o build/file_io.o
 gcc -Wall -Wextra -Iinclude -std=c99 -DMG_ENABLE_PACKED_FS=0 -c src/utils.c -o build/utils.o
-gcc -Wall -Wextra -Iinclude -std=c99 -DMG_ENABLE_PACKED_FS=0 -c src/web_server.c -o build/web_server.o
+gcc -Wall -Wextra -Iinclude -std=c99 -DMG_ENABLE_PACKED_FS=0 -DPARK_EMBEDDED_WEB -c src/web_server.c -o build/web_server.o
+gcc -Wall -Wextra -Iinclude -std=c99 -c build/web_assets.c -o build/web_assets.o
 gcc -Wall -Wextra -Iinclude -std=c99 -DMG_ENABLE_PACKED_FS=0 -c src/web_server_handlers.c -o build/web_server_handlers.o
 gcc -Wall -Wextra -Iinclude -std=c99 -DMG_ENABLE_PACKED_FS=0 -c src/mongoose.c -o build/mongoose.o
+gcc -Wall -Wextra -Iinclude -std=c99 -DMG_ENABLE_PACKED_FS=0 -c src/gate_ingest.c -o build/gate_ingest.o
+gcc -Wall -Wextra -Iinclude -std=c99 -DMG_ENABLE_PACKED_FS=0 -c src/ride_simulator.c -o build/ride_simulator.o
+gcc -Wall -Wextra -Iinclude -std=c99 -DMG_ENABLE_PACKED_FS=0 -c src/wait_history.c -o build/wait_history.o
+gcc -Wall -Wextra -Iinclude -std=c99 -DMG_ENABLE_PACKED_FS=0 -c src/wait_estimator.c -o build/wait_estimator.o
+gcc -Wall -Wextra -Iinclude -std=c99 -DMG_ENABLE_PACKED_FS=0 -c src/park_stats.c -o build/park_stats.o
+gcc -Wall -Wextra -Iinclude -std=c99 -DMG_ENABLE_PACKED_FS=0 -c src/metrics.c -o build/metrics.o
+gcc -Wall -Wextra -Iinclude -std=c99 -DMG_ENABLE_PACKED_FS=0 -c src/trace.c -o build/trace.o
+gcc -Wall -Wextra -Iinclude -std=c99 -DMG_ENABLE_PACKED_FS=0 -c src/response_cache.c -o build/response_cache.o
+gcc -Wall -Wextra -Iinclude -std=c99 -DMG_ENABLE_PACKED_FS=0 -c src/rate_limiter.c -o build/rate_limiter.o
+gcc -Wall -Wextra -Iinclude -std=c99 -DMG_ENABLE_PACKED_FS=0 -c src/spatial_index.c -o build/spatial_index.o
+gcc -Wall -Wextra -Iinclude -std=c99 -DMG_ENABLE_PACKED_FS=0 -c src/congestion.c -o build/congestion.o
+gcc -Wall -Wextra -Iinclude -std=c99 -DMG_ENABLE_PACKED_FS=0 -c src/contraction.c -o build/contraction.o
+gcc -Wall -Wextra -Iinclude -std=c99 -DMG_ENABLE_PACKED_FS=0 -c src/time_to_ride.c -o build/time_to_ride.o
+gcc -Wall -Wextra -Iinclude -std=c99 -DMG_ENABLE_PACKED_FS=0 -c src/crowd_balancer.c -o build/crowd_balancer.o
+gcc -Wall -Wextra -Iinclude -std=c99 -DMG_ENABLE_PACKED_FS=0 -c src/timing_wheel.c -o build/timing_wheel.o
+gcc -Wall -Wextra -Iinclude -std=c99 -DMG_ENABLE_PACKED_FS=0 -c src/virtual_queue.c -o build/virtual_queue.o
+gcc -Wall -Wextra -Iinclude -std=c99 -DMG_ENABLE_PACKED_FS=0 -c src/visitor_exit.c -o build/visitor_exit.o
+gcc -Wall -Wextra -Iinclude -std=c99 -DMG_ENABLE_PACKED_FS=0 -c src/group_registry.c -o build/group_registry.o
 
 echo.
 echo Linking...
-gcc build/main.o build/ride_manager.o build/visitor.o build/visitor_history.o build/queue_manager.o build/dual_queue.o build/priority_queue.o build/graph.o build/stack.o build/bst.o build/file_io.o build/utils.o build/web_server.o build/web_server_handlers.o build/mongoose.o -o park_system.exe -lm -lws2_32
+gcc build/main.o build/ride_manager.o build/visitor.o build/visitor_history.o build/queue_manager.o build/dual_queue.o build/priority_queue.o build/graph.o build/stack.o build/bst.o build/file_io.o build/utils.o build/web_server.o build/web_server_handlers.o build/mongoose.o build/gate_ingest.o build/ride_simulator.o build/wait_history.o build/wait_estimator.o build/park_stats.o build/metrics.o build/trace.o build/response_cache.o build/rate_limiter.o build/spatial_index.o build/congestion.o build/contraction.o build/time_to_ride.o build/crowd_balancer.o build/timing_wheel.o build/virtual_queue.o build/visitor_exit.o build/group_registry.o build/web_assets.o -o park_system.exe -lm -lws2_32
 
 if %errorlevel% == 0 (
     echo.
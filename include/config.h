@@ -4,11 +4,15 @@
 /* System Configuration Constants */
 #define MAX_RIDES 50
 #define MAX_VISITORS 1000
+#define FIRST_VISITOR_ID 1000  // Visitor ids are handed out from here up
 #define MAX_QUEUE_SIZE 500
 #define MAX_NAME_LENGTH 100
 #define MAX_PATH_LENGTH 256
+#define MAX_GRAPH_NODES 1000000  // Rides plus walkway junctions in the park map
 #define MAX_RIDE_CAPACITY 20
 #define MIN_RIDE_CAPACITY 4
+#define RECENT_RIDE_WINDOW 3   // Rides counted as "recently ridden"
+#define HISTORY_RESPONSE_LIMIT 25  // Newest rides returned by the history API
 
 /* Thrill Level Constants */
 #define MIN_THRILL_LEVEL 1
@@ -23,10 +27,86 @@
 #define RIDES_FILE "data/rides.txt"
 #define VISITORS_FILE "data/visitors.txt"
 #define PARK_MAP_FILE "data/park_map.txt"
+#define GATE_EVENTS_FILE "data/gate_events.txt"
+#define GATE_OFFSET_FILE "data/gate_events.offset"  // Bytes of the gate feed already consumed
+#define VISITOR_ARCHIVE_FILE "data/visitor_archive.log"
 
 /* Simulation Constants */
 #define BASE_RIDE_DURATION 5  // minutes
 #define BOARDING_TIME 2       // minutes per group
+#define DEFAULT_CYCLE_SECONDS ((BASE_RIDE_DURATION + BOARDING_TIME) * 60)
+
+/* Wait Estimator Constants */
+#define ESTIMATOR_ALPHA 0.2f       // Weight of the newest dispatch sample
+#define ESTIMATOR_IDLE_FACTOR 3.0f // Gaps above this many cycles are idle time
+
+/* Wait History Constants */
+#define WAIT_HISTORY_MINUTES 1440  // One day of minute buckets per ride
+#define WAIT_HISTOGRAM_BINS 16     // Log-spaced wait bins per bucket
+
+/* Gate Ingest Constants */
+#define INGEST_RING_CAPACITY 4096  // Must be a power of two
+#define INGEST_BATCH_SIZE 256      // Max visitors created per drain
+
+/* Metrics Constants */
+#define MAX_METRICS 96                 // Registry slots, built-ins included
+#define METRIC_SUB_BUCKETS 16          // Histogram buckets per power of two
+#define METRIC_HISTOGRAM_BUCKETS 608   // Covers up to 2^40 ns (about 18 minutes)
+
+/* Trace Constants */
+#define TRACE_RING_SIZE 16384          // Spans kept per thread
+#define TRACE_MAX_THREADS 8
+
+/* Contraction Hierarchy Constants */
+#define CONTRACTION_MIN_NODES 2000            // Smaller maps route with plain Dijkstra
+#define CONTRACTION_WITNESS_SETTLE_LIMIT 200  // Nodes settled per witness search
+
+/* Congestion Constants */
+#define CONGESTION_PERCENT_PER_VISITOR 10  // Walkway slowdown per visitor at either end
+#define CONGESTION_MAX_PERCENT 400         // At most five times the empty walking cost
+#define CONGESTION_TRACKED_SOURCES 8       // Shortest-path trees kept for repair
+#define WALKING_SPEED_MPS 1.3f             // Uncrowded walking speed
+
+/* Crowd Balancing Constants */
+#define CROWD_BALANCE_INTERVAL 10    // Seconds between optimizer runs
+#define CROWD_CANDIDATE_RIDES 6      // Best-ranked rides offered to each visitor class
+#define CROWD_WAIT_SEGMENTS 16       // Linear pieces of each ride's wait curve
+#define CROWD_MAX_DIVERSIONS 32      // Suggestions kept per run
+#define CROWD_COST_SCALE 10          // Priority points to integer flow cost
+
+/* Timing Wheel Constants */
+#define TIMER_WHEEL_BITS 6                         // log2 of the slots per level
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)  // One-second slots on the lowest level
+#define TIMER_WHEEL_LEVELS 4                       // 64^4 seconds (~194 days) of direct reach
+#define VISITOR_IDLE_TIMEOUT 1800                  // Seconds without a move or ride before a visitor is idle
+
+/* Visitor Exit Constants */
+#define VISITOR_MAX_STAY (16 * 3600)        // Seconds after entry a visitor is swept out
+#define VISITOR_EXIT_IDLE_TIMEOUT 7200      // Further idle seconds before an idle visitor is swept out
+#define VISITOR_EXIT_SWEEP_INTERVAL 30      // Seconds between exit sweeps
+
+/* Group Registry Constants */
+#define GROUP_REGISTRY_INITIAL_CAPACITY 64  // Groups (and index slots) before the first growth
+#define MENU_GROUP_SIZE 5                   // Menu-added visitors fill groups of this size
+#define VISITOR_PAGE_DEFAULT 500            // Visitors per GET /api/visitors page without ?limit
+#define VISITOR_PAGE_MAX 5000               // Largest ?limit accepted
+
+/* Virtual Queue Constants */
+#define VQUEUE_SLOT_SECONDS 900      // Length of one bookable return window
+#define VQUEUE_HORIZON_SLOTS 96      // Windows bookable ahead (one day)
+#define VQUEUE_RETURN_SHARE 50       // Percent of a ride's throughput offered as return times
+#define VQUEUE_LATE_GRACE 300        // Seconds after a window closes that it is still honoured
+
+/* Nearby Rides Constants */
+#define NEARBY_DEFAULT_RESULTS 5
+#define NEARBY_MAX_RESULTS 20
+
+/* Admission Control Constants */
+#define RATE_LIMIT_PER_SECOND 50.0     // Requests per client per second (PARK_RATE_LIMIT overrides)
+#define RATE_LIMIT_BURST 100.0         // Requests a client may send at once (a page load)
+#define RATE_LIMIT_TABLE_SIZE 4096     // Client slots, must be a power of two
+#define RATE_LIMIT_PROBES 8            // Slots examined per lookup
+#define MAX_OPEN_CONNECTIONS 256       // Beyond this new connections get 503
 
 /* ANSI Color Codes for Terminal Output */
 #define COLOR_RESET "\033[0m"
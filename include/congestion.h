@@ -0,0 +1,27 @@
+#ifndef CONGESTION_H
+#define CONGESTION_H
+
+#include "config.h"
+#include "graph.h"
+
+/* Crowd-Weighted Walkways
+ * Visitors entering, leaving and moving (visitor.c) keep a per-node head
+ * count and mark the node dirty. Before a fastest-route query the walkways
+ * touching dirty nodes are reweighted, and every cached shortest-path tree
+ * is repaired for just those arcs instead of being recomputed. */
+
+/* Function Prototypes */
+
+// Crowd Tracking
+void noteCrowdChange(int node_id, int delta);
+int getNodeCrowd(int node_id);
+int congestedWeight(int distance, int crowd);
+
+// Routing
+int applyCongestion(Graph* g);
+ShortestPathTree* getRouteTree(Graph* g, int start_id);
+PathInfo* findFastestPath(Graph* g, int start_id, int end_id);
+unsigned long getCongestionVersion(void);
+void resetCongestion(void);
+
+#endif /* CONGESTION_H */
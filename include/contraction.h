@@ -0,0 +1,43 @@
+#ifndef CONTRACTION_H
+#define CONTRACTION_H
+
+#include "config.h"
+#include "graph.h"
+
+/* Contraction Hierarchy
+ * Preprocessing removes nodes one at a time, least important first, and
+ * adds a shortcut between two neighbours whenever the removed node was on
+ * their only shortest connection. Every node then keeps just its arcs to
+ * more important nodes. A query searches upward from both ends and meets
+ * near the top, settling a few hundred nodes instead of the whole park;
+ * shortcuts are expanded back into walkways for the path. Built over
+ * walking distances (not congestion weights); stale once edges are added. */
+
+typedef struct ContractionHierarchy {
+    int capacity;               // g->capacity when built
+    unsigned long topology;     // g->topology_version when built
+    int* rank;                  // Contraction order, -1 for unused ids
+    int* first_arc;             // Upward arcs of v are [first_arc[v], first_arc[v + 1])
+    int* arc_target;
+    int* arc_distance;
+    int* arc_middle;            // Node a shortcut bypasses, -1 for a walkway
+    int arc_count;
+    int shortcut_count;
+
+    // Query scratch: INT_MAX / -1 between queries, reset via touched
+    int* dist_forward;
+    int* dist_backward;
+    int* parent_forward;
+    int* parent_backward;
+    int* touched;
+    int touched_count;
+} ContractionHierarchy;
+
+/* Function Prototypes */
+ContractionHierarchy* buildContractionHierarchy(Graph* g);
+int isContractionHierarchyCurrent(Graph* g, const ContractionHierarchy* ch);
+int hierarchyDistance(ContractionHierarchy* ch, int start_id, int end_id);
+PathInfo* hierarchyShortestPath(ContractionHierarchy* ch, int start_id, int end_id);
+void freeContractionHierarchy(ContractionHierarchy* ch);
+
+#endif /* CONTRACTION_H */
@@ -0,0 +1,54 @@
+#ifndef CROWD_BALANCER_H
+#define CROWD_BALANCER_H
+
+#include <time.h>
+#include "config.h"
+#include "graph.h"
+#include "ride_manager.h"
+#include "queue_manager.h"
+
+/* Park-Wide Crowd Balancing
+ * Visitors are grouped into classes by the ride they stand at and their
+ * thrill preference; visitor.c keeps each class's head count as visitors
+ * enter, leave and move, so a run never walks the visitor lists. Left
+ * alone, a class heads for the candidate calculatePriority ranks first at
+ * today's waits, and the headliners fill up. The balancer routes every
+ * class through a min-cost flow instead:
+ *   source -> class (head count) -> candidate ride (walk and thrill terms
+ *   of calculatePriority) -> sink (predicted wait, rising as riders join)
+ * Where the flow sends part of a class somewhere other than its first
+ * choice, a diversion is reported. Runs are skipped while no visitor,
+ * ride, queue or walkway changed; otherwise the network and flow from
+ * the last run are kept and only the changes are rerouted. The network
+ * is rebuilt when the open rides or the map change. Park thread only. */
+
+typedef struct Diversion {
+    int location;        // Ride the diverted visitors stand at
+    int from_ride;       // Their first choice
+    int to_ride;         // Where the plan sends them
+    int visitors;
+    int intended_wait;   // Minutes at from_ride if they keep to it anyway
+    int suggested_wait;  // Minutes at to_ride under the plan
+} Diversion;
+
+typedef struct BalancePlan {
+    time_t computed_at;        // 0 until the first run
+    long long solve_nanos;
+    int visitors;              // Visitors the plan covers
+    int classes;
+    int rides;                 // Open rides considered
+    int max_wait_before;       // Longest predicted wait, everyone at their first choice
+    int max_wait_after;        // Longest predicted wait under the plan
+    int diverted;              // Visitors sent away from their first choice
+    Diversion diversions[CROWD_MAX_DIVERSIONS];  // Largest first
+    int diversion_count;
+} BalancePlan;
+
+/* Function Prototypes */
+void noteCrowdIntent(int location, int thrill_preference, int delta);
+const BalancePlan* balanceCrowds(RideList* rides, DualQueue** queues, Graph* g);
+void runCrowdBalancer(RideList* rides, DualQueue** queues, Graph* g);
+const BalancePlan* getBalancePlan(void);
+void resetCrowdBalancer(void);
+
+#endif /* CROWD_BALANCER_H */
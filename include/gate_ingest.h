@@ -0,0 +1,43 @@
+#ifndef GATE_INGEST_H
+#define GATE_INGEST_H
+
+#include "config.h"
+#include "visitor.h"
+
+/* Gate Event (one turnstile entry or exit) */
+typedef struct GateEvent {
+    char name[MAX_NAME_LENGTH];
+    int thrill_preference;
+    int ticket_type;
+    int exit_visitor_id;             // Visitor leaving, 0 for an entry
+    long feed_offset;                // Feed offset just past this event's line
+} GateEvent;
+
+/* Lock-free Single-Producer/Single-Consumer Ring Buffer
+ * The reader thread only writes tail, the park thread only writes head.
+ * Head and tail live on separate cache lines so the two threads don't
+ * fight over the same line while a burst is streaming in. */
+typedef struct IngestRing {
+    GateEvent slots[INGEST_RING_CAPACITY];
+    unsigned int head;               // Next slot to read (consumer-owned)
+    char pad[64];
+    unsigned int tail;               // Next slot to write (producer-owned)
+    unsigned int dropped;            // Malformed lines skipped by producer
+} IngestRing;
+
+/* Function Prototypes */
+
+// Ring Operations
+void initIngestRing(IngestRing* ring);
+int ingestRingPush(IngestRing* ring, const GateEvent* event);
+int ingestRingPopBatch(IngestRing* ring, GateEvent* out, int max_events);
+int ingestRingSize(IngestRing* ring);
+
+// Gate Ingest Thread
+int startGateIngest(const char* filename);
+void stopGateIngest(void);
+int drainGateIngest(int max_batch);
+int gateIngestPending(void);
+int parseGateEvent(char* line, GateEvent* event);
+
+#endif /* GATE_INGEST_H */
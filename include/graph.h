@@ -3,11 +3,13 @@
 
 #include "config.h"
 #include "ride_manager.h"
+#include "spatial_index.h"
 
 /* Edge Structure */
 typedef struct Edge {
     int destination_id;
     int distance;  // In meters
+    int weight;    // Congested walking cost in meters (equals distance when empty)
     struct Edge* next;
 } Edge;
 
@@ -15,12 +17,28 @@ typedef struct Edge {
 typedef struct GraphNode {
     int ride_id;
     Edge* edges;  // Linked list of edges
+    int x;        // Position in meters (park_map.txt extra columns)
+    int y;
+    int has_location;
 } GraphNode;
 
-/* Graph Structure */
+struct ContractionHierarchy;
+
+/* Graph Structure
+ * nodes is indexed by node id and grows on demand. Ids below MAX_RIDES
+ * are rides (0 is the entrance); larger ids are walkway junctions.
+ * Located nodes are indexed in two k-d trees (rides only, and every
+ * node), rebuilt on the next query after a location changes. Large maps
+ * also get a contraction hierarchy for point-to-point routes. */
 typedef struct Graph {
-    GraphNode* nodes[MAX_RIDES];
+    GraphNode** nodes;
+    int capacity;   // Length of the nodes array
     int num_nodes;
+    SpatialIndex* ride_index;
+    SpatialIndex* node_index;
+    int index_stale;
+    unsigned long topology_version;  // Bumped when edges are added
+    struct ContractionHierarchy* hierarchy;  // NULL until built, ignored once stale
 } Graph;
 
 /* Path Structure for Dijkstra */
@@ -30,6 +48,27 @@ typedef struct PathInfo {
     int total_distance;
 } PathInfo;
 
+/* Shortest-Path Tree over edge weights from one source
+ * Kept alive between queries and repaired in place when weights change:
+ * only subtrees hanging off a heavier tree edge are recomputed, and
+ * lighter edges seed a Dijkstra pass that stops where nothing improves. */
+typedef struct ShortestPathTree {
+    int source;
+    int* dist;                  // INT_MAX if unreachable
+    int* parent;                // -1 for the source and unreachable nodes
+    unsigned char* affected;    // Repair scratch, all zero between repairs
+    int capacity;               // g->capacity when built
+    unsigned long topology;     // g->topology_version when built
+} ShortestPathTree;
+
+/* One directed arc whose weight changed */
+typedef struct EdgeChange {
+    int from_id;
+    int to_id;
+    int old_weight;
+    int new_weight;
+} EdgeChange;
+
 /* Function Prototypes */
 
 // Graph Creation and Management
@@ -44,9 +83,26 @@ void displayPath(int path[], int path_length, RideList* rides);
 
 // Pathfinding Algorithms
 PathInfo* dijkstraShortestPath(Graph* g, int start_id, int end_id);
-int* findNearestRides(Graph* g, int current_location, int n, int* count);
+PathInfo* findShortestRoute(Graph* g, int start_id, int end_id);
+int buildGraphHierarchy(Graph* g);
+int walkingDistances(Graph* g, int start_id, const int targets[], int count, int distances[]);
 int calculateTotalDistance(int path[], int path_length, Graph* g);
 
+// Dynamic Shortest Paths (edge weights)
+ShortestPathTree* buildShortestPathTree(Graph* g, int source_id);
+int isShortestPathTreeCurrent(Graph* g, ShortestPathTree* tree);
+int repairShortestPathTree(Graph* g, ShortestPathTree* tree, const EdgeChange changes[], int count);
+PathInfo* pathFromTree(ShortestPathTree* tree, int end_id);
+void freeShortestPathTree(ShortestPathTree* tree);
+
+// Spatial Queries
+void setNodeLocation(Graph* g, int node_id, int x, int y);
+int getNodeLocation(Graph* g, int node_id, int* x, int* y);
+void syncRideLocations(Graph* g, RideList* rides);
+int* findNearestRides(Graph* g, int current_location, int n, int* count);
+int findNearestRidesAt(Graph* g, int x, int y, int n, SpatialFilter accept, void* context, SpatialMatch* out);
+int findNearestNode(Graph* g, int x, int y);
+
 // Route Optimization
 PathInfo* optimizeVisitorRoute(Graph* g, int start_location, int target_rides[], int count);
 void visualizeRoute(PathInfo* path_info, RideList* rides);
@@ -54,6 +110,7 @@ void visualizeRoute(PathInfo* path_info, RideList* rides);
 // Helper Functions
 int getDistanceBetweenRides(Graph* g, int ride1_id, int ride2_id);
 Edge* findEdge(GraphNode* node, int destination_id);
+int hasGraphNode(Graph* g, int node_id);
 void freePathInfo(PathInfo* path_info);
 
 // Graph Loading
@@ -0,0 +1,39 @@
+#ifndef GROUP_REGISTRY_H
+#define GROUP_REGISTRY_H
+
+#include "config.h"
+#include "visitor.h"
+#include "stack.h"
+
+/* Group Registry
+ * Every group in the park is kept in one growable array (removal swaps the
+ * last group into the hole, so iteration stays dense) and indexed by group
+ * id. Every visitor linked into a group is indexed by visitor id to their
+ * list node, which points back at its group. Both indexes are open-addressing
+ * hash tables that double as they fill and halve as the park empties, so
+ * lookups are O(1) whether the park holds ten groups or 100k. The visitor
+ * index is maintained by the group list operations in visitor.c, and owns
+ * each menu visitor's undo stack, freed when the visitor leaves.
+ * Park thread only. */
+
+/* Function Prototypes */
+
+// Groups
+VisitorGroup* createRegisteredGroup(void);
+int registerGroup(VisitorGroup* group);
+void unregisterGroup(VisitorGroup* group);
+VisitorGroup* findGroupById(int group_id);
+VisitorGroup** getGroups(void);
+int getGroupCount(void);
+void freeGroupRegistry(void);
+
+// Visitor Index
+void indexVisitorNode(VisitorNode* node);
+void unindexVisitorNode(VisitorNode* node);
+VisitorNode* findVisitorNode(int visitor_id);
+Visitor* findVisitorById(int visitor_id);
+VisitorGroup* findVisitorGroup(int visitor_id);
+Stack* getVisitorHistoryStack(int visitor_id);
+int attachVisitorHistoryStack(int visitor_id, Stack* history);
+
+#endif /* GROUP_REGISTRY_H */
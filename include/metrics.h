@@ -0,0 +1,72 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stddef.h>
+#include "config.h"
+#include "utils.h"
+
+/* Runtime Metrics Registry
+ * Fixed table of counters, gauges and latency histograms. Recording is a
+ * relaxed atomic add on a preallocated slot (no locks, no allocation), so
+ * any thread may record while /metrics renders the table in Prometheus
+ * text format. Histograms are log-linear: METRIC_SUB_BUCKETS buckets per
+ * power of two of nanoseconds (about 6% relative error). */
+
+typedef enum MetricType {
+    METRIC_COUNTER,
+    METRIC_GAUGE,
+    METRIC_HISTOGRAM
+} MetricType;
+
+/* Well-known metrics recorded by the core modules (registered up front) */
+typedef enum MetricId {
+    METRIC_DIJKSTRA_CALLS,
+    METRIC_DIJKSTRA_SECONDS,
+    METRIC_SIMULATOR_TICK_SECONDS,
+    METRIC_CROWD_BALANCE_SECONDS,
+    METRIC_TIMERS_PENDING,
+    METRIC_TIMERS_FIRED,
+    METRIC_SEATS_FILLED,
+    METRIC_SEATS_EMPTY,
+    METRIC_SINGLE_RIDERS,
+    METRIC_EXITS_TURNSTILE,        // One per ExitReason, in its order
+    METRIC_EXITS_STAY_LIMIT,
+    METRIC_EXITS_INACTIVE,
+    METRIC_EXITS_OPERATOR,
+    METRIC_ALLOC_VISITOR,
+    METRIC_ALLOC_VISITOR_NODE,
+    METRIC_ALLOC_QUEUE_NODE,
+    METRIC_ALLOC_RIDE,
+    METRIC_BUILTIN_COUNT
+} MetricId;
+
+typedef struct MetricHistogram {
+    unsigned long long buckets[METRIC_HISTOGRAM_BUCKETS];  // Count is their sum
+    unsigned long long sum;     // Nanoseconds
+} MetricHistogram;
+
+typedef struct Metric {
+    const char* name;           // Family name, shared by labelled series
+    const char* help;
+    char labels[64];            // e.g. route="/api/rides", empty if none
+    MetricType type;
+    long long value;            // Counter or gauge value
+    MetricHistogram* histogram;
+} Metric;
+
+/* Function Prototypes */
+
+// Registry
+int registerMetric(MetricType type, const char* name, const char* help, const char* labels);
+void resetMetrics(void);
+
+// Recording (safe from any thread)
+void metricAdd(int id, long long delta);
+void metricSet(int id, long long value);
+void metricObserve(int id, long long nanos);
+void metricObserveSince(int id, long long start_nanos);
+
+// Rendering
+int renderMetrics(StringBuffer* out);
+
+#endif /* METRICS_H */
@@ -0,0 +1,46 @@
+#ifndef PARK_STATS_H
+#define PARK_STATS_H
+
+#include "config.h"
+#include "ride_manager.h"
+#include "visitor.h"
+
+/* Running Park Aggregates
+ * Maintained by the mutation paths in visitor.c and ride_manager.c so that
+ * /api/stats never has to walk the park. Build with -DPARK_STATS_DEBUG to
+ * cross-check every stats request against a full recount. */
+typedef struct ParkStats {
+    int total_visitors;
+    int premium_visitors;
+    double satisfaction_sum;
+    long total_distance;
+    int total_rides;
+    int active_rides;
+    long total_capacity;
+    long total_wait_time;
+    int idle_visitors;
+} ParkStats;
+
+/* Function Prototypes */
+
+// Accessors
+const ParkStats* getParkStats(void);
+void resetParkStats(void);
+
+// Visitor Updates
+void statsVisitorAdded(Visitor* visitor);
+void statsVisitorRemoved(Visitor* visitor);
+void statsVisitorChanged(int distance_delta, float satisfaction_delta);
+void statsVisitorIdleChanged(int delta);
+
+// Ride Updates
+void statsRideAdded(Ride* ride);
+void statsRideRemoved(Ride* ride);
+void statsRideStatusChanged(int was_operational, int is_operational);
+void statsRideWaitChanged(int old_wait, int new_wait);
+void statsRideCapacityChanged(int old_capacity, int new_capacity);
+
+// Debug Verification
+int verifyParkStats(RideList* rides, VisitorGroup* groups[], int group_count);
+
+#endif /* PARK_STATS_H */
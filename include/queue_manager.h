@@ -7,6 +7,7 @@
 /* Queue Node Structure */
 typedef struct QueueNode {
     Visitor* visitor;
+    int party_left;  // Visitors from this one to the end of its party (1 = riding alone)
     struct QueueNode* next;
 } QueueNode;
 
@@ -16,14 +17,27 @@ typedef struct Queue {
     QueueNode* rear;
     int size;
     int ride_id;  // Associated ride ID
+    long next_ticket;  // Sequence number handed to the next enqueued visitor
 } Queue;
 
-/* Dual Queue System (Regular + Fast-Pass) */
+/* Queue Lanes within a DualQueue */
+typedef enum {
+    LANE_REGULAR = 0,
+    LANE_FASTPASS = 1,
+    LANE_SINGLE_RIDER = 2
+} QueueLane;
+
+/* Dual Queue System (Regular + Fast-Pass, plus a Single-Rider lane)
+ * Parties queue back to back and board the same cycle. Single riders do
+ * not take turns in the merge order; they fill the seats parties leave
+ * empty (see boardDualQueue). */
 typedef struct DualQueue {
     Queue* regular_queue;
     Queue* fastpass_queue;
+    Queue* single_rider_queue;
     int ride_id;
     int merge_ratio;  // e.g., 4:1 (4 regular, 1 fast-pass)
+    int regular_served;  // Regular guests boarded since the last fast-pass guest
 } DualQueue;
 
 /* Function Prototypes */
@@ -33,9 +47,12 @@ Queue* createQueue(int ride_id);
 int isEmpty(Queue* q);
 int isFull(Queue* q);
 void enqueue(Queue* q, Visitor* visitor);
+int enqueueParty(Queue* q, Visitor* party[], int count);
+int removeFromQueue(Queue* q, Visitor* visitor);
 Visitor* dequeue(Queue* q);
 Visitor* queue_peek(Queue* q);
 int getQueueSize(Queue* q);
+int getFrontPartySize(Queue* q);
 void freeQueue(Queue* q);
 
 // Display Operations
@@ -51,13 +68,20 @@ void clearQueue(Queue* q);
 // Queue Statistics
 float getAverageWaitTime(Queue* q, int ride_capacity);
 int getPositionInQueue(Queue* q, int visitor_id);
+int getTicketPosition(Queue* q, Visitor* visitor);
 
 // Dual Queue Operations
 DualQueue* createDualQueue(int ride_id, int merge_ratio);
 void enqueueDual(DualQueue* dq, Visitor* visitor);
+void enqueueFastPass(DualQueue* dq, Visitor* visitor);
+int enqueueDualParty(DualQueue* dq, Visitor* party[], int count);
+void enqueueSingleRider(DualQueue* dq, Visitor* visitor);
 Visitor* dequeueDual(DualQueue* dq);
+int boardDualQueue(DualQueue* dq, Visitor* riders[], int seats);
+int leaveDualQueue(DualQueue* dq, Visitor* visitor);
 void displayDualQueueStatus(DualQueue* dq, const char* ride_name);
 void freeDualQueue(DualQueue* dq);
 int getTotalQueueSize(DualQueue* dq);
+int getDualQueuePosition(DualQueue* dq, Visitor* visitor);
 
 #endif /* QUEUE_MANAGER_H */
@@ -0,0 +1,35 @@
+#ifndef RATE_LIMITER_H
+#define RATE_LIMITER_H
+
+#include <stddef.h>
+#include "config.h"
+
+/* Per-Client Token-Bucket Rate Limiter
+ * Clients are hashed into a fixed open-addressing table and only
+ * RATE_LIMIT_PROBES neighbouring slots are ever examined, so a check is
+ * O(1) and memory never grows. Entries expire lazily: a bucket idle long
+ * enough to have refilled completely is indistinguishable from a new one,
+ * so probing simply reuses it. If every probed slot is live, the stalest
+ * one is evicted. Park thread only. */
+
+typedef struct RateBucket {
+    unsigned long long key;     // Hashed client address, 0 if empty
+    double tokens;
+    long long last_ns;          // Last refill (getMonotonicNanos)
+} RateBucket;
+
+typedef struct RateLimiter {
+    RateBucket buckets[RATE_LIMIT_TABLE_SIZE];
+    double per_second;          // Refill rate, <= 0 disables limiting
+    double burst;               // Bucket size
+    long long idle_ns;          // Time to refill from empty (entries older are free)
+    long long rejected;
+    long long evictions;
+} RateLimiter;
+
+/* Function Prototypes */
+void initRateLimiter(RateLimiter* limiter, double per_second, double burst);
+int rateLimitAllow(RateLimiter* limiter, const void* address, size_t length, long long now_ns);
+int rateLimitActiveClients(const RateLimiter* limiter, long long now_ns);
+
+#endif /* RATE_LIMITER_H */
@@ -0,0 +1,56 @@
+#ifndef RESPONSE_CACHE_H
+#define RESPONSE_CACHE_H
+
+#include <stddef.h>
+#include "config.h"
+
+/* Versioned Response Cache
+ * Every mutation path bumps the version of the data domain it touched
+ * (the park_stats hooks for rides and visitors, enqueue/dequeue for
+ * queues). A cached body is served while the versions of all domains it
+ * was built from are unchanged, so a repeat poll costs one copy into the
+ * send buffer. Park thread only: versions and entries are not atomic. */
+
+typedef enum DataDomain {
+    DATA_RIDES,
+    DATA_QUEUES,
+    DATA_VISITORS,
+    DATA_DOMAIN_COUNT
+} DataDomain;
+
+#define DATA_MASK(domain) (1u << (domain))
+
+typedef enum CachedEndpoint {
+    CACHE_RIDES_LIST,
+    CACHE_RIDES_BY_WAIT,
+    CACHE_QUEUES,
+    CACHE_STATS,
+    CACHE_ENDPOINT_COUNT
+} CachedEndpoint;
+
+typedef struct CachedResponse {
+    char* body;
+    size_t length;
+    size_t capacity;
+    unsigned int domains;                          // DATA_MASK bits the body depends on
+    unsigned long versions[DATA_DOMAIN_COUNT];     // Domain versions when built
+    int valid;
+} CachedResponse;
+
+/* Function Prototypes */
+
+// Invalidation
+void markDataChanged(DataDomain domain);
+unsigned long getDataVersion(DataDomain domain);
+
+// Lookup and Store
+const char* getCachedResponse(CachedEndpoint endpoint, size_t* length);
+void storeCachedResponse(CachedEndpoint endpoint, unsigned int domains, const char* body);
+void clearResponseCache(void);
+
+// Statistics
+long getCacheHits(void);
+long getCacheMisses(void);
+float getCacheHitRatio(void);
+
+#endif /* RESPONSE_CACHE_H */
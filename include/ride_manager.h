@@ -2,6 +2,9 @@
 #define RIDE_MANAGER_H
 
 #include "config.h"
+#include "wait_history.h"
+#include "wait_estimator.h"
+#include "timing_wheel.h"
 
 /* Ride Structure */
 typedef struct Ride {
@@ -11,6 +14,9 @@ typedef struct Ride {
     int current_wait_time;           // In minutes
     int thrill_level;                // 1-10 scale
     int distance_from_entrance;      // In meters
+    int x;                           // Position in meters (optional rides.txt columns)
+    int y;
+    int has_location;
     int total_visitors_served;       // Statistics
     int is_operational;              // 1 = open, 0 = closed
     int current_occupancy;           // Number of people in queue
@@ -18,6 +24,9 @@ typedef struct Ride {
     int time_remaining;              // Timer for current ride (in seconds)
     int ride_duration;               // Duration of one ride cycle (in seconds)
     time_t occupied_until_time;      // Unix timestamp when ride will be free
+    Timer cycle_timer;               // Fires at occupied_until_time (ride_simulator.c)
+    WaitHistory* wait_history;       // Minute buckets of past wait times
+    ThroughputEstimate throughput;   // Measured dispatch rate for wait prediction
 } Ride;
 
 /* Ride Node for Linked List */
@@ -49,6 +58,10 @@ void freeRideList(RideList* list);
 
 // Ride Operations
 void updateRideWaitTime(Ride* ride, int queue_size);
+void setRideWaitTime(Ride* ride, int wait_minutes);
+void recordRideDispatch(Ride* ride, int riders, int still_waiting);
+int estimateRideWait(Ride* ride, int position);
+void setRideCapacity(Ride* ride, int capacity);
 void markRideClosed(Ride* ride);
 void markRideOpen(Ride* ride);
 void incrementVisitorCount(Ride* ride, int count);
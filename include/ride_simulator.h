@@ -13,10 +13,16 @@ typedef struct RideDuration {
     int capacity;
 } RideDuration;
 
-/* Simulation Functions */
+/* Simulation Functions
+ * Each ride runs cycles of ride_duration seconds on the timing wheel:
+ * when a cycle ends the next batch boards from its queue, and a ride with
+ * an empty queue stops until wakeRide. Call wakeRide after enqueueing
+ * visitors for a ride or reopening it. */
 void initializeRideSimulator(void);
 void updateRideStatus(RideList* rides, DualQueue** queues);
 void simulateRideCompletion(Ride* ride, DualQueue* queue);
+void startRideCycle(Ride* ride, time_t now);
+void wakeRide(Ride* ride);
 int calculateRideDuration(const char* ride_name);
 void updateQueueWaitTimes(RideList* rides, DualQueue** queues);
 
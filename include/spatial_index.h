@@ -0,0 +1,38 @@
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include "config.h"
+
+/* Static 2-D k-d Tree
+ * Points are stored in one array arranged as an implicit balanced tree:
+ * the middle of every range is the splitting node, alternating x and y
+ * by depth. Building is O(n log n); a k-nearest query visits O(log n + k)
+ * nodes for well-spread points. Coordinates are park metres. */
+
+typedef struct SpatialPoint {
+    int x;
+    int y;
+    int id;
+} SpatialPoint;
+
+typedef struct SpatialIndex {
+    SpatialPoint* points;   // Tree order
+    int count;
+} SpatialIndex;
+
+/* Result of a nearest query, nearest first */
+typedef struct SpatialMatch {
+    int id;
+    long long distance_sq;  // Squared straight-line distance
+} SpatialMatch;
+
+/* Return 1 to accept a candidate (e.g. only open rides) */
+typedef int (*SpatialFilter)(int id, void* context);
+
+/* Function Prototypes */
+SpatialIndex* buildSpatialIndex(const SpatialPoint* points, int count);
+int findNearestPoints(const SpatialIndex* index, int x, int y, int k,
+                      SpatialFilter accept, void* context, SpatialMatch* out);
+void freeSpatialIndex(SpatialIndex* index);
+
+#endif /* SPATIAL_INDEX_H */
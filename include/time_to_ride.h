@@ -0,0 +1,37 @@
+#ifndef TIME_TO_RIDE_H
+#define TIME_TO_RIDE_H
+
+#include "config.h"
+#include "graph.h"
+#include "ride_manager.h"
+
+/* Time-to-Ride Ranking
+ * Walking time from one crowd-aware shortest-path tree (the same cached
+ * trees fastest routing uses) plus each open ride's predicted wait,
+ * soonest first. A ranking is kept per origin until the map, the crowds
+ * or any ride's wait or status changes. Park thread only. */
+
+typedef struct RideTime {
+    int ride_id;
+    int walk_seconds;
+    int wait_minutes;
+    int total_seconds;
+} RideTime;
+
+typedef struct TimeToRideRanking {
+    int origin;
+    int count;
+    RideTime rides[MAX_RIDES];
+    Graph* graph;
+    unsigned long topology;         // Versions the ranking was built from
+    unsigned long congestion;
+    unsigned long rides_version;
+    unsigned long used;             // LRU stamp
+    int valid;
+} TimeToRideRanking;
+
+/* Function Prototypes */
+const TimeToRideRanking* rankRidesByTimeToRide(Graph* g, RideList* rides, int origin);
+void clearTimeToRideCache(void);
+
+#endif /* TIME_TO_RIDE_H */
@@ -0,0 +1,41 @@
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+#include <time.h>
+#include "config.h"
+
+/* Hierarchical Timing Wheel
+ * One-second ticks over TIMER_WHEEL_LEVELS levels of TIMER_WHEEL_SLOTS
+ * slots; level k holds timers due within SLOTS^(k+1) seconds. Timers are
+ * embedded in the structs they belong to (ride cycles, fast-pass return
+ * windows, visitor inactivity) and linked into their slot's circular list,
+ * so scheduling and cancelling are O(1) and a tick only touches the slot
+ * that is due, plus an occasional cascade of one higher-level slot down a
+ * level. Park thread only. */
+
+struct Timer;
+typedef void (*TimerCallback)(struct Timer* timer);
+
+typedef struct Timer {
+    struct Timer* next;          // Slot list links, NULL while not armed
+    struct Timer* prev;
+    time_t expires;              // Unix timestamp the timer is due
+    TimerCallback callback;      // Runs after the timer is unlinked, may be NULL
+    void* owner;                 // Struct the timer is embedded in
+} Timer;
+
+/* Function Prototypes */
+
+// Timers
+void initTimer(Timer* timer, TimerCallback callback, void* owner);
+void scheduleTimer(Timer* timer, time_t expires);
+void cancelTimer(Timer* timer);
+int isTimerArmed(const Timer* timer);
+
+// Wheel
+int advanceTimingWheel(time_t now);
+time_t getTimingWheelTime(void);
+int getPendingTimerCount(void);
+void resetTimingWheel(void);
+
+#endif /* TIMING_WHEEL_H */
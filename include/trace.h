@@ -0,0 +1,69 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "config.h"
+#include "utils.h"
+
+/* Scoped Trace Spans
+ * TRACE_SPAN("name") at the top of a block records one complete event when
+ * the block exits (GCC cleanup attribute). Each thread writes its own ring
+ * of the last TRACE_RING_SIZE spans, so recording takes no locks. While
+ * tracing is off a span costs one relaxed load and a branch; build with
+ * -DPARK_TRACE_DISABLED to compile spans out entirely. Span names must be
+ * string literals or otherwise outlive the ring. */
+
+typedef struct TraceEvent {
+    const char* name;
+    long long start_ns;
+    long long duration_ns;
+} TraceEvent;
+
+typedef struct TraceRing {
+    TraceEvent events[TRACE_RING_SIZE];
+    unsigned long long head;    // Total spans written; slot = head % TRACE_RING_SIZE
+    int thread_id;
+    char thread_name[32];
+} TraceRing;
+
+typedef struct TraceScope {
+    const char* name;           // NULL when tracing was off at entry
+    long long start_ns;
+} TraceScope;
+
+extern int trace_enabled;
+
+/* Function Prototypes */
+
+// Control
+void setTraceEnabled(int enabled);
+int isTraceEnabled(void);
+void setTraceThreadName(const char* name);
+void clearTrace(void);
+
+// Recording
+long long traceTimestamp(void);
+void traceEnd(TraceScope* scope);
+
+// Export
+int renderChromeTrace(StringBuffer* out);
+
+/* Span entry is inline so the disabled path never makes a call */
+static inline TraceScope traceBegin(const char* name) {
+    TraceScope scope = {NULL, 0};
+    if (__atomic_load_n(&trace_enabled, __ATOMIC_RELAXED)) {
+        scope.name = name;
+        scope.start_ns = traceTimestamp();
+    }
+    return scope;
+}
+
+#ifdef PARK_TRACE_DISABLED
+#define TRACE_SPAN(name) ((void)0)
+#else
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SPAN(name) \
+    TraceScope TRACE_CONCAT(trace_scope_, __LINE__) __attribute__((cleanup(traceEnd))) = traceBegin(name)
+#endif
+
+#endif /* TRACE_H */
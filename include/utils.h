@@ -1,6 +1,7 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <stddef.h>
 #include "config.h"
 
 #ifdef min
@@ -13,10 +14,18 @@
 #include "visitor.h"
 #include "graph.h"
 
+/* Growable text buffer (response bodies, metrics and trace export) */
+typedef struct StringBuffer {
+    char* data;
+    size_t length;
+    size_t capacity;
+} StringBuffer;
+
 /* Function Prototypes */
 
 // ID Generation
 int generateVisitorID();
+int reserveVisitorIDs(int count);
 int generateGroupID();
 
 // Calculation Helpers
@@ -27,6 +36,7 @@ int calculateEstimatedWaitTime(int queue_size, int ride_capacity);
 // Time Formatting
 void formatTime(int minutes, char* buffer);
 void getCurrentTimestamp(char* buffer);
+long long getMonotonicNanos();
 
 // Display Helpers
 void displayRideInfo(Ride* ride);
@@ -63,4 +73,8 @@ int max(int a, int b);
 float minf(float a, float b);
 float maxf(float a, float b);
 
+// String Buffer
+int stringBufferAppend(StringBuffer* out, const char* format, ...);
+void freeStringBuffer(StringBuffer* out);
+
 #endif /* UTILS_H */
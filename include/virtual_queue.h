@@ -0,0 +1,51 @@
+#ifndef VIRTUAL_QUEUE_H
+#define VIRTUAL_QUEUE_H
+
+#include <time.h>
+#include "config.h"
+#include "ride_manager.h"
+#include "visitor.h"
+#include "queue_manager.h"
+
+/* Virtual Queue (Return-Time Reservations)
+ * A fast pass is spent on a booked return window rather than on jumping
+ * into the fast-pass lane on the spot. Each ride has a calendar of
+ * VQUEUE_HORIZON_SLOTS windows; a window seats VQUEUE_RETURN_SHARE percent
+ * of what the ride can carry in that time (capacity per cycle times
+ * cycles per window). Free seats are kept in a max segment tree, so the
+ * next window with room at or after a given time is found in O(log slots).
+ * The calendar slides forward as windows pass. A visitor holds at most one
+ * reservation; rebooking takes the new window before releasing the old, so
+ * a failed rebook leaves the booking untouched. Redeeming during the window
+ * joins the ride's fast-pass lane; the window timer drops no-shows.
+ * Park thread only. */
+
+typedef enum ReserveResult {
+    RESERVE_OK = 0,
+    RESERVE_NO_PASS,       // Visitor has no fast pass to spend
+    RESERVE_HELD,          // Already holds a reservation (rebook instead)
+    RESERVE_NONE,          // No reservation to cancel, rebook or redeem
+    RESERVE_FULL,          // No window with room before the horizon
+    RESERVE_CLOSED,        // Ride closed or unknown
+    RESERVE_EARLY,         // Return window not open yet
+    RESERVE_IN_QUEUE,      // Already standing in a ride queue
+    RESERVE_INVALID
+} ReserveResult;
+
+/* Function Prototypes */
+
+// Calendar
+time_t findNextReturnTime(Ride* ride, time_t earliest);
+int getReturnWindowCapacity(Ride* ride);
+
+// Bookings
+ReserveResult bookReturnTime(Visitor* visitor, Ride* ride, time_t earliest);
+ReserveResult rebookReturnTime(Visitor* visitor, Ride* ride, time_t earliest);
+ReserveResult cancelReturnTime(Visitor* visitor);
+ReserveResult redeemReturnTime(Visitor* visitor, DualQueue* queue);
+time_t getReturnTime(const Visitor* visitor);
+const char* getReserveResultMessage(ReserveResult result);
+
+void resetVirtualQueues(void);
+
+#endif /* VIRTUAL_QUEUE_H */
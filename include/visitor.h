@@ -1,7 +1,9 @@
 #ifndef VISITOR_H
 #define VISITOR_H
 
+#include <time.h>
 #include "config.h"
+#include "timing_wheel.h"
 
 /* Forward declaration */
 typedef struct Ride Ride;
@@ -12,13 +14,21 @@ typedef enum {
     TICKET_PREMIUM = 1
 } TicketType;
 
-/* RideHistoryEntry structure for keeping track of rides taken */
+/* RideHistoryEntry - one ride taken, packed into 4 bytes.
+ * Timestamps are delta-encoded against the previous ride (the first entry
+ * against entry_time) and rebuilt from last_ride_time when read. */
 typedef struct RideHistoryEntry {
-    int ride_id;
-    time_t timestamp;
-    struct RideHistoryEntry *next;
+    unsigned short ride_id;
+    unsigned short delta_seconds;    // Saturates at 65535 (~18 hours)
 } RideHistoryEntry;
 
+/* ReturnReservation - a booked return time (see virtual_queue.h) */
+typedef struct ReturnReservation {
+    int ride_id;                     // -1 = none held
+    long slot;                       // Return window: start time / VQUEUE_SLOT_SECONDS
+    Timer window_timer;              // Fires when the window (plus grace) has closed
+} ReturnReservation;
+
 /* Visitor Structure */
 typedef struct Visitor {
     int id;
@@ -31,7 +41,19 @@ typedef struct Visitor {
     TicketType ticket_type;          // Normal or Premium ticket
     int fast_passes_remaining;       // Number of fast passes available
     int entry_time;                  // Time entered park (timestamp)
-    RideHistoryEntry *ride_history_head;  // Stack implementation for ride history
+    int queued_ride_id;              // Ride whose queue the visitor is in, -1 = none
+    int queue_lane;                  // Lane within that ride's queue (QueueLane)
+    long queue_ticket;               // Enqueue sequence number within the lane
+    RideHistoryEntry* ride_history;  // Growable array, oldest ride first
+    int history_count;
+    int history_capacity;
+    time_t last_ride_time;           // Timestamp of the newest history entry
+    unsigned char recent_rides[(MAX_RIDES + 7) / 8];  // Bitset of rides in the recent window
+    int is_idle;                     // No move or ride for VISITOR_IDLE_TIMEOUT seconds
+    Timer idle_timer;                // Restarted by every move or ride
+    Timer stay_timer;                // Fires VISITOR_MAX_STAY after entry_time
+    int pending_exit;                // ExitReason awaiting the exit sweep, 0 = none
+    ReturnReservation reservation;   // At most one return time held at once
 } Visitor;
 
 /* Visitor Node for Doubly Linked List */
@@ -39,6 +61,7 @@ typedef struct VisitorNode {
     Visitor* visitor;
     struct VisitorNode* next;
     struct VisitorNode* prev;
+    struct VisitorGroup* group;      // Group the node is linked into
 } VisitorNode;
 
 /* Visitor Group Structure (Doubly Linked List) */
@@ -48,6 +71,7 @@ typedef struct VisitorGroup {
     int size;
     int group_id;
     float average_thrill_preference;
+    int registry_slot;               // Index in the group registry, -1 = not registered
 } VisitorGroup;
 
 /* Function Prototypes */
@@ -59,12 +83,18 @@ void freeVisitor(Visitor* visitor);
 void displayVisitorInfo(Visitor* visitor);
 void updateVisitorLocation(Visitor* visitor, int new_location);
 void updateVisitorStats(Visitor* visitor, int distance, float satisfaction);
+void setVisitorSatisfaction(Visitor* visitor, float satisfaction);
+void startVisitorTimers(Visitor* visitor);
+void touchVisitor(Visitor* visitor);
+void stopVisitorTimers(Visitor* visitor);
 const char* getTicketTypeName(TicketType type);
 
 // Visitor Group Operations (Doubly Linked List)
 VisitorGroup* createVisitorGroup(int group_id);
 void addVisitorToGroup(VisitorGroup* group, Visitor* visitor);
+void appendVisitorsToGroup(VisitorGroup* group, Visitor* visitors[], int count);
 void removeVisitorFromGroup(VisitorGroup* group, int visitor_id);
+void removeVisitorNode(VisitorGroup* group, VisitorNode* node);
 Visitor* findVisitorInGroup(VisitorGroup* group, int visitor_id);
 void displayGroup(VisitorGroup* group);
 void displayGroupReverse(VisitorGroup* group);
@@ -78,7 +108,8 @@ void calculateGroupPreference(VisitorGroup* group);
 
 // Ride History Operations
 void addRideToHistory(Visitor* visitor, int ride_id);
-RideHistoryEntry* getVisitorRideHistory(Visitor* visitor);
+int getVisitorRideHistory(Visitor* visitor, int ride_ids[], time_t timestamps[], int max_entries);
+int getRideHistoryCount(Visitor* visitor);
 int wasRecentlyRidden(Visitor* visitor, int ride_id);
 int undoLastRide(Visitor* visitor);
 void clearRideHistory(Visitor* visitor);
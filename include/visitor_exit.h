@@ -0,0 +1,56 @@
+#ifndef VISITOR_EXIT_H
+#define VISITOR_EXIT_H
+
+#include "config.h"
+#include "visitor.h"
+#include "queue_manager.h"
+
+/* Visitor Exit Processing
+ * Visitors leave through a turnstile exit event (exitVisitor), or are
+ * swept out once they reach VISITOR_MAX_STAY or have been idle for
+ * VISITOR_EXIT_IDLE_TIMEOUT. Their timers only mark them; the park loop
+ * calls sweepVisitorExits, which looks up each marked visitor in the group
+ * registry at most every VISITOR_EXIT_SWEEP_INTERVAL seconds.
+ * Leaving takes the visitor out of their ride queue, return window, crowd
+ * and congestion counts and group (freeing the group once it is empty),
+ * appends their ride history to VISITOR_ARCHIVE_FILE and frees them, so
+ * memory follows current occupancy. Park thread only. */
+
+typedef enum ExitReason {
+    EXIT_NONE = 0,
+    EXIT_TURNSTILE,        // Exit event from a turnstile
+    EXIT_STAY_LIMIT,       // In the park for VISITOR_MAX_STAY
+    EXIT_INACTIVE,         // No move or ride for too long
+    EXIT_OPERATOR          // Removed by an operator
+} ExitReason;
+
+/* Archive record: one departed visitor, followed by name_length bytes of
+ * name and history_count RideHistoryEntry values (the packed in-memory
+ * history, first delta from entry_time). Appended in native byte order. */
+typedef struct VisitorArchiveRecord {
+    int visitor_id;
+    int entry_time;
+    int exit_time;
+    int rides_completed;
+    int total_distance_traveled;
+    float satisfaction_score;
+    unsigned int history_count;
+    unsigned char reason;          // ExitReason
+    unsigned char ticket_type;
+    unsigned char name_length;
+    unsigned char reserved;
+} VisitorArchiveRecord;
+
+/* Function Prototypes */
+
+void initVisitorExits(DualQueue** queues);
+
+// Exits
+int exitVisitor(int visitor_id, ExitReason reason);
+void markVisitorForExit(Visitor* visitor, ExitReason reason);
+void cancelVisitorExit(Visitor* visitor);
+int sweepVisitorExits(time_t now);
+int getPendingExitCount(void);
+const char* getExitReasonName(ExitReason reason);
+
+#endif /* VISITOR_EXIT_H */
@@ -0,0 +1,25 @@
+#ifndef WAIT_ESTIMATOR_H
+#define WAIT_ESTIMATOR_H
+
+#include <time.h>
+#include "config.h"
+
+/* Observed Ride Throughput (exponentially smoothed) */
+typedef struct ThroughputEstimate {
+    float dispatch_interval;         // Seconds between ride dispatches
+    float riders_per_cycle;          // Riders boarded per full dispatch
+    time_t last_dispatch;            // Unix timestamp of last dispatch, 0 = none yet
+    int samples;                     // Dispatches observed
+} ThroughputEstimate;
+
+/* Function Prototypes */
+
+// Estimator Updates
+void initThroughputEstimate(ThroughputEstimate* est, int capacity, int cycle_seconds);
+void recordDispatch(ThroughputEstimate* est, int riders, int still_waiting, time_t now);
+
+// Wait Prediction (minutes)
+int predictWaitForPosition(const ThroughputEstimate* est, int position);
+int predictDefaultWait(int queue_size, int ride_capacity);
+
+#endif /* WAIT_ESTIMATOR_H */
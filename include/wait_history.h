@@ -0,0 +1,40 @@
+#ifndef WAIT_HISTORY_H
+#define WAIT_HISTORY_H
+
+#include <time.h>
+#include "config.h"
+
+/* One Minute of Wait Samples
+ * count/sum give the mean, bins is a small log-spaced histogram
+ * (see wait_history.c for the bin edges) used for quantiles. */
+typedef struct WaitBucket {
+    long minute;                                 // time / 60 this bucket holds, -1 = empty
+    int sum;                                     // Sum of sampled waits (minutes)
+    unsigned short count;                        // Samples in this minute
+    unsigned short max_wait;                     // Largest sample in this minute
+    unsigned short bins[WAIT_HISTOGRAM_BINS];    // Histogram of sampled waits
+} WaitBucket;
+
+/* Per-Ride Ring of Minute Buckets (fixed memory) */
+typedef struct WaitHistory {
+    WaitBucket buckets[WAIT_HISTORY_MINUTES];
+} WaitHistory;
+
+/* Range Query Result */
+typedef struct WaitSummary {
+    int samples;
+    float average_wait;
+    float quantile_wait;
+} WaitSummary;
+
+/* Function Prototypes */
+
+// History Management
+WaitHistory* createWaitHistory(void);
+void freeWaitHistory(WaitHistory* history);
+void recordWaitSample(WaitHistory* history, time_t when, int wait_minutes);
+
+// Queries
+int queryWaitHistory(WaitHistory* history, time_t from, time_t to, float q, WaitSummary* out);
+
+#endif /* WAIT_HISTORY_H */
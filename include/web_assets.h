@@ -0,0 +1,23 @@
+#ifndef WEB_ASSETS_H
+#define WEB_ASSETS_H
+
+#include <stddef.h>
+
+/* Web UI Files Embedded at Build Time
+ * Generated into build/web_assets.c by tools/pack_web.c; the table is
+ * sorted by path so the server can binary-search it. */
+typedef struct WebAsset {
+    const char* path;                   // URI path, e.g. "/index.html"
+    const char* content_type;
+    const char* etag;                   // Strong ETag of the identity body (quoted)
+    const char* gzip_etag;              // Strong ETag of the gzip body (quoted)
+    const unsigned char* data;
+    size_t size;
+    const unsigned char* gzip_data;     // NULL when gzip did not save 10%
+    size_t gzip_size;
+} WebAsset;
+
+extern const WebAsset web_assets[];
+extern const int web_asset_count;
+
+#endif /* WEB_ASSETS_H */
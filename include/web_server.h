@@ -13,17 +13,28 @@
 /* Web server configuration */
 #define WEB_SERVER_PORT "8000"
 #define WEB_ROOT_DIR "./web"
+#define WEB_ASSET_CACHE_CONTROL "public, max-age=604800"  // Images, scripts, styles
+#define WEB_PAGE_CACHE_CONTROL "no-cache"                 // HTML: revalidate by ETag
 
 /* New handler function declarations */
 void handleGetVisitorHistory(struct mg_connection *c, struct mg_http_message *hm);
 void handleGetRideSuggestions(struct mg_connection *c, struct mg_http_message *hm);
+void handleGetTimeToRide(struct mg_connection *c, struct mg_http_message *hm);
 void handleGetRidesByWaitTime(struct mg_connection *c);
+void handleGetCrowdBalance(struct mg_connection *c);
 void handleFindPath(struct mg_connection *c, struct mg_http_message *hm);
+void handleGetNearbyRides(struct mg_connection *c, struct mg_http_message *hm);
 void handleUndoLastRide(struct mg_connection *c, struct mg_http_message *hm);
+void handleGetWaitHistory(struct mg_connection *c, struct mg_http_message *hm);
+void handleGetQueueStatus(struct mg_connection *c, struct mg_http_message *hm);
+void handleVisitorExit(struct mg_connection *c, struct mg_http_message *hm);
+void handleJoinQueue(struct mg_connection *c, struct mg_http_message *hm);
+void handleReservation(struct mg_connection *c, struct mg_http_message *hm);
+void handleRedeemReservation(struct mg_connection *c, struct mg_http_message *hm);
+void handleGetReturnTimes(struct mg_connection *c, struct mg_http_message *hm);
 
 /* Function prototypes */
-void startWebServer(RideList* rides, VisitorGroup** groups, int* group_count, 
-                   DualQueue** queues, BST* bst, Graph* park_map);
+void startWebServer(RideList* rides, DualQueue** queues, BST* bst, Graph* park_map);
 void stopWebServer(void);
 int isWebServerRunning(void);
 void pollWebServer(void);
@@ -0,0 +1,193 @@
+/* Crowd-Weighted Walkways with Incrementally Repaired Shortest Paths */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/congestion.h"
+#include "../include/trace.h"
+
+static int* node_crowd = NULL;          // Visitors standing at each node
+static unsigned char* node_dirty = NULL;
+static int crowd_capacity = 0;
+static int* dirty_nodes = NULL;         // Nodes whose count changed since the last apply
+static int dirty_count = 0;
+
+static EdgeChange* changes = NULL;
+static int change_capacity = 0;
+
+/* Trees kept for recently routed-from sources, least recently used evicted */
+static ShortestPathTree* trees[CONGESTION_TRACKED_SOURCES];
+static unsigned long tree_used[CONGESTION_TRACKED_SOURCES];
+static unsigned long use_clock = 0;
+static Graph* trees_graph = NULL;
+static unsigned long congestion_version = 0;  // Bumped when any walkway weight changes
+
+/* Grow the per-node arrays so node_id fits */
+static int ensureCrowdCapacity(int node_id) {
+    if (node_id < crowd_capacity) return 1;
+
+    int new_capacity = crowd_capacity ? crowd_capacity : MAX_RIDES;
+    while (new_capacity <= node_id) new_capacity *= 2;
+
+    int* grown_crowd = (int*)realloc(node_crowd, sizeof(int) * new_capacity);
+    if (!grown_crowd) return 0;
+    node_crowd = grown_crowd;
+    unsigned char* grown_dirty = (unsigned char*)realloc(node_dirty, new_capacity);
+    if (!grown_dirty) return 0;
+    node_dirty = grown_dirty;
+    int* grown_list = (int*)realloc(dirty_nodes, sizeof(int) * new_capacity);
+    if (!grown_list) return 0;
+    dirty_nodes = grown_list;
+
+    memset(node_crowd + crowd_capacity, 0, sizeof(int) * (new_capacity - crowd_capacity));
+    memset(node_dirty + crowd_capacity, 0, new_capacity - crowd_capacity);
+    crowd_capacity = new_capacity;
+    return 1;
+}
+
+/* A visitor arrived at (delta 1) or left (delta -1) a node - O(1) */
+void noteCrowdChange(int node_id, int delta) {
+    if (node_id < 0 || node_id >= MAX_GRAPH_NODES) return;
+    if (!ensureCrowdCapacity(node_id)) {
+        fprintf(stderr, "Error: Memory allocation failed for crowd counts\n");
+        return;
+    }
+
+    node_crowd[node_id] += delta;
+    if (!node_dirty[node_id]) {
+        node_dirty[node_id] = 1;
+        dirty_nodes[dirty_count++] = node_id;
+    }
+}
+
+int getNodeCrowd(int node_id) {
+    if (node_id < 0 || node_id >= crowd_capacity) return 0;
+    return node_crowd[node_id] > 0 ? node_crowd[node_id] : 0;
+}
+
+/* Walking cost of a walkway with this many visitors at its two ends */
+int congestedWeight(int distance, int crowd) {
+    long percent = (long)crowd * CONGESTION_PERCENT_PER_VISITOR;
+    if (percent > CONGESTION_MAX_PERCENT) percent = CONGESTION_MAX_PERCENT;
+    return (int)(distance + distance * percent / 100);
+}
+
+/* Record one arc's new weight for the tree repairs */
+static int recordChange(int count, Edge* edge, int from_id, int weight) {
+    if (count == change_capacity) {
+        int new_capacity = change_capacity ? change_capacity * 2 : 256;
+        EdgeChange* grown = (EdgeChange*)realloc(changes, sizeof(EdgeChange) * new_capacity);
+        if (!grown) return -1;
+        changes = grown;
+        change_capacity = new_capacity;
+    }
+
+    changes[count].from_id = from_id;
+    changes[count].to_id = edge->destination_id;
+    changes[count].old_weight = edge->weight;
+    changes[count].new_weight = weight;
+    edge->weight = weight;
+    return count + 1;
+}
+
+static void dropTree(int slot) {
+    freeShortestPathTree(trees[slot]);
+    trees[slot] = NULL;
+}
+
+/* Reweight walkways at dirty nodes and repair every cached tree.
+ * Returns how many arcs changed weight. */
+int applyCongestion(Graph* g) {
+    if (!g || dirty_count == 0) return 0;
+
+    TRACE_SPAN("applyCongestion");
+    int count = 0;
+
+    for (int i = 0; i < dirty_count && count >= 0; i++) {
+        int u = dirty_nodes[i];
+        if (!hasGraphNode(g, u)) continue;
+
+        // Both arcs of each walkway: u -> v here, v -> u from v's list
+        for (Edge* edge = g->nodes[u]->edges; edge && count >= 0; edge = edge->next) {
+            int v = edge->destination_id;
+            int weight = congestedWeight(edge->distance, getNodeCrowd(u) + getNodeCrowd(v));
+            if (weight != edge->weight) count = recordChange(count, edge, u, weight);
+
+            for (Edge* back = g->nodes[v]->edges; back && count >= 0; back = back->next) {
+                if (back->destination_id == u && back->distance == edge->distance && back->weight != weight) {
+                    count = recordChange(count, back, v, weight);
+                }
+            }
+        }
+    }
+    for (int i = 0; i < dirty_count; i++) {
+        node_dirty[dirty_nodes[i]] = 0;
+    }
+    dirty_count = 0;
+
+    for (int slot = 0; slot < CONGESTION_TRACKED_SOURCES; slot++) {
+        if (!trees[slot]) continue;
+        if (count < 0 || trees_graph != g || !repairShortestPathTree(g, trees[slot], changes, count)) {
+            dropTree(slot);  // Rebuilt from scratch on its next query
+        }
+    }
+
+    if (count != 0) congestion_version++;
+    if (count < 0) {
+        fprintf(stderr, "Error: Memory allocation failed for edge changes\n");
+        return 0;
+    }
+    return count;
+}
+
+/* Tree rooted at start_id: cached and current, or built into the LRU slot */
+static ShortestPathTree* getTree(Graph* g, int start_id) {
+    if (trees_graph != g) {
+        resetCongestion();
+        trees_graph = g;
+    }
+
+    int victim = 0;
+    for (int slot = 0; slot < CONGESTION_TRACKED_SOURCES; slot++) {
+        if (trees[slot] && !isShortestPathTreeCurrent(g, trees[slot])) dropTree(slot);
+        if (trees[slot] && trees[slot]->source == start_id) {
+            tree_used[slot] = ++use_clock;
+            return trees[slot];
+        }
+        if (!trees[slot] || (trees[victim] && tree_used[slot] < tree_used[victim])) victim = slot;
+    }
+
+    dropTree(victim);
+    trees[victim] = buildShortestPathTree(g, start_id);
+    tree_used[victim] = ++use_clock;
+    return trees[victim];
+}
+
+/* Least-cost distances from start_id under current crowds (cached, do not free) */
+ShortestPathTree* getRouteTree(Graph* g, int start_id) {
+    if (!hasGraphNode(g, start_id)) return NULL;
+
+    applyCongestion(g);
+    return getTree(g, start_id);
+}
+
+/* Least-cost route under current crowds (total_distance is the cost) */
+PathInfo* findFastestPath(Graph* g, int start_id, int end_id) {
+    if (!hasGraphNode(g, start_id) || !hasGraphNode(g, end_id)) return NULL;
+
+    TRACE_SPAN("findFastestPath");
+    return pathFromTree(getRouteTree(g, start_id), end_id);
+}
+
+/* Changes whenever cached route costs may have changed */
+unsigned long getCongestionVersion(void) {
+    return congestion_version;
+}
+
+/* Drop every cached tree (call before freeing the graph they belong to) */
+void resetCongestion(void) {
+    for (int slot = 0; slot < CONGESTION_TRACKED_SOURCES; slot++) {
+        dropTree(slot);
+    }
+    trees_graph = NULL;
+    congestion_version++;
+}
@@ -0,0 +1,576 @@
+/* Contraction Hierarchy over the Park Map */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "../include/contraction.h"
+#include "../include/trace.h"
+
+/* Min-heap of (key, node); keys may be negative (contraction priorities) */
+typedef struct KeyHeap {
+    int* key;
+    int* node_id;
+    int size;
+    int capacity;
+} KeyHeap;
+
+static int keyHeapPush(KeyHeap* heap, int key, int node_id) {
+    if (heap->size == heap->capacity) {
+        int new_capacity = heap->capacity ? heap->capacity * 2 : 64;
+        int* grown_key = (int*)realloc(heap->key, sizeof(int) * new_capacity);
+        if (!grown_key) return 0;
+        heap->key = grown_key;
+        int* grown_node = (int*)realloc(heap->node_id, sizeof(int) * new_capacity);
+        if (!grown_node) return 0;
+        heap->node_id = grown_node;
+        heap->capacity = new_capacity;
+    }
+
+    int i = heap->size++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (heap->key[parent] <= key) break;
+        heap->key[i] = heap->key[parent];
+        heap->node_id[i] = heap->node_id[parent];
+        i = parent;
+    }
+    heap->key[i] = key;
+    heap->node_id[i] = node_id;
+    return 1;
+}
+
+static void keyHeapPop(KeyHeap* heap, int* key, int* node_id) {
+    *key = heap->key[0];
+    *node_id = heap->node_id[0];
+
+    int last_key = heap->key[--heap->size];
+    int last_node = heap->node_id[heap->size];
+    int i = 0;
+
+    while (1) {
+        int child = 2 * i + 1;
+        if (child >= heap->size) break;
+        if (child + 1 < heap->size && heap->key[child + 1] < heap->key[child]) child++;
+        if (heap->key[child] >= last_key) break;
+        heap->key[i] = heap->key[child];
+        heap->node_id[i] = heap->node_id[child];
+        i = child;
+    }
+    heap->key[i] = last_key;
+    heap->node_id[i] = last_node;
+}
+
+static void freeKeyHeap(KeyHeap* heap) {
+    free(heap->key);
+    free(heap->node_id);
+}
+
+/* Arcs of a node to its not-yet-contracted neighbours during the build */
+typedef struct Arc {
+    int target;
+    int distance;
+    int middle;
+} Arc;
+
+typedef struct ArcList {
+    Arc* arcs;
+    int size;
+    int capacity;
+} ArcList;
+
+/* Add an arc, or lower an existing one to the same target - 0 on allocation failure */
+static int addOrLowerArc(ArcList* list, int target, int distance, int middle) {
+    for (int i = 0; i < list->size; i++) {
+        if (list->arcs[i].target == target) {
+            if (distance < list->arcs[i].distance) {
+                list->arcs[i].distance = distance;
+                list->arcs[i].middle = middle;
+            }
+            return 1;
+        }
+    }
+
+    if (list->size == list->capacity) {
+        int new_capacity = list->capacity ? list->capacity * 2 : 4;
+        Arc* grown = (Arc*)realloc(list->arcs, sizeof(Arc) * new_capacity);
+        if (!grown) return 0;
+        list->arcs = grown;
+        list->capacity = new_capacity;
+    }
+
+    list->arcs[list->size].target = target;
+    list->arcs[list->size].distance = distance;
+    list->arcs[list->size].middle = middle;
+    list->size++;
+    return 1;
+}
+
+static void removeArc(ArcList* list, int target) {
+    for (int i = 0; i < list->size; i++) {
+        if (list->arcs[i].target == target) {
+            list->arcs[i] = list->arcs[--list->size];
+            return;
+        }
+    }
+}
+
+/* Preprocessing state */
+typedef struct Contractor {
+    int capacity;
+    ArcList* arcs;
+    int* deleted_neighbours;    // Contracted so far, spreads contraction evenly
+    int* witness_dist;          // Valid where witness_stamp matches the search
+    int* witness_stamp;
+    int stamp;
+    KeyHeap witness_heap;
+    int* pair_from;             // Shortcuts found by the last simulation
+    int* pair_to;
+    int* pair_distance;
+    int pair_count;
+    int pair_capacity;
+} Contractor;
+
+/* Dijkstra from source among uncontracted nodes, skipping via, until the
+ * targets are settled, max_distance is passed or the settle limit is hit.
+ * Shortcuts are only ever added when no witness is found, so stopping
+ * early costs extra shortcuts, never wrong distances. */
+static int witnessSearch(Contractor* ctr, int source, int via, const Arc* targets, int target_count,
+                         int max_distance) {
+    KeyHeap* heap = &ctr->witness_heap;
+    int stamp = ++ctr->stamp;
+    int settled = 0;
+    int remaining = target_count;
+
+    heap->size = 0;
+    ctr->witness_stamp[source] = stamp;
+    ctr->witness_dist[source] = 0;
+    if (!keyHeapPush(heap, 0, source)) return 0;
+
+    while (heap->size > 0 && settled < CONTRACTION_WITNESS_SETTLE_LIMIT) {
+        int d, u;
+        keyHeapPop(heap, &d, &u);
+        if (d > ctr->witness_dist[u]) continue;
+        if (d > max_distance) break;
+        settled++;
+        for (int i = 0; i < target_count; i++) {
+            if (targets[i].target == u) remaining--;
+        }
+        if (remaining == 0) break;
+
+        ArcList* list = &ctr->arcs[u];
+        for (int i = 0; i < list->size; i++) {
+            int v = list->arcs[i].target;
+            if (v == via) continue;
+            int new_dist = d + list->arcs[i].distance;
+            if (ctr->witness_stamp[v] != stamp || new_dist < ctr->witness_dist[v]) {
+                ctr->witness_stamp[v] = stamp;
+                ctr->witness_dist[v] = new_dist;
+                if (!keyHeapPush(heap, new_dist, v)) return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+static int witnessDistance(Contractor* ctr, int node) {
+    return ctr->witness_stamp[node] == ctr->stamp ? ctr->witness_dist[node] : INT_MAX;
+}
+
+/* Shortcuts contracting v would need, into pair_* - -1 on allocation failure */
+static int findShortcuts(Contractor* ctr, int v) {
+    ArcList* list = &ctr->arcs[v];
+    ctr->pair_count = 0;
+
+    int longest = 0;
+    for (int i = 0; i < list->size; i++) {
+        if (list->arcs[i].distance > longest) longest = list->arcs[i].distance;
+    }
+
+    // Each unordered neighbour pair once: from arc i to every later arc j
+    for (int i = 0; i + 1 < list->size; i++) {
+        const Arc* from = &list->arcs[i];
+        if (!witnessSearch(ctr, from->target, v, from + 1, list->size - i - 1, from->distance + longest)) return -1;
+
+        for (int j = i + 1; j < list->size; j++) {
+            int u = from->target;
+            int w = list->arcs[j].target;
+            int through_v = from->distance + list->arcs[j].distance;
+            if (witnessDistance(ctr, w) <= through_v) continue;
+
+            if (ctr->pair_count == ctr->pair_capacity) {
+                int new_capacity = ctr->pair_capacity ? ctr->pair_capacity * 2 : 64;
+                int* grown_from = (int*)realloc(ctr->pair_from, sizeof(int) * new_capacity);
+                if (!grown_from) return -1;
+                ctr->pair_from = grown_from;
+                int* grown_to = (int*)realloc(ctr->pair_to, sizeof(int) * new_capacity);
+                if (!grown_to) return -1;
+                ctr->pair_to = grown_to;
+                int* grown_distance = (int*)realloc(ctr->pair_distance, sizeof(int) * new_capacity);
+                if (!grown_distance) return -1;
+                ctr->pair_distance = grown_distance;
+                ctr->pair_capacity = new_capacity;
+            }
+            ctr->pair_from[ctr->pair_count] = u;
+            ctr->pair_to[ctr->pair_count] = w;
+            ctr->pair_distance[ctr->pair_count] = through_v;
+            ctr->pair_count++;
+        }
+    }
+    return ctr->pair_count;
+}
+
+/* Lower is contracted sooner: shortcuts added minus arcs removed (weighted
+ * double), plus contracted neighbours so one region is not hollowed out first */
+static int contractionPriority(Contractor* ctr, int v, int* priority) {
+    int shortcuts = findShortcuts(ctr, v);
+    if (shortcuts < 0) return 0;
+    *priority = 2 * (shortcuts - ctr->arcs[v].size) + ctr->deleted_neighbours[v];
+    return 1;
+}
+
+/* Contract v using the shortcuts from the last findShortcuts(v) */
+static int contractNode(Contractor* ctr, int v) {
+    for (int i = 0; i < ctr->pair_count; i++) {
+        int u = ctr->pair_from[i];
+        int w = ctr->pair_to[i];
+        if (!addOrLowerArc(&ctr->arcs[u], w, ctr->pair_distance[i], v) ||
+            !addOrLowerArc(&ctr->arcs[w], u, ctr->pair_distance[i], v)) {
+            return 0;
+        }
+    }
+
+    // v keeps its arcs: they all lead to nodes contracted later (upward)
+    ArcList* list = &ctr->arcs[v];
+    for (int i = 0; i < list->size; i++) {
+        removeArc(&ctr->arcs[list->arcs[i].target], v);
+        ctr->deleted_neighbours[list->arcs[i].target]++;
+    }
+    return 1;
+}
+
+static void freeContractor(Contractor* ctr) {
+    if (ctr->arcs) {
+        for (int i = 0; i < ctr->capacity; i++) {
+            free(ctr->arcs[i].arcs);
+        }
+    }
+    free(ctr->arcs);
+    free(ctr->deleted_neighbours);
+    free(ctr->witness_dist);
+    free(ctr->witness_stamp);
+    freeKeyHeap(&ctr->witness_heap);
+    free(ctr->pair_from);
+    free(ctr->pair_to);
+    free(ctr->pair_distance);
+}
+
+/* Order every node, add shortcuts and pack the upward arcs */
+static int contractGraph(Graph* g, Contractor* ctr, ContractionHierarchy* ch) {
+    int n = g->capacity;
+    KeyHeap order = {NULL, NULL, 0, 0};
+    int ok = 1;
+
+    // Walkways as arcs; parallel walkways keep the shortest
+    for (int v = 0; ok && v < n; v++) {
+        if (!g->nodes[v]) continue;
+        for (Edge* edge = g->nodes[v]->edges; edge && ok; edge = edge->next) {
+            if (edge->destination_id != v) ok = addOrLowerArc(&ctr->arcs[v], edge->destination_id, edge->distance, -1);
+        }
+    }
+
+    for (int v = 0; ok && v < n; v++) {
+        int priority;
+        if (g->nodes[v]) ok = contractionPriority(ctr, v, &priority) && keyHeapPush(&order, priority, v);
+    }
+
+    // Lazy updates: a popped node is re-scored and only contracted if still the cheapest
+    int next_rank = 0;
+    while (ok && order.size > 0) {
+        int key, v, priority;
+        keyHeapPop(&order, &key, &v);
+        ok = contractionPriority(ctr, v, &priority);
+        if (!ok) break;
+
+        if (order.size > 0 && priority > order.key[0]) {
+            ok = keyHeapPush(&order, priority, v);
+            continue;
+        }
+        ok = contractNode(ctr, v);
+        ch->rank[v] = next_rank++;
+    }
+    freeKeyHeap(&order);
+    if (!ok) return 0;
+
+    // Pack the upward arcs
+    int total = 0;
+    for (int v = 0; v < n; v++) {
+        ch->first_arc[v] = total;
+        total += ctr->arcs[v].size;
+    }
+    ch->first_arc[n] = total;
+
+    ch->arc_target = (int*)malloc(sizeof(int) * (total > 0 ? total : 1));
+    ch->arc_distance = (int*)malloc(sizeof(int) * (total > 0 ? total : 1));
+    ch->arc_middle = (int*)malloc(sizeof(int) * (total > 0 ? total : 1));
+    if (!ch->arc_target || !ch->arc_distance || !ch->arc_middle) return 0;
+
+    for (int v = 0; v < n; v++) {
+        ArcList* list = &ctr->arcs[v];
+        for (int i = 0; i < list->size; i++) {
+            int a = ch->first_arc[v] + i;
+            ch->arc_target[a] = list->arcs[i].target;
+            ch->arc_distance[a] = list->arcs[i].distance;
+            ch->arc_middle[a] = list->arcs[i].middle;
+            if (list->arcs[i].middle != -1) ch->shortcut_count++;
+        }
+    }
+    ch->arc_count = total;
+    return 1;
+}
+
+/* Preprocess the map for fast point-to-point queries */
+ContractionHierarchy* buildContractionHierarchy(Graph* g) {
+    if (!g) return NULL;
+
+    TRACE_SPAN("buildContractionHierarchy");
+    int n = g->capacity;
+    ContractionHierarchy* ch = (ContractionHierarchy*)calloc(1, sizeof(ContractionHierarchy));
+    if (!ch) {
+        fprintf(stderr, "Error: Memory allocation failed for contraction hierarchy\n");
+        return NULL;
+    }
+    ch->capacity = n;
+    ch->topology = g->topology_version;
+    ch->rank = (int*)malloc(sizeof(int) * n);
+    ch->first_arc = (int*)malloc(sizeof(int) * (n + 1));
+    ch->dist_forward = (int*)malloc(sizeof(int) * n);
+    ch->dist_backward = (int*)malloc(sizeof(int) * n);
+    ch->parent_forward = (int*)malloc(sizeof(int) * n);
+    ch->parent_backward = (int*)malloc(sizeof(int) * n);
+    ch->touched = (int*)malloc(sizeof(int) * 2 * n);
+
+    Contractor ctr;
+    memset(&ctr, 0, sizeof(ctr));
+    ctr.capacity = n;
+    ctr.arcs = (ArcList*)calloc(n, sizeof(ArcList));
+    ctr.deleted_neighbours = (int*)calloc(n, sizeof(int));
+    ctr.witness_dist = (int*)malloc(sizeof(int) * n);
+    ctr.witness_stamp = (int*)calloc(n, sizeof(int));
+
+    int ok = ch->rank && ch->first_arc && ch->dist_forward && ch->dist_backward &&
+             ch->parent_forward && ch->parent_backward && ch->touched &&
+             ctr.arcs && ctr.deleted_neighbours && ctr.witness_dist && ctr.witness_stamp;
+    if (ok) {
+        for (int i = 0; i < n; i++) {
+            ch->rank[i] = -1;
+            ch->dist_forward[i] = INT_MAX;
+            ch->dist_backward[i] = INT_MAX;
+            ch->parent_forward[i] = -1;
+            ch->parent_backward[i] = -1;
+        }
+        ok = contractGraph(g, &ctr, ch);
+    }
+    freeContractor(&ctr);
+
+    if (!ok) {
+        fprintf(stderr, "Error: Memory allocation failed for contraction hierarchy\n");
+        freeContractionHierarchy(ch);
+        return NULL;
+    }
+    return ch;
+}
+
+/* Usable until edges are added to the graph */
+int isContractionHierarchyCurrent(Graph* g, const ContractionHierarchy* ch) {
+    return g && ch && ch->topology == g->topology_version;
+}
+
+static int touchNode(ContractionHierarchy* ch, int node) {
+    if (ch->dist_forward[node] == INT_MAX && ch->dist_backward[node] == INT_MAX) {
+        ch->touched[ch->touched_count++] = node;
+    }
+    return node;
+}
+
+/* One step of an upward search: settle the heap top, relax its upward arcs.
+ * A node some higher node reaches more cheaply is stalled (not expanded). */
+static int settleUpward(ContractionHierarchy* ch, KeyHeap* heap, int* dist, int* parent,
+                        const int* other_dist, int* best, int* meet) {
+    int d, u;
+    keyHeapPop(heap, &d, &u);
+    if (d > dist[u]) return 1;
+
+    if (other_dist[u] != INT_MAX && d + other_dist[u] < *best) {
+        *best = d + other_dist[u];
+        *meet = u;
+    }
+
+    for (int a = ch->first_arc[u]; a < ch->first_arc[u + 1]; a++) {
+        int w = ch->arc_target[a];
+        if (dist[w] != INT_MAX && dist[w] + ch->arc_distance[a] < d) return 1;
+    }
+
+    for (int a = ch->first_arc[u]; a < ch->first_arc[u + 1]; a++) {
+        int w = ch->arc_target[a];
+        int new_dist = d + ch->arc_distance[a];
+        if (new_dist < dist[w]) {
+            touchNode(ch, w);
+            dist[w] = new_dist;
+            parent[w] = u;
+            if (!keyHeapPush(heap, new_dist, w)) return 0;
+        }
+    }
+    return 1;
+}
+
+/* Bidirectional upward search; leaves the scratch arrays filled for path
+ * unpacking. Returns the distance (INT_MAX if unreachable), -1 on failure. */
+static int searchHierarchy(ContractionHierarchy* ch, int start_id, int end_id, int* meet) {
+    KeyHeap forward = {NULL, NULL, 0, 0};
+    KeyHeap backward = {NULL, NULL, 0, 0};
+    int best = INT_MAX;
+    int ok = 1;
+    *meet = -1;
+
+    ch->dist_forward[touchNode(ch, start_id)] = 0;
+    ch->dist_backward[touchNode(ch, end_id)] = 0;
+    ok = keyHeapPush(&forward, 0, start_id) && keyHeapPush(&backward, 0, end_id);
+
+    // A direction is finished once its nearest unsettled node cannot beat best
+    while (ok) {
+        int forward_live = forward.size > 0 && forward.key[0] < best;
+        int backward_live = backward.size > 0 && backward.key[0] < best;
+        if (!forward_live && !backward_live) break;
+
+        if (forward_live && (!backward_live || forward.key[0] <= backward.key[0])) {
+            ok = settleUpward(ch, &forward, ch->dist_forward, ch->parent_forward,
+                              ch->dist_backward, &best, meet);
+        } else {
+            ok = settleUpward(ch, &backward, ch->dist_backward, ch->parent_backward,
+                              ch->dist_forward, &best, meet);
+        }
+    }
+
+    freeKeyHeap(&forward);
+    freeKeyHeap(&backward);
+    return ok ? best : -1;
+}
+
+static void resetSearch(ContractionHierarchy* ch) {
+    for (int i = 0; i < ch->touched_count; i++) {
+        int node = ch->touched[i];
+        ch->dist_forward[node] = INT_MAX;
+        ch->dist_backward[node] = INT_MAX;
+        ch->parent_forward[node] = -1;
+        ch->parent_backward[node] = -1;
+    }
+    ch->touched_count = 0;
+}
+
+static int validQuery(ContractionHierarchy* ch, int start_id, int end_id) {
+    return ch && start_id >= 0 && start_id < ch->capacity && ch->rank[start_id] != -1 &&
+           end_id >= 0 && end_id < ch->capacity && ch->rank[end_id] != -1;
+}
+
+/* Walking distance between two nodes, -1 if unreachable */
+int hierarchyDistance(ContractionHierarchy* ch, int start_id, int end_id) {
+    if (!validQuery(ch, start_id, end_id)) return -1;
+
+    TRACE_SPAN("hierarchyDistance");
+    int meet;
+    int best = searchHierarchy(ch, start_id, end_id, &meet);
+    resetSearch(ch);
+    return (best < 0 || best == INT_MAX) ? -1 : best;
+}
+
+/* Growable node list for path unpacking */
+typedef struct NodeList {
+    int* ids;
+    int size;
+    int capacity;
+} NodeList;
+
+static int appendId(NodeList* list, int id) {
+    if (list->size == list->capacity) {
+        int new_capacity = list->capacity ? list->capacity * 2 : 64;
+        int* grown = (int*)realloc(list->ids, sizeof(int) * new_capacity);
+        if (!grown) return 0;
+        list->ids = grown;
+        list->capacity = new_capacity;
+    }
+    list->ids[list->size++] = id;
+    return 1;
+}
+
+/* The arc between a and b is stored at whichever was contracted first */
+static int findArc(ContractionHierarchy* ch, int a, int b) {
+    int low = ch->rank[a] < ch->rank[b] ? a : b;
+    int high = low == a ? b : a;
+    for (int i = ch->first_arc[low]; i < ch->first_arc[low + 1]; i++) {
+        if (ch->arc_target[i] == high) return i;
+    }
+    return -1;
+}
+
+/* Append the walkway nodes from a (exclusive) to b (inclusive) */
+static int unpackArc(ContractionHierarchy* ch, int a, int b, NodeList* out) {
+    int arc = findArc(ch, a, b);
+    if (arc < 0) return 0;
+    int middle = ch->arc_middle[arc];
+    if (middle == -1) return appendId(out, b);
+    return unpackArc(ch, a, middle, out) && unpackArc(ch, middle, b, out);
+}
+
+/* Shortest walking route between two nodes, shortcuts expanded */
+PathInfo* hierarchyShortestPath(ContractionHierarchy* ch, int start_id, int end_id) {
+    if (!validQuery(ch, start_id, end_id)) return NULL;
+
+    TRACE_SPAN("hierarchyShortestPath");
+    int meet;
+    int best = searchHierarchy(ch, start_id, end_id, &meet);
+    NodeList upward = {NULL, 0, 0};
+    NodeList nodes = {NULL, 0, 0};
+    int ok = best >= 0 && best != INT_MAX;
+
+    // start -> meet climbs the forward parents (collected in reverse), meet -> end the backward ones
+    for (int x = meet; ok && x != -1; x = ch->parent_forward[x]) {
+        ok = appendId(&upward, x);
+    }
+    ok = ok && appendId(&nodes, start_id);
+    for (int i = upward.size - 1; ok && i > 0; i--) {
+        ok = unpackArc(ch, upward.ids[i], upward.ids[i - 1], &nodes);
+    }
+    for (int x = meet; ok && ch->parent_backward[x] != -1; x = ch->parent_backward[x]) {
+        ok = unpackArc(ch, x, ch->parent_backward[x], &nodes);
+    }
+    resetSearch(ch);
+    free(upward.ids);
+
+    PathInfo* path_info = NULL;
+    if (ok) path_info = (PathInfo*)malloc(sizeof(PathInfo));
+    if (path_info) {
+        path_info->path = nodes.ids;
+        path_info->path_length = nodes.size;
+        path_info->total_distance = best;
+    } else {
+        free(nodes.ids);
+    }
+    return path_info;
+}
+
+/* Free contraction hierarchy */
+void freeContractionHierarchy(ContractionHierarchy* ch) {
+    if (ch) {
+        free(ch->rank);
+        free(ch->first_arc);
+        free(ch->arc_target);
+        free(ch->arc_distance);
+        free(ch->arc_middle);
+        free(ch->dist_forward);
+        free(ch->dist_backward);
+        free(ch->parent_forward);
+        free(ch->parent_backward);
+        free(ch->touched);
+        free(ch);
+    }
+}
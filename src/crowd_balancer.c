@@ -0,0 +1,647 @@
+/* Park-Wide Crowd Balancing by Incremental Min-Cost Flow */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include "../include/crowd_balancer.h"
+#include "../include/priority_queue.h"
+#include "../include/response_cache.h"
+#include "../include/metrics.h"
+#include "../include/utils.h"
+#include "../include/trace.h"
+
+#define THRILL_LEVELS (MAX_THRILL_LEVEL - MIN_THRILL_LEVEL + 1)
+#define CLASS_COUNT (MAX_RIDES * THRILL_LEVELS)
+
+/* Flow network: source, sink, one node per class, one per open ride */
+#define SOURCE 0
+#define SINK 1
+#define CLASS_NODE(c) (2 + (c))
+#define RIDE_NODE(slot) (2 + CLASS_COUNT + (slot))
+#define FLOW_NODES (2 + CLASS_COUNT + MAX_RIDES)
+#define FLOW_EDGES (CLASS_COUNT * (1 + CROWD_CANDIDATE_RIDES) + MAX_RIDES * CROWD_WAIT_SEGMENTS)
+#define FLOW_UNBOUNDED (INT_MAX / 4)  // Class-to-ride arcs never fill up
+#define MIN_NETWORK_SUPPLY (MAX_RIDES * CROWD_WAIT_SEGMENTS)
+
+/* Cost of a class-to-ride arc: the best possible thrill match minus
+ * calculatePriority's thrill and distance terms */
+#define BEST_STATIC_SCORE ((float)(MAX_THRILL_LEVEL * THRILL_MATCH_WEIGHT))
+
+/* Class head counts, kept by visitor.c as visitors enter, leave and move */
+static int class_visitors[CLASS_COUNT];
+static unsigned long intent_version = 0;
+
+/* Walking distance from each ride to every other, one row per search */
+static int walk_distance[MAX_RIDES][MAX_RIDES];
+static unsigned char walk_known[MAX_RIDES];
+static Graph* distance_graph = NULL;
+static unsigned long distance_topology = 0;
+
+/* Edges as added, then laid out per node (CSR) with their reverses */
+static int edge_from[FLOW_EDGES];
+static int edge_to[FLOW_EDGES];
+static int edge_arc[FLOW_EDGES];     // Forward residual arc of each edge
+static int edge_count = 0;
+
+/* Residual network: arcs of u are [first_arc[u], first_arc[u + 1]) */
+static int first_arc[FLOW_NODES + 1];
+static int arc_to[2 * FLOW_EDGES];
+static int arc_cap[2 * FLOW_EDGES];
+static int arc_cost[2 * FLOW_EDGES];
+static int arc_rev[2 * FLOW_EDGES];
+
+/* Kept between runs: the flow lives in arc_cap, and the potentials keep
+ * every residual arc's reduced cost non-negative */
+static long long potential[FLOW_NODES];
+static int excess[FLOW_NODES];       // Supply not yet routed (negative: demand)
+
+/* Solver scratch */
+static long long dist[FLOW_NODES];
+static int parent_arc[FLOW_NODES];
+static int arc_iter[FLOW_NODES];
+static unsigned char settled[FLOW_NODES];
+static unsigned char on_path[FLOW_NODES];
+static long long heap_key[2 * FLOW_EDGES + FLOW_NODES];
+static int heap_node[2 * FLOW_EDGES + FLOW_NODES];
+static int heap_size = 0;
+
+/* Network shape: rebuilt only when the open rides or the map change,
+ * or the crowd outgrows the wait segments */
+static int network_ready = 0;
+static int slot_count = 0;
+static Ride* slot_ride[MAX_RIDES];
+static int slot_id[MAX_RIDES];
+static int slot_thrill[MAX_RIDES];
+static int slot_step[MAX_RIDES];     // Riders per wait segment
+static int slot_first_edge[MAX_RIDES];
+static int ride_slot[MAX_RIDES];
+static int network_supply = 0;       // Visitors the segments were sized for
+static Graph* network_graph = NULL;
+static unsigned long network_topology = 0;
+
+static int class_first_edge[CLASS_COUNT];   // Source edge, then the candidates
+static int class_slots[CLASS_COUNT][CROWD_CANDIDATE_RIDES];
+static int class_candidates[CLASS_COUNT];
+
+/* Per run */
+static int slot_queue[MAX_RIDES];
+static int intent_load[MAX_RIDES];
+static int plan_load[MAX_RIDES];
+static Diversion found[CLASS_COUNT * CROWD_CANDIDATE_RIDES];
+
+static BalancePlan plan;
+static unsigned long plan_versions[DATA_DOMAIN_COUNT];
+static unsigned long plan_intents = 0;
+static Graph* plan_graph = NULL;
+static unsigned long plan_topology = 0;
+static time_t last_run = 0;
+
+/* A visitor joined (delta 1) or left (delta -1) the class for this
+ * location and thrill preference - O(1) */
+void noteCrowdIntent(int location, int thrill_preference, int delta) {
+    if (location < 0 || location >= MAX_RIDES) return;
+    if (thrill_preference < MIN_THRILL_LEVEL || thrill_preference > MAX_THRILL_LEVEL) return;
+
+    class_visitors[location * THRILL_LEVELS + thrill_preference - MIN_THRILL_LEVEL] += delta;
+    intent_version++;
+}
+
+/* Walking distances from a ride to every ride id (-1 where unreachable).
+ * Ids off the map fall back to the estimate buildPriorityQueue uses. */
+static const int* walkRow(Graph* g, int location) {
+    if (distance_graph != g || (g && distance_topology != g->topology_version)) {
+        memset(walk_known, 0, sizeof(walk_known));
+        distance_graph = g;
+        distance_topology = g ? g->topology_version : 0;
+    }
+
+    int* row = walk_distance[location];
+    if (walk_known[location]) return row;
+
+    int targets[MAX_RIDES];
+    for (int i = 0; i < MAX_RIDES; i++) targets[i] = i;
+    if (!hasGraphNode(g, location) || !walkingDistances(g, location, targets, MAX_RIDES, row)) {
+        for (int i = 0; i < MAX_RIDES; i++) row[i] = -1;
+    }
+    for (int i = 0; i < MAX_RIDES; i++) {
+        if (!hasGraphNode(g, location) || !hasGraphNode(g, i)) row[i] = abs(i - location) * 100;
+    }
+
+    walk_known[location] = 1;
+    return row;
+}
+
+static int edgeFlow(int edge) {
+    return arc_cap[arc_rev[edge_arc[edge]]];
+}
+
+static long long reducedCost(int u, int e) {
+    return arc_cost[e] + potential[u] - potential[arc_to[e]];
+}
+
+/* Set an edge's capacity and cost, keeping as much of its flow as fits */
+static void setEdge(int edge, int cap, int cost) {
+    int forward = edge_arc[edge];
+    int backward = arc_rev[forward];
+    int flow = arc_cap[backward] < cap ? arc_cap[backward] : cap;
+
+    arc_cap[forward] = cap - flow;
+    arc_cap[backward] = flow;
+    arc_cost[forward] = cost;
+    arc_cost[backward] = -cost;
+}
+
+static void heapPush(long long key, int node) {
+    int i = heap_size++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (heap_key[parent] <= key) break;
+        heap_key[i] = heap_key[parent];
+        heap_node[i] = heap_node[parent];
+        i = parent;
+    }
+    heap_key[i] = key;
+    heap_node[i] = node;
+}
+
+static int heapPop(long long* key) {
+    int top = heap_node[0];
+    *key = heap_key[0];
+
+    long long last_key = heap_key[--heap_size];
+    int last_node = heap_node[heap_size];
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= heap_size) break;
+        if (child + 1 < heap_size && heap_key[child + 1] < heap_key[child]) child++;
+        if (last_key <= heap_key[child]) break;
+        heap_key[i] = heap_key[child];
+        heap_node[i] = heap_node[child];
+        i = child;
+    }
+    heap_key[i] = last_key;
+    heap_node[i] = last_node;
+    return top;
+}
+
+/* Dijkstra over reduced costs from every node with supply left, stopping
+ * at the nearest one with demand; then shift the potentials so every
+ * shortest path has zero reduced cost. Returns that node, or -1. */
+static int shortestAugmentingPaths(void) {
+    heap_size = 0;
+    for (int v = 0; v < FLOW_NODES; v++) {
+        dist[v] = LLONG_MAX;
+        settled[v] = 0;
+        if (excess[v] > 0) {
+            dist[v] = 0;
+            parent_arc[v] = -1;
+            heapPush(0, v);
+        }
+    }
+
+    int target = -1;
+    while (heap_size > 0) {
+        long long d;
+        int u = heapPop(&d);
+        if (settled[u]) continue;
+        settled[u] = 1;
+        if (excess[u] < 0) {
+            target = u;
+            break;
+        }
+
+        for (int e = first_arc[u]; e < first_arc[u + 1]; e++) {
+            int v = arc_to[e];
+            if (arc_cap[e] == 0 || settled[v]) continue;
+
+            long long nd = d + reducedCost(u, e);
+            if (nd < dist[v]) {
+                dist[v] = nd;
+                parent_arc[v] = e;
+                heapPush(nd, v);
+            }
+        }
+    }
+    if (target < 0) return -1;
+
+    // Unsettled nodes are at least as far as the target
+    for (int v = 0; v < FLOW_NODES; v++) {
+        potential[v] += settled[v] ? dist[v] : dist[target];
+    }
+    return target;
+}
+
+/* Push up to limit from u over zero-reduced-cost arcs into nodes with
+ * demand; exhausted arcs are skipped for the rest of the phase */
+static int augment(int u, int limit) {
+    int total = 0;
+    if (excess[u] < 0) {
+        total = -excess[u] < limit ? -excess[u] : limit;
+        excess[u] += total;
+        if (total == limit) return total;
+    }
+
+    on_path[u] = 1;
+    for (; arc_iter[u] < first_arc[u + 1]; arc_iter[u]++) {
+        int e = arc_iter[u];
+        int v = arc_to[e];
+        if (arc_cap[e] == 0 || on_path[v] || reducedCost(u, e) != 0) continue;
+
+        int want = limit - total;
+        int pushed = augment(v, want < arc_cap[e] ? want : arc_cap[e]);
+        arc_cap[e] -= pushed;
+        arc_cap[arc_rev[e]] += pushed;
+        total += pushed;
+        if (total == limit) break;  // This arc may still have room
+    }
+    on_path[u] = 0;
+    return total;
+}
+
+/* Successive shortest paths from supply to demand. Starting from the
+ * last run's flow, only what changed since gets rerouted. */
+static void solveFlow(void) {
+    // Arcs the changes made cheaper than the potentials allow are filled first
+    for (int u = 0; u < FLOW_NODES; u++) {
+        for (int e = first_arc[u]; e < first_arc[u + 1]; e++) {
+            if (arc_cap[e] == 0 || reducedCost(u, e) >= 0) continue;
+            excess[u] -= arc_cap[e];
+            excess[arc_to[e]] += arc_cap[e];
+            arc_cap[arc_rev[e]] += arc_cap[e];
+            arc_cap[e] = 0;
+        }
+    }
+
+    int target;
+    while ((target = shortestAugmentingPaths()) >= 0) {
+        // The path Dijkstra found always carries flow...
+        int start = target;
+        int pushed = -excess[target];
+        for (int v = target; parent_arc[v] >= 0; v = start) {
+            if (arc_cap[parent_arc[v]] < pushed) pushed = arc_cap[parent_arc[v]];
+            start = arc_to[arc_rev[parent_arc[v]]];
+        }
+        if (excess[start] < pushed) pushed = excess[start];
+        for (int v = target; v != start; v = arc_to[arc_rev[parent_arc[v]]]) {
+            arc_cap[parent_arc[v]] -= pushed;
+            arc_cap[arc_rev[parent_arc[v]]] += pushed;
+        }
+        excess[start] -= pushed;
+        excess[target] += pushed;
+
+        // ...and any other equally short ones are taken in the same phase
+        memcpy(arc_iter, first_arc, sizeof(arc_iter));
+        for (int v = 0; v < FLOW_NODES; v++) {
+            if (excess[v] > 0) excess[v] -= augment(v, excess[v]);
+        }
+    }
+}
+
+/* Wait a rider joining at this position in line would see */
+static int slotWait(int slot, int extra_riders) {
+    return estimateRideWait(slot_ride[slot], slot_queue[slot] + extra_riders);
+}
+
+/* Riders a ride boards per second */
+static double slotRate(int slot) {
+    const ThroughputEstimate* est = &slot_ride[slot]->throughput;
+    return est->dispatch_interval > 0.0f ? est->riders_per_cycle / est->dispatch_interval : 0.0;
+}
+
+static int compareDiversions(const void* a, const void* b) {
+    const Diversion* x = (const Diversion*)a;
+    const Diversion* y = (const Diversion*)b;
+    if (x->visitors != y->visitors) return y->visitors - x->visitors;
+    if (x->location != y->location) return x->location - y->location;
+    return x->to_ride - y->to_ride;
+}
+
+/* calculatePriority without its wait term, which the sink arcs charge
+ * instead; only changes with the map or the ride list */
+static float staticScore(Visitor* probe, Ride* ride, int distance) {
+    return calculatePriority(probe, ride, distance) + ride->current_wait_time * WAIT_TIME_WEIGHT / 10.0f;
+}
+
+/* Offer a class its best-ranked reachable rides; returns how many */
+static int pickCandidates(int c, const int* row, float* scores) {
+    Visitor probe;
+    memset(&probe, 0, sizeof(probe));
+    probe.thrill_preference = c % THRILL_LEVELS + MIN_THRILL_LEVEL;
+
+    int count = 0;
+    for (int slot = 0; slot < slot_count; slot++) {
+        int distance = row[slot_id[slot]];
+        if (distance < 0) continue;
+
+        float score = staticScore(&probe, slot_ride[slot], distance);
+        if (count == CROWD_CANDIDATE_RIDES && score <= scores[count - 1]) continue;
+
+        int i = count < CROWD_CANDIDATE_RIDES ? count++ : CROWD_CANDIDATE_RIDES - 1;
+        while (i > 0 && scores[i - 1] < score) {
+            scores[i] = scores[i - 1];
+            class_slots[c][i] = class_slots[c][i - 1];
+            i--;
+        }
+        scores[i] = score;
+        class_slots[c][i] = slot;
+    }
+    return count;
+}
+
+/* Lay the edges and their reverses out node by node, with no flow */
+static void layOutArcs(const int* costs) {
+    memset(first_arc, 0, sizeof(first_arc));
+    for (int i = 0; i < edge_count; i++) {
+        first_arc[edge_from[i] + 1]++;
+        first_arc[edge_to[i] + 1]++;
+    }
+    for (int v = 0; v < FLOW_NODES; v++) first_arc[v + 1] += first_arc[v];
+
+    int next[FLOW_NODES];
+    memcpy(next, first_arc, sizeof(next));
+    for (int i = 0; i < edge_count; i++) {
+        int forward = next[edge_from[i]]++;
+        int backward = next[edge_to[i]]++;
+
+        arc_to[forward] = edge_to[i];
+        arc_cap[forward] = 0;  // Capacities are set every run
+        arc_cost[forward] = costs[i];
+        arc_rev[forward] = backward;
+
+        arc_to[backward] = edge_from[i];
+        arc_cap[backward] = 0;
+        arc_cost[backward] = -costs[i];
+        arc_rev[backward] = forward;
+        edge_arc[i] = forward;
+    }
+}
+
+static void addEdge(int from, int to, int cost, int* costs) {
+    edge_from[edge_count] = from;
+    edge_to[edge_count] = to;
+    costs[edge_count++] = cost;
+}
+
+/* Every class's candidate arcs and every open ride's wait segments,
+ * empty; potentials start at zero since no arc costs less than that */
+static void buildNetwork(Graph* g) {
+    static int costs[FLOW_EDGES];
+
+    edge_count = 0;
+    network_supply = 0;
+    for (int c = 0; c < CLASS_COUNT; c++) {
+        float scores[CROWD_CANDIDATE_RIDES];
+        class_candidates[c] = pickCandidates(c, walkRow(g, c / THRILL_LEVELS), scores);
+        if (class_candidates[c] == 0) continue;  // Nothing open within reach
+
+        class_first_edge[c] = edge_count;
+        addEdge(SOURCE, CLASS_NODE(c), 0, costs);
+        for (int k = 0; k < class_candidates[c]; k++) {
+            int cost = (int)lroundf((BEST_STATIC_SCORE - scores[k]) * CROWD_COST_SCALE);
+            addEdge(CLASS_NODE(c), RIDE_NODE(class_slots[c][k]), cost > 0 ? cost : 0, costs);
+        }
+        if (class_visitors[c] > 0) network_supply += class_visitors[c];
+    }
+    if (network_supply < MIN_NETWORK_SUPPLY) network_supply = MIN_NETWORK_SUPPLY;
+
+    // Each rider pays the wait at the place in line they join; the wait
+    // never falls further back, so the pieces fill in order. They span
+    // twice the ride's share of the crowd by throughput.
+    double total_rate = 0.0;
+    for (int slot = 0; slot < slot_count; slot++) total_rate += slotRate(slot);
+
+    for (int slot = 0; slot < slot_count; slot++) {
+        double share = total_rate > 0.0 ? network_supply * slotRate(slot) / total_rate : network_supply;
+        int step = (int)ceil(2.0 * share / CROWD_WAIT_SEGMENTS);
+        int per_cycle = (int)slot_ride[slot]->throughput.riders_per_cycle;
+        if (step < per_cycle) step = per_cycle;  // Waits move a cycle at a time
+        slot_step[slot] = step > 0 ? step : 1;
+
+        slot_first_edge[slot] = edge_count;
+        for (int k = 0; k < CROWD_WAIT_SEGMENTS; k++) {
+            addEdge(RIDE_NODE(slot), SINK, 0, costs);
+        }
+    }
+
+    layOutArcs(costs);
+    memset(potential, 0, sizeof(potential));
+    network_graph = g;
+    network_topology = g ? g->topology_version : 0;
+    network_ready = 1;
+}
+
+/* Collect the open rides; returns 1 if they differ from the network's */
+static int collectOpenRides(RideList* rides, DualQueue** queues) {
+    int changed = 0;
+    int count = 0;
+    for (RideNode* node = rides->head; node && count < MAX_RIDES; node = node->next) {
+        Ride* ride = node->ride;
+        if (!ride->is_operational || ride->id < 0 || ride->id >= MAX_RIDES) continue;
+
+        if (count >= slot_count || slot_ride[count] != ride || slot_id[count] != ride->id ||
+            slot_thrill[count] != ride->thrill_level) changed = 1;
+        slot_ride[count] = ride;
+        slot_id[count] = ride->id;
+        slot_thrill[count] = ride->thrill_level;
+        ride_slot[ride->id] = count;
+        slot_queue[count] = queues && queues[ride->id] ? getTotalQueueSize(queues[ride->id]) : 0;
+        count++;
+    }
+
+    if (count != slot_count) changed = 1;
+    slot_count = count;
+    return changed;
+}
+
+/* Head count of the classes that can reach an open ride */
+static int networkDemand(void) {
+    int supply = 0;
+    for (int c = 0; c < CLASS_COUNT; c++) {
+        if (class_candidates[c] > 0 && class_visitors[c] > 0) supply += class_visitors[c];
+    }
+    return supply;
+}
+
+/* Put this run's head counts and wait curves on the network, keeping
+ * the flow from last time where it still fits */
+static void updateNetwork(int supply) {
+    for (int c = 0; c < CLASS_COUNT; c++) {
+        if (class_candidates[c] == 0) continue;
+        setEdge(class_first_edge[c], class_visitors[c] > 0 ? class_visitors[c] : 0, 0);
+        for (int k = 0; k < class_candidates[c]; k++) {
+            int edge = class_first_edge[c] + 1 + k;
+            setEdge(edge, FLOW_UNBOUNDED, arc_cost[edge_arc[edge]]);
+        }
+    }
+
+    for (int slot = 0; slot < slot_count; slot++) {
+        int step = slot_step[slot];
+        for (int k = 0; k < CROWD_WAIT_SEGMENTS; k++) {
+            int cap = k + 1 < CROWD_WAIT_SEGMENTS ? step : 2 * network_supply;  // The last holds the rest
+            int cost = slotWait(slot, (k + 1) * step) * WAIT_TIME_WEIGHT * CROWD_COST_SCALE / 10;
+            setEdge(slot_first_edge[slot] + k, cap, cost);
+        }
+    }
+
+    // Supply and demand left over once the surviving flow is counted
+    memset(excess, 0, sizeof(excess));
+    excess[SOURCE] = supply;
+    excess[SINK] = -supply;
+    for (int i = 0; i < edge_count; i++) {
+        int flow = edgeFlow(i);
+        excess[edge_from[i]] -= flow;
+        excess[edge_to[i]] += flow;
+    }
+}
+
+/* Read the flow back into loads and diversions. A class's first choice
+ * is its best candidate by calculatePriority at today's waits. */
+static void recordPlan(void) {
+    int found_count = 0;
+    int location_start = 0;
+    plan.visitors = 0;
+    plan.classes = 0;
+    plan.diverted = 0;
+    for (int slot = 0; slot < slot_count; slot++) {
+        intent_load[slot] = 0;
+        plan_load[slot] = 0;
+    }
+
+    for (int c = 0; c < CLASS_COUNT; c++) {
+        if (c % THRILL_LEVELS == 0) location_start = found_count;  // Classes are location-major
+        if (class_candidates[c] == 0 || class_visitors[c] <= 0) continue;
+
+        Visitor probe;
+        memset(&probe, 0, sizeof(probe));
+        probe.thrill_preference = c % THRILL_LEVELS + MIN_THRILL_LEVEL;
+        const int* row = walk_distance[c / THRILL_LEVELS];
+
+        int intent = class_slots[c][0];
+        float best = 0.0f;
+        for (int k = 0; k < class_candidates[c]; k++) {
+            int slot = class_slots[c][k];
+            float score = calculatePriority(&probe, slot_ride[slot], row[slot_id[slot]]);
+            if (k == 0 || score > best) {
+                best = score;
+                intent = slot;
+            }
+        }
+        intent_load[intent] += class_visitors[c];
+        plan.visitors += class_visitors[c];
+        plan.classes++;
+
+        for (int k = 0; k < class_candidates[c]; k++) {
+            int flow = edgeFlow(class_first_edge[c] + 1 + k);
+            int slot = class_slots[c][k];
+            plan_load[slot] += flow;
+            if (flow == 0 || slot == intent) continue;
+
+            int location = c / THRILL_LEVELS;
+            int i = location_start;
+            while (i < found_count && !(found[i].from_ride == slot_id[intent] && found[i].to_ride == slot_id[slot])) i++;
+            if (i == found_count) {
+                found[i].location = location;
+                found[i].from_ride = slot_id[intent];
+                found[i].to_ride = slot_id[slot];
+                found[i].visitors = 0;
+                found_count++;
+            }
+            found[i].visitors += flow;
+            plan.diverted += flow;
+        }
+    }
+
+    plan.rides = slot_count;
+    plan.max_wait_before = 0;
+    plan.max_wait_after = 0;
+    for (int slot = 0; slot < slot_count; slot++) {
+        int before = slotWait(slot, intent_load[slot]);
+        int after = slotWait(slot, plan_load[slot]);
+        if (before > plan.max_wait_before) plan.max_wait_before = before;
+        if (after > plan.max_wait_after) plan.max_wait_after = after;
+    }
+    for (int i = 0; i < found_count; i++) {
+        int from_slot = ride_slot[found[i].from_ride];
+        int to_slot = ride_slot[found[i].to_ride];
+        found[i].intended_wait = slotWait(from_slot, plan_load[from_slot] + found[i].visitors);
+        found[i].suggested_wait = slotWait(to_slot, plan_load[to_slot]);
+    }
+
+    qsort(found, found_count, sizeof(Diversion), compareDiversions);
+    plan.diversion_count = found_count < CROWD_MAX_DIVERSIONS ? found_count : CROWD_MAX_DIVERSIONS;
+    memcpy(plan.diversions, found, sizeof(Diversion) * plan.diversion_count);
+}
+
+static int isPlanCurrent(Graph* g) {
+    if (plan.computed_at == 0 || plan_graph != g || plan_intents != intent_version) return 0;
+    if (g && plan_topology != g->topology_version) return 0;
+    for (int d = 0; d < DATA_DOMAIN_COUNT; d++) {
+        if (d != DATA_VISITORS && plan_versions[d] != getDataVersion((DataDomain)d)) return 0;
+    }
+    return 1;
+}
+
+/* Re-plan if any class, ride, queue or walkway changed since the last
+ * plan; otherwise return the last plan unchanged */
+const BalancePlan* balanceCrowds(RideList* rides, DualQueue** queues, Graph* g) {
+    if (!rides) return NULL;
+    if (isPlanCurrent(g)) return &plan;
+
+    TRACE_SPAN("balanceCrowds");
+    long long started = getMonotonicNanos();
+
+    int reshaped = collectOpenRides(rides, queues);
+    if (!network_ready || reshaped || network_graph != g || (g && network_topology != g->topology_version)) {
+        buildNetwork(g);
+    }
+
+    int supply = networkDemand();
+    if (supply > 2 * network_supply || (network_supply > MIN_NETWORK_SUPPLY && 4 * supply < network_supply)) {
+        buildNetwork(g);  // Resize the wait segments to the crowd
+    }
+    if (slot_count > 0) {
+        updateNetwork(supply);
+        solveFlow();
+    }
+    recordPlan();
+
+    plan.computed_at = time(NULL);
+    plan.solve_nanos = getMonotonicNanos() - started;
+    plan_intents = intent_version;
+    plan_graph = g;
+    plan_topology = g ? g->topology_version : 0;
+    for (int d = 0; d < DATA_DOMAIN_COUNT; d++) {
+        plan_versions[d] = getDataVersion((DataDomain)d);
+    }
+    metricObserveSince(METRIC_CROWD_BALANCE_SECONDS, started);
+    return &plan;
+}
+
+/* Main-loop tick: at most one run per CROWD_BALANCE_INTERVAL */
+void runCrowdBalancer(RideList* rides, DualQueue** queues, Graph* g) {
+    time_t now = time(NULL);
+    if (now - last_run < CROWD_BALANCE_INTERVAL) return;
+
+    last_run = now;
+    balanceCrowds(rides, queues, g);
+}
+
+/* Latest plan (computed_at is 0 before the first run) */
+const BalancePlan* getBalancePlan(void) {
+    return &plan;
+}
+
+/* Forget the plan, the network and cached distances (e.g. before the map
+ * is freed); class head counts follow the visitors and are kept */
+void resetCrowdBalancer(void) {
+    memset(&plan, 0, sizeof(plan));
+    memset(walk_known, 0, sizeof(walk_known));
+    distance_graph = NULL;
+    network_graph = NULL;
+    network_ready = 0;
+    slot_count = 0;
+    plan_graph = NULL;
+    last_run = 0;
+}
@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include "../include/queue_manager.h"
 #include "../include/visitor.h"
+#include "../include/utils.h"
 
 /* Create dual queue system */
 DualQueue* createDualQueue(int ride_id, int merge_ratio) {
@@ -14,12 +15,15 @@ DualQueue* createDualQueue(int ride_id, int merge_ratio) {
     
     dq->regular_queue = createQueue(ride_id);
     dq->fastpass_queue = createQueue(ride_id);
+    dq->single_rider_queue = createQueue(ride_id);
     dq->ride_id = ride_id;
     dq->merge_ratio = merge_ratio;  // Default 4:1 (4 regular, 1 fast-pass)
+    dq->regular_served = 0;
     
-    if (!dq->regular_queue || !dq->fastpass_queue) {
+    if (!dq->regular_queue || !dq->fastpass_queue || !dq->single_rider_queue) {
         if (dq->regular_queue) freeQueue(dq->regular_queue);
         if (dq->fastpass_queue) freeQueue(dq->fastpass_queue);
+        if (dq->single_rider_queue) freeQueue(dq->single_rider_queue);
         free(dq);
         return NULL;
     }
@@ -27,50 +31,103 @@ DualQueue* createDualQueue(int ride_id, int merge_ratio) {
     return dq;
 }
 
-/* Enqueue visitor to appropriate queue */
+/* Enqueue visitor in the standby lane. Fast passes are only spent on
+ * return-time reservations, which reach the fast-pass lane when redeemed. */
 void enqueueDual(DualQueue* dq, Visitor* visitor) {
     if (!dq || !visitor) return;
     
-    // Premium ticket holders with fast-passes go to fast-pass queue
-    if (visitor->ticket_type == TICKET_PREMIUM && visitor->fast_passes_remaining > 0) {
-        enqueue(dq->fastpass_queue, visitor);
-        visitor->fast_passes_remaining--;
-        printf("[Fast-Pass] %s added to priority queue (Passes left: %d)\n", 
-               visitor->name, visitor->fast_passes_remaining);
+    enqueue(dq->regular_queue, visitor);
+    visitor->queue_lane = LANE_REGULAR;
+    printf("[Regular] %s added to standard queue\n", visitor->name);
+}
+
+/* Join the fast-pass lane without spending a pass (redeemed return times) */
+void enqueueFastPass(DualQueue* dq, Visitor* visitor) {
+    if (!dq || !visitor) return;
+    
+    enqueue(dq->fastpass_queue, visitor);
+    visitor->queue_lane = LANE_FASTPASS;
+}
+
+/* Queue a party in the regular lane so it boards in one cycle (0 = no room) */
+int enqueueDualParty(DualQueue* dq, Visitor* party[], int count) {
+    if (!dq || !party || count <= 0) return 0;
+    
+    if (!enqueueParty(dq->regular_queue, party, count)) return 0;
+    for (int i = 0; i < count; i++) {
+        party[i]->queue_lane = LANE_REGULAR;
+    }
+    return 1;
+}
+
+/* Join the single-rider lane: board alone whenever a seat would go empty */
+void enqueueSingleRider(DualQueue* dq, Visitor* visitor) {
+    if (!dq || !visitor) return;
+    
+    enqueue(dq->single_rider_queue, visitor);
+    visitor->queue_lane = LANE_SINGLE_RIDER;
+}
+
+/* Lane the merge order boards from next: fast-pass after every merge_ratio
+ * regular guests, otherwise whichever of the two is not empty */
+static Queue* nextLane(DualQueue* dq) {
+    if (!isEmpty(dq->fastpass_queue) &&
+        (dq->regular_served >= dq->merge_ratio || isEmpty(dq->regular_queue))) {
+        return dq->fastpass_queue;
+    }
+    return isEmpty(dq->regular_queue) ? NULL : dq->regular_queue;
+}
+
+static Visitor* dequeueLane(DualQueue* dq, Queue* lane) {
+    if (lane == dq->fastpass_queue) {
+        dq->regular_served = 0;
     } else {
-        enqueue(dq->regular_queue, visitor);
-        printf("[Regular] %s added to standard queue\n", visitor->name);
+        dq->regular_served++;
     }
+    return dequeue(lane);
 }
 
-/* Dequeue visitor using merge ratio */
+/* Dequeue visitor using merge ratio; single riders once both lanes are empty */
 Visitor* dequeueDual(DualQueue* dq) {
     if (!dq) return NULL;
     
-    static int regular_count = 0;
+    Queue* lane = nextLane(dq);
+    return lane ? dequeueLane(dq, lane) : dequeue(dq->single_rider_queue);
+}
+
+/* Board one ride cycle into riders[] (at most seats) and return how many.
+ * Parties board whole in merge order until the next one does not fit; it
+ * waits for the next cycle, unless it is larger than the ride and then
+ * fills an empty car. The seats left over are packed from the single-rider
+ * lane, so a cycle only leaves empty while no single rider is waiting. */
+int boardDualQueue(DualQueue* dq, Visitor* riders[], int seats) {
+    if (!dq || !riders) return 0;
     
-    // Check if fast-pass queue has visitors
-    if (!isEmpty(dq->fastpass_queue)) {
-        // Dequeue from fast-pass every merge_ratio regular visitors
-        if (regular_count >= dq->merge_ratio || isEmpty(dq->regular_queue)) {
-            regular_count = 0;
-            return dequeue(dq->fastpass_queue);
+    int boarded = 0;
+    Queue* lane;
+    while (boarded < seats && (lane = nextLane(dq)) != NULL) {
+        int party = getFrontPartySize(lane);
+        if (party > seats - boarded && boarded > 0) break;
+        
+        for (int i = 0; i < party && boarded < seats; i++) {
+            riders[boarded++] = dequeueLane(dq, lane);
         }
     }
     
-    // Dequeue from regular queue
-    if (!isEmpty(dq->regular_queue)) {
-        regular_count++;
-        return dequeue(dq->regular_queue);
-    }
-    
-    // If regular is empty but fast-pass has visitors
-    if (!isEmpty(dq->fastpass_queue)) {
-        regular_count = 0;
-        return dequeue(dq->fastpass_queue);
+    while (boarded < seats && !isEmpty(dq->single_rider_queue)) {
+        riders[boarded++] = dequeue(dq->single_rider_queue);
     }
+    return boarded;
+}
+
+/* Take a visitor out of whichever lane they wait in (0 = not queued here) */
+int leaveDualQueue(DualQueue* dq, Visitor* visitor) {
+    if (!dq || !visitor || visitor->queued_ride_id != dq->ride_id) return 0;
     
-    return NULL;
+    Queue* lane = dq->regular_queue;
+    if (visitor->queue_lane == LANE_FASTPASS) lane = dq->fastpass_queue;
+    if (visitor->queue_lane == LANE_SINGLE_RIDER) lane = dq->single_rider_queue;
+    return removeFromQueue(lane, visitor);
 }
 
 /* Display dual queue status */
@@ -80,6 +137,7 @@ void displayDualQueueStatus(DualQueue* dq, const char* ride_name) {
     printf("\n=== %s Queue Status ===\n", ride_name);
     printf("Regular Queue: %d visitors\n", dq->regular_queue->size);
     printf("Fast-Pass Queue: %d visitors\n", dq->fastpass_queue->size);
+    printf("Single Riders: %d visitors\n", dq->single_rider_queue->size);
     printf("Total: %d visitors\n", getTotalQueueSize(dq));
     printf("Merge Ratio: %d:1 (Regular:Fast-Pass)\n", dq->merge_ratio);
     printf("========================\n");
@@ -91,11 +149,45 @@ void freeDualQueue(DualQueue* dq) {
     
     if (dq->regular_queue) freeQueue(dq->regular_queue);
     if (dq->fastpass_queue) freeQueue(dq->fastpass_queue);
+    if (dq->single_rider_queue) freeQueue(dq->single_rider_queue);
     free(dq);
 }
 
 /* Get total queue size */
 int getTotalQueueSize(DualQueue* dq) {
     if (!dq) return 0;
-    return dq->regular_queue->size + dq->fastpass_queue->size;
+    return dq->regular_queue->size + dq->fastpass_queue->size + dq->single_rider_queue->size;
+}
+
+/* Get boarding position across both lanes - O(1).
+ * dequeueDual boards merge_ratio regular guests, then one fast-pass guest,
+ * so the other lane's share ahead follows from the lane position and how far
+ * into the current regular run we are. */
+int getDualQueuePosition(DualQueue* dq, Visitor* visitor) {
+    if (!dq || !visitor || visitor->queued_ride_id != dq->ride_id) return -1;
+    
+    int ratio = dq->merge_ratio > 0 ? dq->merge_ratio : 1;
+    int regular_before_next_fastpass = max(0, ratio - dq->regular_served);
+    
+    // Single riders only take seats parties leave, so only their own lane is ahead
+    if (visitor->queue_lane == LANE_SINGLE_RIDER) {
+        return getTicketPosition(dq->single_rider_queue, visitor);
+    }
+    
+    if (visitor->queue_lane == LANE_FASTPASS) {
+        int lane_position = getTicketPosition(dq->fastpass_queue, visitor);
+        if (lane_position < 0) return -1;
+        
+        int regular_ahead = regular_before_next_fastpass + (lane_position - 1) * ratio;
+        return lane_position + min(regular_ahead, dq->regular_queue->size);
+    }
+    
+    int lane_position = getTicketPosition(dq->regular_queue, visitor);
+    if (lane_position < 0) return -1;
+    
+    int fastpass_ahead = 0;
+    if (lane_position > regular_before_next_fastpass) {
+        fastpass_ahead = 1 + (lane_position - regular_before_next_fastpass - 1) / ratio;
+    }
+    return lane_position + min(fastpass_ahead, dq->fastpass_queue->size);
 }
@@ -3,6 +3,7 @@
 #include <string.h>
 #include <ctype.h>
 #include "../include/file_io.h"
+#include "../include/trace.h"
 
 /* Trim whitespace from string */
 char* trimWhitespace(char* str) {
@@ -48,6 +49,7 @@ int validateVisitorData(int id, int thrill_preference) {
 
 /* Load rides from file */
 int loadRidesFromFile(const char* filename, RideList* rides) {
+    TRACE_SPAN("loadRidesFromFile");
     if (!filename || !rides) return 0;
     
     FILE* file = fopen(filename, "r");
@@ -83,6 +85,12 @@ int loadRidesFromFile(const char* filename, RideList* rides) {
             if (validateRideData(id, capacity, thrill_level)) {
                 Ride* ride = createRide(id, name, capacity, thrill_level, base_wait_time);
                 if (ride) {
+                    // Optional position columns
+                    if (token_count >= 7) {
+                        ride->x = atoi(tokens[5]);
+                        ride->y = atoi(tokens[6]);
+                        ride->has_location = 1;
+                    }
                     addRideToList(rides, ride);
                     count++;
                 }
@@ -96,6 +104,7 @@ int loadRidesFromFile(const char* filename, RideList* rides) {
 
 /* Save rides to file */
 int saveRidesToFile(const char* filename, RideList* rides) {
+    TRACE_SPAN("saveRidesToFile");
     if (!filename || !rides) return 0;
     
     FILE* file = fopen(filename, "w");
@@ -104,19 +113,23 @@ int saveRidesToFile(const char* filename, RideList* rides) {
         return 0;
     }
     
-    fprintf(file, "id,name,capacity,thrill_level,wait_time\n");
+    fprintf(file, "id,name,capacity,thrill_level,wait_time,x,y\n");
     
     RideNode* current = rides->head;
     int count = 0;
     
     while (current) {
         Ride* ride = current->ride;
-        fprintf(file, "%d,%s,%d,%d,%d\n",
+        fprintf(file, "%d,%s,%d,%d,%d",
                 ride->id,
                 ride->name,
                 ride->capacity,
                 ride->thrill_level,
                 ride->current_wait_time);
+        if (ride->has_location) {
+            fprintf(file, ",%d,%d", ride->x, ride->y);
+        }
+        fprintf(file, "\n");
         count++;
         current = current->next;
     }
@@ -127,6 +140,7 @@ int saveRidesToFile(const char* filename, RideList* rides) {
 
 /* Load visitors from file */
 int loadVisitorsFromFile(const char* filename, VisitorGroup* visitors) {
+    TRACE_SPAN("loadVisitorsFromFile");
     if (!filename || !visitors) return 0;
     
     FILE* file = fopen(filename, "r");
@@ -153,9 +167,11 @@ int loadVisitorsFromFile(const char* filename, VisitorGroup* visitors) {
             int id = atoi(tokens[0]);
             char* name = tokens[1];
             int thrill_preference = atoi(tokens[2]);
+            TicketType ticket = (token_count >= 4 && atoi(tokens[3]) == TICKET_PREMIUM)
+                                ? TICKET_PREMIUM : TICKET_NORMAL;  // Optional column
             
             if (validateVisitorData(id, thrill_preference)) {
-                Visitor* visitor = createVisitor(id, name, thrill_preference);
+                Visitor* visitor = createVisitorWithTicket(id, name, thrill_preference, ticket);
                 if (visitor) {
                     addVisitorToGroup(visitors, visitor);
                     count++;
@@ -170,6 +186,7 @@ int loadVisitorsFromFile(const char* filename, VisitorGroup* visitors) {
 
 /* Save visitors to file */
 int saveVisitorsToFile(const char* filename, VisitorGroup* visitors) {
+    TRACE_SPAN("saveVisitorsToFile");
     if (!filename || !visitors) return 0;
     
     FILE* file = fopen(filename, "w");
@@ -178,17 +195,18 @@ int saveVisitorsToFile(const char* filename, VisitorGroup* visitors) {
         return 0;
     }
     
-    fprintf(file, "id,name,thrill_preference\n");
+    fprintf(file, "id,name,thrill_preference,ticket_type\n");
     
     VisitorNode* current = visitors->head;
     int count = 0;
     
     while (current) {
         Visitor* visitor = current->visitor;
-        fprintf(file, "%d,%s,%d\n",
+        fprintf(file, "%d,%s,%d,%d\n",
                 visitor->id,
                 visitor->name,
-                visitor->thrill_preference);
+                visitor->thrill_preference,
+                visitor->ticket_type);
         count++;
         current = current->next;
     }
@@ -199,6 +217,7 @@ int saveVisitorsToFile(const char* filename, VisitorGroup* visitors) {
 
 /* Load park graph from file */
 int loadParkGraph(const char* filename, Graph* graph) {
+    TRACE_SPAN("loadParkGraph");
     if (!filename || !graph) return 0;
     
     FILE* file = fopen(filename, "r");
@@ -227,16 +246,27 @@ int loadParkGraph(const char* filename, Graph* graph) {
             int distance = atoi(tokens[2]);
             
             connectRides(graph, ride1_id, ride2_id, distance);
+            // Optional endpoint positions: x1,y1,x2,y2
+            if (token_count >= 7) {
+                setNodeLocation(graph, ride1_id, atoi(tokens[3]), atoi(tokens[4]));
+                setNodeLocation(graph, ride2_id, atoi(tokens[5]), atoi(tokens[6]));
+            }
             count++;
         }
     }
     
     fclose(file);
+    
+    // Resort-scale maps: preprocess once so route queries skip most of the map
+    if (graph->num_nodes >= CONTRACTION_MIN_NODES) {
+        buildGraphHierarchy(graph);
+    }
     return count;
 }
 
 /* Save park graph to file */
 int saveParkGraph(const char* filename, Graph* graph) {
+    TRACE_SPAN("saveParkGraph");
     if (!filename || !graph) return 0;
     
     FILE* file = fopen(filename, "w");
@@ -245,16 +275,22 @@ int saveParkGraph(const char* filename, Graph* graph) {
         return 0;
     }
     
-    fprintf(file, "ride1_id,ride2_id,distance\n");
+    fprintf(file, "ride1_id,ride2_id,distance,x1,y1,x2,y2\n");
     
     int count = 0;
-    for (int i = 0; i < MAX_RIDES; i++) {
+    for (int i = 0; i < graph->capacity; i++) {
         if (graph->nodes[i]) {
             Edge* edge = graph->nodes[i]->edges;
             while (edge) {
                 // Only write each edge once (avoid duplicates)
                 if (i < edge->destination_id) {
-                    fprintf(file, "%d,%d,%d\n", i, edge->destination_id, edge->distance);
+                    int x1, y1, x2, y2;
+                    fprintf(file, "%d,%d,%d", i, edge->destination_id, edge->distance);
+                    if (getNodeLocation(graph, i, &x1, &y1) &&
+                        getNodeLocation(graph, edge->destination_id, &x2, &y2)) {
+                        fprintf(file, ",%d,%d,%d,%d", x1, y1, x2, y2);
+                    }
+                    fprintf(file, "\n");
                     count++;
                 }
                 edge = edge->next;
@@ -278,6 +314,7 @@ void logInfo(const char* message) {
 
 /* Export statistics to CSV */
 int exportStatisticsToCSV(const char* filename, RideList* rides) {
+    TRACE_SPAN("exportStatisticsToCSV");
     if (!filename || !rides) return 0;
     
     FILE* file = fopen(filename, "w");
@@ -303,6 +340,7 @@ int exportStatisticsToCSV(const char* filename, RideList* rides) {
 
 /* Export visitor history to CSV */
 int exportVisitorHistoryToCSV(const char* filename, VisitorGroup* visitors) {
+    TRACE_SPAN("exportVisitorHistoryToCSV");
     if (!filename || !visitors) return 0;
     
     FILE* file = fopen(filename, "w");
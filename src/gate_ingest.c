@@ -0,0 +1,309 @@
+/* Gate Turnstile Ingest - SPSC Ring Buffer fed by a Reader Thread */
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/gate_ingest.h"
+#include "../include/trace.h"
+#include "../include/file_io.h"
+#include "../include/utils.h"
+#include "../include/visitor_exit.h"
+#include "../include/group_registry.h"
+
+#ifdef _WIN32
+#include <windows.h>
+typedef HANDLE IngestThread;
+#define ingestSleepMs(ms) Sleep(ms)
+#else
+#include <pthread.h>
+#include <time.h>
+typedef pthread_t IngestThread;
+static void ingestSleepMs(int ms) {
+    struct timespec ts = {ms / 1000, (ms % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+}
+#endif
+
+#define RING_MASK (INGEST_RING_CAPACITY - 1)
+
+static IngestRing gate_ring;
+static IngestThread reader_thread;
+static char ingest_filename[MAX_PATH_LENGTH];
+static int reader_running = 0;
+static int stop_requested = 0;
+static long consumed_offset = -1;   // Feed offset past the last drained event (park thread)
+static long saved_offset = -1;
+
+/* Initialize ring buffer */
+void initIngestRing(IngestRing* ring) {
+    if (!ring) return;
+
+    ring->head = 0;
+    ring->tail = 0;
+    ring->dropped = 0;
+}
+
+/* Push one event (producer side). Returns 0 if the ring is full. */
+int ingestRingPush(IngestRing* ring, const GateEvent* event) {
+    unsigned int tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    unsigned int head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+    if (tail - head >= INGEST_RING_CAPACITY) {
+        return 0;
+    }
+
+    ring->slots[tail & RING_MASK] = *event;
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+/* Pop up to max_events (consumer side). Returns number popped. */
+int ingestRingPopBatch(IngestRing* ring, GateEvent* out, int max_events) {
+    unsigned int head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    unsigned int tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    int available = (int)(tail - head);
+    int count = available < max_events ? available : max_events;
+
+    for (int i = 0; i < count; i++) {
+        out[i] = ring->slots[(head + i) & RING_MASK];
+    }
+
+    __atomic_store_n(&ring->head, head + count, __ATOMIC_RELEASE);
+    return count;
+}
+
+/* Number of events waiting in the ring */
+int ingestRingSize(IngestRing* ring) {
+    unsigned int tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    unsigned int head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    return (int)(tail - head);
+}
+
+/* Parse "name,thrill_preference[,ticket_type]" (an entry) or
+ * "exit,visitor_id" into a gate event */
+int parseGateEvent(char* line, GateEvent* event) {
+    char* tokens[4];
+    int token_count = parseCSVLine(line, tokens, 4);
+    if (token_count < 2 || tokens[0][0] == '\0') return 0;
+
+    if (strcmp(tokens[0], "exit") == 0) {
+        event->exit_visitor_id = atoi(tokens[1]);
+        return event->exit_visitor_id >= FIRST_VISITOR_ID;
+    }
+    event->exit_visitor_id = 0;
+
+    int thrill = atoi(tokens[1]);
+    if (!validateInput(thrill, MIN_THRILL_LEVEL, MAX_THRILL_LEVEL)) return 0;
+
+    strncpy(event->name, tokens[0], MAX_NAME_LENGTH - 1);
+    event->name[MAX_NAME_LENGTH - 1] = '\0';
+    event->thrill_preference = thrill;
+    event->ticket_type = (token_count >= 3 && atoi(tokens[2]) == TICKET_PREMIUM)
+                         ? TICKET_PREMIUM : TICKET_NORMAL;
+    return 1;
+}
+
+/* Offset of the first gate event not yet consumed (0 if never saved) */
+static long loadGateOffset(void) {
+    long offset = 0;
+    FILE* file = fopen(GATE_OFFSET_FILE, "r");
+    if (file) {
+        if (fscanf(file, "%ld", &offset) != 1 || offset < 0) offset = 0;
+        fclose(file);
+    }
+    return offset;
+}
+
+/* Persist how far the park thread has consumed the feed (park thread only) */
+static void saveGateOffset(void) {
+    if (consumed_offset < 0 || consumed_offset == saved_offset) return;
+
+    FILE* file = fopen(GATE_OFFSET_FILE, "w");
+    if (!file) {
+        logError("Could not save gate feed offset");
+        return;
+    }
+    fprintf(file, "%ld\n", consumed_offset);
+    fclose(file);
+    saved_offset = consumed_offset;
+}
+
+/* Open the feed where the last run stopped; a feed shorter than the saved
+ * offset was rotated or truncated and is read from the start */
+static FILE* openGateFeed(void) {
+    FILE* file = fopen(ingest_filename, "r");
+    if (!file) return NULL;
+
+    long offset = loadGateOffset();
+    if (fseek(file, 0, SEEK_END) != 0 || ftell(file) < offset) offset = 0;
+    fseek(file, offset, SEEK_SET);
+    return file;
+}
+
+/* Reader thread: follows the gate events file and feeds the ring.
+ * Only whole lines become events: a line still being appended is held
+ * until its newline arrives. Each event carries the feed offset past its
+ * line; the park thread saves the offset of the last event it drained, so
+ * a restart resumes after the last admitted line. Lines read but not yet
+ * admitted (including one dropped at stop while the ring was full) are
+ * read again on the next run. */
+#ifdef _WIN32
+static DWORD WINAPI gateReaderMain(LPVOID arg) {
+#else
+static void* gateReaderMain(void* arg) {
+#endif
+    (void)arg;
+    FILE* file = NULL;
+    char line[256];
+    size_t pending = 0;       // Bytes of an unfinished line held in line[]
+    int skipping = 0;         // Discarding the rest of an overlong line
+    setTraceThreadName("gate_reader");
+
+    while (!__atomic_load_n(&stop_requested, __ATOMIC_ACQUIRE)) {
+        if (!file) {
+            file = openGateFeed();
+            if (!file) {
+                ingestSleepMs(500);  // Wait for the turnstile feed to appear
+                continue;
+            }
+        }
+
+        if (!fgets(line + pending, (int)(sizeof(line) - pending), file)) {
+            clearerr(file);       // Keep following the file like tail -f
+            ingestSleepMs(50);
+            continue;
+        }
+
+        size_t length = pending + strlen(line + pending);
+        if (length == 0 || line[length - 1] != '\n') {
+            if (length < sizeof(line) - 1) {
+                pending = length;  // Partial line at the end of the feed
+                continue;
+            }
+            if (!skipping) gate_ring.dropped++;
+            skipping = 1;         // Overlong: drop it up to its newline
+            pending = 0;
+            continue;
+        }
+        pending = 0;
+        if (skipping) {
+            skipping = 0;
+            continue;
+        }
+
+        TRACE_SPAN("gateReadEvent");
+        GateEvent event;
+        if (strstr(line, "thrill_preference") || !parseGateEvent(line, &event)) {
+            gate_ring.dropped++;
+            continue;
+        }
+        event.feed_offset = ftell(file);
+
+        // Ring full: back off until the park thread catches up
+        while (!ingestRingPush(&gate_ring, &event)) {
+            if (__atomic_load_n(&stop_requested, __ATOMIC_ACQUIRE)) break;
+            ingestSleepMs(1);
+        }
+    }
+
+    if (file) fclose(file);
+    return 0;
+}
+
+/* Start the gate reader thread */
+int startGateIngest(const char* filename) {
+    if (!filename || reader_running) return 0;
+
+    strncpy(ingest_filename, filename, MAX_PATH_LENGTH - 1);
+    ingest_filename[MAX_PATH_LENGTH - 1] = '\0';
+    initIngestRing(&gate_ring);
+    stop_requested = 0;
+    consumed_offset = -1;
+    saved_offset = -1;
+
+#ifdef _WIN32
+    reader_thread = CreateThread(NULL, 0, gateReaderMain, NULL, 0, NULL);
+    if (!reader_thread) {
+#else
+    if (pthread_create(&reader_thread, NULL, gateReaderMain, NULL) != 0) {
+#endif
+        logError("Could not start gate ingest thread");
+        return 0;
+    }
+
+    reader_running = 1;
+    return 1;
+}
+
+/* Stop the gate reader thread, admit everything still in the ring and
+ * save the feed offset (park thread only) */
+void stopGateIngest(void) {
+    if (!reader_running) return;
+
+    __atomic_store_n(&stop_requested, 1, __ATOMIC_RELEASE);
+#ifdef _WIN32
+    WaitForSingleObject(reader_thread, INFINITE);
+    CloseHandle(reader_thread);
+#else
+    pthread_join(reader_thread, NULL);
+#endif
+
+    while (ingestRingSize(&gate_ring) > 0) {
+        drainGateIngest(INGEST_BATCH_SIZE);
+    }
+    saveGateOffset();
+    reader_running = 0;
+}
+
+/* Number of turnstile events waiting for the park thread */
+int gateIngestPending(void) {
+    return reader_running ? ingestRingSize(&gate_ring) : 0;
+}
+
+/* Drain pending gate events (park thread only): each walk-in arrives as a
+ * party of one in a new registered group, exits leave the park, in the
+ * order they came through the turnstiles. IDs are reserved in one range. */
+int drainGateIngest(int max_batch) {
+    static GateEvent batch[INGEST_BATCH_SIZE];
+
+    if (!reader_running) return 0;
+    if (max_batch > INGEST_BATCH_SIZE) max_batch = INGEST_BATCH_SIZE;
+
+    int count = ingestRingPopBatch(&gate_ring, batch, max_batch);
+    if (count == 0) return 0;
+
+    TRACE_SPAN("drainGateIngest");
+    int entries = 0;
+    for (int i = 0; i < count; i++) {
+        if (batch[i].exit_visitor_id == 0) entries++;
+    }
+
+    int next_id = entries > 0 ? reserveVisitorIDs(entries) : 0;
+    int created = 0;
+
+    for (int i = 0; i < count; i++) {
+        if (batch[i].exit_visitor_id != 0) {
+            exitVisitor(batch[i].exit_visitor_id, EXIT_TURNSTILE);
+            continue;
+        }
+
+        Visitor* visitor = createVisitorWithTicket(next_id++, batch[i].name,
+                                                   batch[i].thrill_preference,
+                                                   (TicketType)batch[i].ticket_type);
+        VisitorGroup* group = visitor ? createRegisteredGroup() : NULL;
+        if (!group) {
+            freeVisitor(visitor);
+            continue;
+        }
+        addVisitorToGroup(group, visitor);
+        created++;
+    }
+
+    // Caught up: everything up to here is admitted
+    consumed_offset = batch[count - 1].feed_offset;
+    if (ingestRingSize(&gate_ring) == 0) saveGateOffset();
+    return created;
+}
@@ -2,6 +2,10 @@
 #include <stdlib.h>
 #include <limits.h>
 #include "../include/graph.h"
+#include "../include/contraction.h"
+#include "../include/metrics.h"
+#include "../include/trace.h"
+#include "../include/utils.h"
 
 /* Create graph */
 Graph* createGraph() {
@@ -11,17 +15,57 @@ Graph* createGraph() {
         return NULL;
     }
     
-    g->num_nodes = 0;
-    for (int i = 0; i < MAX_RIDES; i++) {
-        g->nodes[i] = NULL;
+    g->nodes = (GraphNode**)calloc(MAX_RIDES, sizeof(GraphNode*));
+    if (!g->nodes) {
+        fprintf(stderr, "Error: Memory allocation failed for graph nodes\n");
+        free(g);
+        return NULL;
     }
     
+    g->capacity = MAX_RIDES;
+    g->num_nodes = 0;
+    g->ride_index = NULL;
+    g->node_index = NULL;
+    g->index_stale = 0;
+    g->topology_version = 0;
+    g->hierarchy = NULL;
+    
     return g;
 }
 
+/* Grow node array so node_id fits */
+static int ensureGraphCapacity(Graph* g, int node_id) {
+    if (node_id < g->capacity) return 1;
+    
+    int new_capacity = g->capacity;
+    while (new_capacity <= node_id) {
+        new_capacity *= 2;
+    }
+    
+    GraphNode** grown = (GraphNode**)realloc(g->nodes, sizeof(GraphNode*) * new_capacity);
+    if (!grown) {
+        fprintf(stderr, "Error: Memory allocation failed for graph nodes\n");
+        return 0;
+    }
+    
+    for (int i = g->capacity; i < new_capacity; i++) {
+        grown[i] = NULL;
+    }
+    
+    g->nodes = grown;
+    g->capacity = new_capacity;
+    return 1;
+}
+
+/* Check whether node id exists in graph */
+int hasGraphNode(Graph* g, int node_id) {
+    return g && node_id >= 0 && node_id < g->capacity && g->nodes[node_id] != NULL;
+}
+
 /* Add ride to graph */
 void addRideToGraph(Graph* g, int ride_id) {
-    if (!g || ride_id < 0 || ride_id >= MAX_RIDES) return;
+    if (!g || ride_id < 0 || ride_id >= MAX_GRAPH_NODES) return;
+    if (!ensureGraphCapacity(g, ride_id)) return;
     
     if (g->nodes[ride_id] == NULL) {
         GraphNode* node = (GraphNode*)malloc(sizeof(GraphNode));
@@ -32,6 +76,9 @@ void addRideToGraph(Graph* g, int ride_id) {
         
         node->ride_id = ride_id;
         node->edges = NULL;
+        node->x = 0;
+        node->y = 0;
+        node->has_location = 0;
         g->nodes[ride_id] = node;
         g->num_nodes++;
     }
@@ -43,12 +90,14 @@ void connectRides(Graph* g, int ride1_id, int ride2_id, int distance) {
     
     addRideToGraph(g, ride1_id);
     addRideToGraph(g, ride2_id);
+    if (!hasGraphNode(g, ride1_id) || !hasGraphNode(g, ride2_id)) return;
     
     // Add edge from ride1 to ride2
     Edge* edge1 = (Edge*)malloc(sizeof(Edge));
     if (edge1) {
         edge1->destination_id = ride2_id;
         edge1->distance = distance;
+        edge1->weight = distance;
         edge1->next = g->nodes[ride1_id]->edges;
         g->nodes[ride1_id]->edges = edge1;
     }
@@ -58,16 +107,18 @@ void connectRides(Graph* g, int ride1_id, int ride2_id, int distance) {
     if (edge2) {
         edge2->destination_id = ride1_id;
         edge2->distance = distance;
+        edge2->weight = distance;
         edge2->next = g->nodes[ride2_id]->edges;
         g->nodes[ride2_id]->edges = edge2;
     }
+    g->topology_version++;
 }
 
 /* Free graph */
 void freeGraph(Graph* g) {
     if (!g) return;
     
-    for (int i = 0; i < MAX_RIDES; i++) {
+    for (int i = 0; i < g->capacity; i++) {
         if (g->nodes[i]) {
             Edge* edge = g->nodes[i]->edges;
             while (edge) {
@@ -79,6 +130,10 @@ void freeGraph(Graph* g) {
         }
     }
     
+    freeSpatialIndex(g->ride_index);
+    freeSpatialIndex(g->node_index);
+    freeContractionHierarchy(g->hierarchy);
+    free(g->nodes);
     free(g);
 }
 
@@ -88,7 +143,7 @@ void printGraph(Graph* g, RideList* rides) {
     
     printf("\n========== PARK MAP ==========\n");
     
-    for (int i = 0; i < MAX_RIDES; i++) {
+    for (int i = 0; i < g->capacity; i++) {
         if (g->nodes[i]) {
             Ride* ride = findRideById(rides, i);
             printf("\n[%d] %s:\n", i, ride ? ride->name : "Unknown");
@@ -108,54 +163,107 @@ void printGraph(Graph* g, RideList* rides) {
     printf("==============================\n");
 }
 
-/* Dijkstra's shortest path */
-PathInfo* dijkstraShortestPath(Graph* g, int start_id, int end_id) {
-    if (!g || !g->nodes[start_id] || !g->nodes[end_id]) return NULL;
+/* Min-heap of (distance, node) entries for Dijkstra */
+typedef struct DistanceHeap {
+    int* distance;
+    int* node_id;
+    int size;
+    int capacity;
+} DistanceHeap;
+
+static int heapPush(DistanceHeap* heap, int distance, int node_id) {
+    if (heap->size == heap->capacity) {
+        int new_capacity = heap->capacity ? heap->capacity * 2 : 64;
+        int* grown_distance = (int*)realloc(heap->distance, sizeof(int) * new_capacity);
+        if (!grown_distance) return 0;
+        heap->distance = grown_distance;
+        int* grown_node = (int*)realloc(heap->node_id, sizeof(int) * new_capacity);
+        if (!grown_node) return 0;
+        heap->node_id = grown_node;
+        heap->capacity = new_capacity;
+    }
     
-    int dist[MAX_RIDES];
-    int prev[MAX_RIDES];
-    int visited[MAX_RIDES] = {0};
+    int i = heap->size++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (heap->distance[parent] <= distance) break;
+        heap->distance[i] = heap->distance[parent];
+        heap->node_id[i] = heap->node_id[parent];
+        i = parent;
+    }
+    heap->distance[i] = distance;
+    heap->node_id[i] = node_id;
+    return 1;
+}
+
+static void heapPop(DistanceHeap* heap, int* distance, int* node_id) {
+    *distance = heap->distance[0];
+    *node_id = heap->node_id[0];
+    
+    int last_distance = heap->distance[--heap->size];
+    int last_node = heap->node_id[heap->size];
+    int i = 0;
     
-    for (int i = 0; i < MAX_RIDES; i++) {
+    while (1) {
+        int child = 2 * i + 1;
+        if (child >= heap->size) break;
+        if (child + 1 < heap->size && heap->distance[child + 1] < heap->distance[child]) child++;
+        if (heap->distance[child] >= last_distance) break;
+        heap->distance[i] = heap->distance[child];
+        heap->node_id[i] = heap->node_id[child];
+        i = child;
+    }
+    heap->distance[i] = last_distance;
+    heap->node_id[i] = last_node;
+}
+
+/* Settle nodes outward from start_id until every stop node is settled
+ * (stop_count 0 = all). dist/prev must hold g->capacity entries.
+ * Returns 0 on allocation failure. */
+static int searchShortestPaths(Graph* g, int start_id, const int* stop_ids, int stop_count,
+                               int* dist, int* prev) {
+    DistanceHeap heap = {NULL, NULL, 0, 0};
+    int remaining = stop_count;
+    int ok = 1;
+    
+    for (int i = 0; i < g->capacity; i++) {
         dist[i] = INT_MAX;
         prev[i] = -1;
     }
     
     dist[start_id] = 0;
+    ok = heapPush(&heap, 0, start_id);
     
-    for (int count = 0; count < g->num_nodes; count++) {
-        int min_dist = INT_MAX;
-        int u = -1;
+    while (ok && heap.size > 0) {
+        int d, u;
+        heapPop(&heap, &d, &u);
         
-        for (int i = 0; i < MAX_RIDES; i++) {
-            if (!visited[i] && g->nodes[i] && dist[i] < min_dist) {
-                min_dist = dist[i];
-                u = i;
-            }
+        if (d > dist[u]) continue;  // Stale entry, node already settled closer
+        for (int i = 0; i < stop_count; i++) {
+            if (stop_ids[i] == u) remaining--;
         }
-        
-        if (u == -1) break;
-        visited[u] = 1;
-        
-        if (u == end_id) break;
+        if (stop_count > 0 && remaining <= 0) break;
         
         Edge* edge = g->nodes[u]->edges;
-        while (edge) {
+        while (edge && ok) {
             int v = edge->destination_id;
-            if (!visited[v] && dist[u] != INT_MAX) {
-                int new_dist = dist[u] + edge->distance;
-                if (new_dist < dist[v]) {
-                    dist[v] = new_dist;
-                    prev[v] = u;
-                }
+            int new_dist = d + edge->distance;
+            if (new_dist < dist[v]) {
+                dist[v] = new_dist;
+                prev[v] = u;
+                ok = heapPush(&heap, new_dist, v);
             }
             edge = edge->next;
         }
     }
     
-    if (dist[end_id] == INT_MAX) return NULL;
-    
-    // Reconstruct path
+    free(heap.distance);
+    free(heap.node_id);
+    return ok;
+}
+
+/* Walk prev[] back from end_id into a PathInfo */
+static PathInfo* buildPathInfo(int* prev, int total_distance, int end_id) {
     int path_length = 0;
     int temp = end_id;
     while (temp != -1) {
@@ -164,9 +272,15 @@ PathInfo* dijkstraShortestPath(Graph* g, int start_id, int end_id) {
     }
     
     PathInfo* path_info = (PathInfo*)malloc(sizeof(PathInfo));
+    if (!path_info) return NULL;
+    
     path_info->path = (int*)malloc(sizeof(int) * path_length);
+    if (!path_info->path) {
+        free(path_info);
+        return NULL;
+    }
     path_info->path_length = path_length;
-    path_info->total_distance = dist[end_id];
+    path_info->total_distance = total_distance;
     
     temp = end_id;
     for (int i = path_length - 1; i >= 0; i--) {
@@ -177,6 +291,272 @@ PathInfo* dijkstraShortestPath(Graph* g, int start_id, int end_id) {
     return path_info;
 }
 
+/* Dijkstra's shortest path (binary heap with lazy deletion) */
+PathInfo* dijkstraShortestPath(Graph* g, int start_id, int end_id) {
+    if (!hasGraphNode(g, start_id) || !hasGraphNode(g, end_id)) return NULL;
+    
+    TRACE_SPAN("dijkstraShortestPath");
+    long long started = getMonotonicNanos();
+    metricAdd(METRIC_DIJKSTRA_CALLS, 1);
+    
+    int* dist = (int*)malloc(sizeof(int) * g->capacity);
+    int* prev = (int*)malloc(sizeof(int) * g->capacity);
+    PathInfo* path_info = NULL;
+    
+    if (!dist || !prev) {
+        fprintf(stderr, "Error: Memory allocation failed for path search\n");
+    } else if (!searchShortestPaths(g, start_id, &end_id, 1, dist, prev)) {
+        fprintf(stderr, "Error: Memory allocation failed for path search\n");
+    } else if (dist[end_id] != INT_MAX) {
+        path_info = buildPathInfo(prev, dist[end_id], end_id);
+    }
+    
+    free(dist);
+    free(prev);
+    metricObserveSince(METRIC_DIJKSTRA_SECONDS, started);
+    return path_info;
+}
+
+/* Point-to-point route: through the contraction hierarchy while it is
+ * current, plain Dijkstra otherwise (small maps, or edges added since) */
+PathInfo* findShortestRoute(Graph* g, int start_id, int end_id) {
+    if (!hasGraphNode(g, start_id) || !hasGraphNode(g, end_id)) return NULL;
+    // Nodes added after the build (no walkways yet) are left to Dijkstra
+    ContractionHierarchy* ch = g->hierarchy;
+    if (!isContractionHierarchyCurrent(g, ch) || start_id >= ch->capacity || end_id >= ch->capacity ||
+        ch->rank[start_id] == -1 || ch->rank[end_id] == -1) {
+        return dijkstraShortestPath(g, start_id, end_id);
+    }
+    
+    long long started = getMonotonicNanos();
+    metricAdd(METRIC_DIJKSTRA_CALLS, 1);
+    PathInfo* path_info = hierarchyShortestPath(ch, start_id, end_id);
+    metricObserveSince(METRIC_DIJKSTRA_SECONDS, started);
+    return path_info;
+}
+
+/* Preprocess the current map for findShortestRoute - 0 on failure */
+int buildGraphHierarchy(Graph* g) {
+    if (!g) return 0;
+    
+    freeContractionHierarchy(g->hierarchy);
+    g->hierarchy = buildContractionHierarchy(g);
+    return g->hierarchy != NULL;
+}
+
+/* Walking distance from start_id to each target in one search
+ * (-1 where unreachable). Returns 0 on failure. */
+int walkingDistances(Graph* g, int start_id, const int targets[], int count, int distances[]) {
+    for (int i = 0; i < count; i++) distances[i] = -1;
+    if (!hasGraphNode(g, start_id) || count <= 0) return 0;
+    
+    TRACE_SPAN("walkingDistances");
+    long long started = getMonotonicNanos();
+    metricAdd(METRIC_DIJKSTRA_CALLS, 1);
+    
+    // Only targets that exist can be settled; the rest would keep the search going
+    int* stops = (int*)malloc(sizeof(int) * count);
+    int* dist = (int*)malloc(sizeof(int) * g->capacity);
+    int* prev = (int*)malloc(sizeof(int) * g->capacity);
+    int stop_count = 0;
+    int ok = 0;
+    
+    if (!stops || !dist || !prev) {
+        fprintf(stderr, "Error: Memory allocation failed for path search\n");
+    } else {
+        for (int i = 0; i < count; i++) {
+            if (hasGraphNode(g, targets[i])) stops[stop_count++] = targets[i];
+        }
+        ok = stop_count == 0 || searchShortestPaths(g, start_id, stops, stop_count, dist, prev);
+        if (!ok) fprintf(stderr, "Error: Memory allocation failed for path search\n");
+    }
+    
+    for (int i = 0; ok && i < count; i++) {
+        if (hasGraphNode(g, targets[i]) && dist[targets[i]] != INT_MAX) {
+            distances[i] = dist[targets[i]];
+        }
+    }
+    
+    free(stops);
+    free(dist);
+    free(prev);
+    metricObserveSince(METRIC_DIJKSTRA_SECONDS, started);
+    return ok;
+}
+
+/* Settle outward from the heap over edge weights, improving dist/parent */
+static int propagateWeights(Graph* g, DistanceHeap* heap, int* dist, int* parent) {
+    int ok = 1;
+    while (ok && heap->size > 0) {
+        int d, u;
+        heapPop(heap, &d, &u);
+        if (d > dist[u]) continue;  // Stale entry
+        
+        for (Edge* edge = g->nodes[u]->edges; edge && ok; edge = edge->next) {
+            int v = edge->destination_id;
+            int new_dist = d + edge->weight;
+            if (new_dist < dist[v]) {
+                dist[v] = new_dist;
+                parent[v] = u;
+                ok = heapPush(heap, new_dist, v);
+            }
+        }
+    }
+    return ok;
+}
+
+/* Append to a growable id list - 0 on allocation failure */
+static int appendNode(int** list, int* size, int* capacity, int node_id) {
+    if (*size == *capacity) {
+        int new_capacity = *capacity ? *capacity * 2 : 64;
+        int* grown = (int*)realloc(*list, sizeof(int) * new_capacity);
+        if (!grown) return 0;
+        *list = grown;
+        *capacity = new_capacity;
+    }
+    (*list)[(*size)++] = node_id;
+    return 1;
+}
+
+/* Dijkstra over edge weights from source_id, kept for later repairs */
+ShortestPathTree* buildShortestPathTree(Graph* g, int source_id) {
+    if (!hasGraphNode(g, source_id)) return NULL;
+    
+    TRACE_SPAN("buildShortestPathTree");
+    long long started = getMonotonicNanos();
+    metricAdd(METRIC_DIJKSTRA_CALLS, 1);
+    
+    ShortestPathTree* tree = (ShortestPathTree*)malloc(sizeof(ShortestPathTree));
+    if (!tree) {
+        fprintf(stderr, "Error: Memory allocation failed for shortest-path tree\n");
+        return NULL;
+    }
+    tree->source = source_id;
+    tree->capacity = g->capacity;
+    tree->topology = g->topology_version;
+    tree->dist = (int*)malloc(sizeof(int) * g->capacity);
+    tree->parent = (int*)malloc(sizeof(int) * g->capacity);
+    tree->affected = (unsigned char*)calloc(g->capacity, 1);
+    
+    DistanceHeap heap = {NULL, NULL, 0, 0};
+    int ok = tree->dist && tree->parent && tree->affected;
+    if (ok) {
+        for (int i = 0; i < g->capacity; i++) {
+            tree->dist[i] = INT_MAX;
+            tree->parent[i] = -1;
+        }
+        tree->dist[source_id] = 0;
+        ok = heapPush(&heap, 0, source_id) && propagateWeights(g, &heap, tree->dist, tree->parent);
+    }
+    free(heap.distance);
+    free(heap.node_id);
+    
+    if (!ok) {
+        fprintf(stderr, "Error: Memory allocation failed for shortest-path tree\n");
+        freeShortestPathTree(tree);
+        tree = NULL;
+    }
+    metricObserveSince(METRIC_DIJKSTRA_SECONDS, started);
+    return tree;
+}
+
+/* A tree is reusable until nodes or edges are added to the graph */
+int isShortestPathTreeCurrent(Graph* g, ShortestPathTree* tree) {
+    return g && tree && tree->capacity == g->capacity && tree->topology == g->topology_version;
+}
+
+/* Bring a tree up to date after the given arcs changed weight (the graph
+ * already holds the new weights). Returns 0 on failure; rebuild then. */
+int repairShortestPathTree(Graph* g, ShortestPathTree* tree, const EdgeChange changes[], int count) {
+    if (!isShortestPathTreeCurrent(g, tree)) return 0;
+    
+    TRACE_SPAN("repairShortestPathTree");
+    int* dist = tree->dist;
+    int* parent = tree->parent;
+    unsigned char* affected = tree->affected;
+    DistanceHeap heap = {NULL, NULL, 0, 0};
+    int* stack = NULL;
+    int* nodes = NULL;
+    int stack_size = 0, stack_capacity = 0;
+    int node_count = 0, node_capacity = 0;
+    int ok = 1;
+    
+    // 1. A heavier tree arc invalidates the subtree below it
+    for (int i = 0; ok && i < count; i++) {
+        if (changes[i].new_weight > changes[i].old_weight && parent[changes[i].to_id] == changes[i].from_id) {
+            ok = appendNode(&stack, &stack_size, &stack_capacity, changes[i].to_id);
+        }
+    }
+    while (ok && stack_size > 0) {
+        int x = stack[--stack_size];
+        if (affected[x]) continue;
+        affected[x] = 1;
+        ok = appendNode(&nodes, &node_count, &node_capacity, x);
+        for (Edge* edge = g->nodes[x]->edges; edge && ok; edge = edge->next) {
+            int y = edge->destination_id;
+            if (parent[y] == x && !affected[y]) ok = appendNode(&stack, &stack_size, &stack_capacity, y);
+        }
+    }
+    
+    // 2. Invalidated nodes restart from their best intact neighbour
+    for (int i = 0; i < node_count; i++) {
+        dist[nodes[i]] = INT_MAX;
+        parent[nodes[i]] = -1;
+    }
+    for (int i = 0; ok && i < node_count; i++) {
+        int x = nodes[i];
+        for (Edge* edge = g->nodes[x]->edges; edge; edge = edge->next) {
+            int y = edge->destination_id;  // Undirected: the arc y -> x has the same weight
+            if (affected[y] || dist[y] == INT_MAX) continue;
+            if (dist[y] + edge->weight < dist[x]) {
+                dist[x] = dist[y] + edge->weight;
+                parent[x] = y;
+            }
+        }
+        if (dist[x] != INT_MAX) ok = heapPush(&heap, dist[x], x);
+    }
+    
+    // 3. Lighter arcs may shorten paths anywhere downstream
+    for (int i = 0; ok && i < count; i++) {
+        int u = changes[i].from_id;
+        int v = changes[i].to_id;
+        if (changes[i].new_weight < changes[i].old_weight && dist[u] != INT_MAX &&
+            dist[u] + changes[i].new_weight < dist[v]) {
+            dist[v] = dist[u] + changes[i].new_weight;
+            parent[v] = u;
+            ok = heapPush(&heap, dist[v], v);
+        }
+    }
+    
+    // 4. Settle only what the seeds can improve
+    ok = ok && propagateWeights(g, &heap, dist, parent);
+    
+    for (int i = 0; i < node_count; i++) {
+        affected[nodes[i]] = 0;
+    }
+    free(stack);
+    free(nodes);
+    free(heap.distance);
+    free(heap.node_id);
+    return ok;
+}
+
+/* Path from the tree's source to end_id (total_distance is the weighted cost) */
+PathInfo* pathFromTree(ShortestPathTree* tree, int end_id) {
+    if (!tree || end_id < 0 || end_id >= tree->capacity || tree->dist[end_id] == INT_MAX) return NULL;
+    return buildPathInfo(tree->parent, tree->dist[end_id], end_id);
+}
+
+/* Free shortest-path tree */
+void freeShortestPathTree(ShortestPathTree* tree) {
+    if (tree) {
+        free(tree->dist);
+        free(tree->parent);
+        free(tree->affected);
+        free(tree);
+    }
+}
+
 /* Display path */
 void displayPath(int path[], int path_length, RideList* rides) {
     if (!path || path_length <= 0) {
@@ -187,7 +567,7 @@ void displayPath(int path[], int path_length, RideList* rides) {
     printf("\n--- Path ---\n");
     for (int i = 0; i < path_length; i++) {
         Ride* ride = findRideById(rides, path[i]);
-        printf("%d. [%d] %s\n", i + 1, path[i], ride ? ride->name : "Unknown");
+        printf("%d. [%d] %s\n", i + 1, path[i], ride ? ride->name : "Walkway");
         if (i < path_length - 1) printf("   |\n   v\n");
     }
     printf("------------\n");
@@ -195,7 +575,7 @@ void displayPath(int path[], int path_length, RideList* rides) {
 
 /* Get distance between two rides */
 int getDistanceBetweenRides(Graph* g, int ride1_id, int ride2_id) {
-    if (!g || !g->nodes[ride1_id]) return -1;
+    if (!hasGraphNode(g, ride1_id)) return -1;
     
     Edge* edge = g->nodes[ride1_id]->edges;
     while (edge) {
@@ -244,11 +624,131 @@ int calculateTotalDistance(int path[], int path_length, Graph* g) {
     return total;
 }
 
-/* Find nearest rides */
+/* Place a node on the park plane (meters) */
+void setNodeLocation(Graph* g, int node_id, int x, int y) {
+    if (!hasGraphNode(g, node_id)) return;
+    
+    GraphNode* node = g->nodes[node_id];
+    if (!node->has_location || node->x != x || node->y != y) {
+        node->x = x;
+        node->y = y;
+        node->has_location = 1;
+        g->index_stale = 1;
+    }
+}
+
+/* Read a node's position - 0 if it has none */
+int getNodeLocation(Graph* g, int node_id, int* x, int* y) {
+    if (!hasGraphNode(g, node_id) || !g->nodes[node_id]->has_location) return 0;
+    *x = g->nodes[node_id]->x;
+    *y = g->nodes[node_id]->y;
+    return 1;
+}
+
+/* Rides and map nodes share ids: a position given in rides.txt places the
+ * map node (adding it if no walkway reaches the ride yet), and a ride
+ * without one takes its map node's position */
+void syncRideLocations(Graph* g, RideList* rides) {
+    if (!g || !rides) return;
+    
+    for (RideNode* current = rides->head; current; current = current->next) {
+        Ride* ride = current->ride;
+        if (ride->has_location) {
+            addRideToGraph(g, ride->id);
+            setNodeLocation(g, ride->id, ride->x, ride->y);
+        } else if (getNodeLocation(g, ride->id, &ride->x, &ride->y)) {
+            ride->has_location = 1;
+        }
+    }
+}
+
+/* Rebuild both k-d trees if a location changed since the last query */
+static int refreshSpatialIndexes(Graph* g) {
+    if (!g->index_stale && g->node_index) return 1;
+    
+    SpatialPoint* points = (SpatialPoint*)malloc(sizeof(SpatialPoint) * (g->num_nodes > 0 ? g->num_nodes : 1));
+    if (!points) {
+        fprintf(stderr, "Error: Memory allocation failed for spatial index\n");
+        return 0;
+    }
+    
+    // In id order the rides sit between the entrance (0) and the junctions
+    int count = 0;
+    int rides_begin = 0;
+    int rides_end = 0;
+    for (int i = 0; i < g->capacity && count < g->num_nodes; i++) {
+        GraphNode* node = g->nodes[i];
+        if (!node || !node->has_location) continue;
+        points[count].x = node->x;
+        points[count].y = node->y;
+        points[count].id = i;
+        count++;
+        if (i == 0) rides_begin = count;
+        if (i < MAX_RIDES) rides_end = count;
+    }
+    
+    SpatialIndex* ride_index = buildSpatialIndex(points + rides_begin, rides_end - rides_begin);
+    SpatialIndex* node_index = buildSpatialIndex(points, count);
+    free(points);
+    
+    if (!ride_index || !node_index) {
+        freeSpatialIndex(ride_index);
+        freeSpatialIndex(node_index);
+        return 0;
+    }
+    
+    freeSpatialIndex(g->ride_index);
+    freeSpatialIndex(g->node_index);
+    g->ride_index = ride_index;
+    g->node_index = node_index;
+    g->index_stale = 0;
+    return 1;
+}
+
+/* Up to n located rides nearest to (x, y) in straight-line distance,
+ * nearest first, among those accept() allows (NULL = all) */
+int findNearestRidesAt(Graph* g, int x, int y, int n, SpatialFilter accept, void* context, SpatialMatch* out) {
+    if (!g || !refreshSpatialIndexes(g)) return 0;
+    return findNearestPoints(g->ride_index, x, y, n, accept, context, out);
+}
+
+static int hasWalkway(int id, void* context) {
+    return ((Graph*)context)->nodes[id]->edges != NULL;
+}
+
+/* Closest located node on a walkway to (x, y), -1 if none */
+int findNearestNode(Graph* g, int x, int y) {
+    SpatialMatch match;
+    if (!g || !refreshSpatialIndexes(g)) return -1;
+    return findNearestPoints(g->node_index, x, y, 1, hasWalkway, g, &match) == 1 ? match.id : -1;
+}
+
+static int isOtherNode(int id, void* context) {
+    return id != *(int*)context;
+}
+
+/* Find the n rides nearest to a located node (caller frees the ids) */
 int* findNearestRides(Graph* g, int current_location, int n, int* count) {
-    // Simplified implementation
     *count = 0;
-    return NULL;
+    int x, y;
+    if (n <= 0 || !getNodeLocation(g, current_location, &x, &y)) return NULL;
+    
+    SpatialMatch* matches = (SpatialMatch*)malloc(sizeof(SpatialMatch) * n);
+    int* ride_ids = (int*)malloc(sizeof(int) * n);
+    if (!matches || !ride_ids) {
+        fprintf(stderr, "Error: Memory allocation failed for nearest rides\n");
+        free(matches);
+        free(ride_ids);
+        return NULL;
+    }
+    
+    *count = findNearestRidesAt(g, x, y, n, isOtherNode, &current_location, matches);
+    for (int i = 0; i < *count; i++) {
+        ride_ids[i] = matches[i].id;
+    }
+    
+    free(matches);
+    return ride_ids;
 }
 
 /* Optimize visitor route */
@@ -0,0 +1,252 @@
+/* Group Registry: Growable Group Array and Visitor Index */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/group_registry.h"
+#include "../include/utils.h"
+
+/* Open-addressing slot, empty while value is NULL */
+typedef struct IdSlot {
+    int key;
+    void* value;         // VisitorGroup* or VisitorNode*
+    Stack* history;      // Visitor index only: the visitor's undo stack
+} IdSlot;
+
+/* Linear probing with backward-shift deletion (no tombstones) */
+typedef struct IdIndex {
+    IdSlot* slots;
+    size_t capacity;     // Power of two, 0 until first insert
+    size_t count;
+} IdIndex;
+
+static VisitorGroup** groups = NULL;
+static int group_count = 0;
+static int group_capacity = 0;
+static IdIndex group_index;
+static IdIndex visitor_index;
+
+static size_t hashId(int key) {
+    unsigned int h = (unsigned int)key * 2654435761u;
+    return (size_t)(h ^ (h >> 16));
+}
+
+/* Slot holding key, or capacity if absent */
+static size_t indexFind(const IdIndex* index, int key) {
+    if (index->capacity == 0) return 0;
+
+    size_t mask = index->capacity - 1;
+    for (size_t slot = hashId(key) & mask; index->slots[slot].value; slot = (slot + 1) & mask) {
+        if (index->slots[slot].key == key) return slot;
+    }
+    return index->capacity;
+}
+
+static int indexResize(IdIndex* index, size_t capacity) {
+    IdSlot* slots = (IdSlot*)calloc(capacity, sizeof(IdSlot));
+    if (!slots) {
+        fprintf(stderr, "Error: Memory allocation failed for id index\n");
+        return 0;
+    }
+
+    size_t mask = capacity - 1;
+    for (size_t i = 0; i < index->capacity; i++) {
+        if (!index->slots[i].value) continue;
+        size_t slot = hashId(index->slots[i].key) & mask;
+        while (slots[slot].value) slot = (slot + 1) & mask;
+        slots[slot] = index->slots[i];
+    }
+
+    free(index->slots);
+    index->slots = slots;
+    index->capacity = capacity;
+    return 1;
+}
+
+/* Slot for key with value set (existing key keeps its history); NULL if out of memory */
+static IdSlot* indexInsert(IdIndex* index, int key, void* value) {
+    if ((index->count + 1) * 4 > index->capacity * 3) {
+        size_t capacity = index->capacity ? index->capacity * 2 : GROUP_REGISTRY_INITIAL_CAPACITY;
+        if (!indexResize(index, capacity)) return NULL;
+    }
+
+    size_t mask = index->capacity - 1;
+    size_t slot = hashId(key) & mask;
+    while (index->slots[slot].value && index->slots[slot].key != key) slot = (slot + 1) & mask;
+
+    if (!index->slots[slot].value) {
+        index->slots[slot].key = key;
+        index->slots[slot].history = NULL;
+        index->count++;
+    }
+    index->slots[slot].value = value;
+    return &index->slots[slot];
+}
+
+/* Empty a slot and pull later entries of the probe run back into the hole */
+static void indexErase(IdIndex* index, size_t slot) {
+    size_t mask = index->capacity - 1;
+    size_t hole = slot;
+
+    for (size_t next = (hole + 1) & mask; index->slots[next].value; next = (next + 1) & mask) {
+        size_t home = hashId(index->slots[next].key) & mask;
+        // The entry may move back only if its home is not past the hole
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            index->slots[hole] = index->slots[next];
+            hole = next;
+        }
+    }
+
+    index->slots[hole].value = NULL;
+    index->slots[hole].history = NULL;
+    index->count--;
+
+    if (index->capacity > GROUP_REGISTRY_INITIAL_CAPACITY && index->count * 8 < index->capacity) {
+        indexResize(index, index->capacity / 2);  // Keeps the larger table if this fails
+    }
+}
+
+static void freeIndex(IdIndex* index) {
+    free(index->slots);
+    index->slots = NULL;
+    index->capacity = 0;
+    index->count = 0;
+}
+
+/* New empty group with the next group id, already registered */
+VisitorGroup* createRegisteredGroup(void) {
+    VisitorGroup* group = createVisitorGroup(generateGroupID());
+    if (group && !registerGroup(group)) {
+        freeVisitorGroup(group);
+        return NULL;
+    }
+    return group;
+}
+
+/* Add a group to the registry - amortized O(1). Returns 0 on failure. */
+int registerGroup(VisitorGroup* group) {
+    if (!group) return 0;
+    if (group->registry_slot >= 0) return 1;
+
+    if (group_count == group_capacity) {
+        int capacity = group_capacity ? group_capacity * 2 : GROUP_REGISTRY_INITIAL_CAPACITY;
+        VisitorGroup** grown = (VisitorGroup**)realloc(groups, sizeof(VisitorGroup*) * capacity);
+        if (!grown) {
+            fprintf(stderr, "Error: Memory allocation failed for group registry\n");
+            return 0;
+        }
+        groups = grown;
+        group_capacity = capacity;
+    }
+
+    if (!indexInsert(&group_index, group->group_id, group)) return 0;
+
+    group->registry_slot = group_count;
+    groups[group_count++] = group;
+    return 1;
+}
+
+/* Take a group out of the registry (its visitors stay indexed) - O(1) */
+void unregisterGroup(VisitorGroup* group) {
+    if (!group || group->registry_slot < 0) return;
+
+    int slot = group->registry_slot;
+    groups[slot] = groups[--group_count];
+    groups[slot]->registry_slot = slot;
+    group->registry_slot = -1;
+
+    size_t found = indexFind(&group_index, group->group_id);
+    if (found < group_index.capacity && group_index.slots[found].value == group) {
+        indexErase(&group_index, found);
+    }
+
+    if (group_capacity > GROUP_REGISTRY_INITIAL_CAPACITY && group_count * 4 < group_capacity) {
+        VisitorGroup** shrunk = (VisitorGroup**)realloc(groups, sizeof(VisitorGroup*) * (group_capacity / 2));
+        if (shrunk) {
+            groups = shrunk;
+            group_capacity /= 2;
+        }
+    }
+}
+
+VisitorGroup* findGroupById(int group_id) {
+    size_t slot = indexFind(&group_index, group_id);
+    return slot < group_index.capacity ? (VisitorGroup*)group_index.slots[slot].value : NULL;
+}
+
+/* Dense array of registered groups; valid until the next register or unregister */
+VisitorGroup** getGroups(void) {
+    return groups;
+}
+
+int getGroupCount(void) {
+    return group_count;
+}
+
+/* Free every registered group with its visitors, then the indexes */
+void freeGroupRegistry(void) {
+    while (group_count > 0) {
+        freeVisitorGroup(groups[group_count - 1]);  // Unregisters itself
+    }
+
+    free(groups);
+    groups = NULL;
+    group_capacity = 0;
+    freeIndex(&group_index);
+
+    // Visitors of unregistered groups are still indexed; only their stacks are ours
+    for (size_t i = 0; i < visitor_index.capacity; i++) {
+        if (visitor_index.slots[i].value) freeStack(visitor_index.slots[i].history);
+    }
+    freeIndex(&visitor_index);
+}
+
+/* Node was linked into node->group - amortized O(1) */
+void indexVisitorNode(VisitorNode* node) {
+    if (node) indexInsert(&visitor_index, node->visitor->id, node);
+}
+
+/* Node is being unlinked: drop it from the index and free the visitor's
+ * undo stack - O(1). A node that was shadowed by a later one with the same
+ * id leaves the index alone. */
+void unindexVisitorNode(VisitorNode* node) {
+    if (!node) return;
+
+    size_t slot = indexFind(&visitor_index, node->visitor->id);
+    if (slot >= visitor_index.capacity || visitor_index.slots[slot].value != node) return;
+
+    freeStack(visitor_index.slots[slot].history);
+    indexErase(&visitor_index, slot);
+}
+
+VisitorNode* findVisitorNode(int visitor_id) {
+    size_t slot = indexFind(&visitor_index, visitor_id);
+    return slot < visitor_index.capacity ? (VisitorNode*)visitor_index.slots[slot].value : NULL;
+}
+
+Visitor* findVisitorById(int visitor_id) {
+    VisitorNode* node = findVisitorNode(visitor_id);
+    return node ? node->visitor : NULL;
+}
+
+VisitorGroup* findVisitorGroup(int visitor_id) {
+    VisitorNode* node = findVisitorNode(visitor_id);
+    return node ? node->group : NULL;
+}
+
+Stack* getVisitorHistoryStack(int visitor_id) {
+    size_t slot = indexFind(&visitor_index, visitor_id);
+    return slot < visitor_index.capacity ? visitor_index.slots[slot].history : NULL;
+}
+
+/* Hand the visitor's undo stack to the index (freed when they leave).
+ * Returns 0 if the visitor is not in a group. */
+int attachVisitorHistoryStack(int visitor_id, Stack* history) {
+    size_t slot = indexFind(&visitor_index, visitor_id);
+    if (slot >= visitor_index.capacity) return 0;
+
+    if (visitor_index.slots[slot].history != history) {
+        freeStack(visitor_index.slots[slot].history);
+        visitor_index.slots[slot].history = history;
+    }
+    return 1;
+}
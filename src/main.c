@@ -13,16 +13,23 @@
 #include "../include/file_io.h"
 #include "../include/utils.h"
 #include "../include/web_server.h"
+#include "../include/gate_ingest.h"
+#include "../include/ride_simulator.h"
+#include "../include/response_cache.h"
+#include "../include/congestion.h"
+#include "../include/time_to_ride.h"
+#include "../include/crowd_balancer.h"
+#include "../include/virtual_queue.h"
+#include "../include/visitor_exit.h"
+#include "../include/group_registry.h"
 #include <time.h>
 
 /* Global data structures */
 RideList* park_rides = NULL;
 Graph* park_map = NULL;
 BST* wait_time_bst = NULL;
-VisitorGroup* visitor_groups[100];
 DualQueue* ride_queues[MAX_RIDES];
-Stack* visitor_histories[MAX_VISITORS];
-int group_count = 0;
+int menu_group_id = -1;  // Group that menu-added visitors are filling
 
 /* Function prototypes */
 void displayMenu();
@@ -34,7 +41,7 @@ void showQueueStatus();
 void displayVisitorHistory();
 void findShortestPath();
 void showRidesByWaitTime();
-void simulateRideCompletion();
+void enjoyRide();
 void handleUndoRide();
 void displayParkStatistics();
 void addNewRide();
@@ -42,12 +49,16 @@ void removeRide();
 void removeVisitor();
 void editRideDetails();
 void toggleRideStatus();
+void processGateEvents();
 
 int main() {
     initializeSystem();
     
     // Start web server
-    startWebServer(park_rides, visitor_groups, &group_count, ride_queues, wait_time_bst, park_map);
+    startWebServer(park_rides, ride_queues, wait_time_bst, park_map);
+    
+    // Start turnstile feed reader
+    startGateIngest(GATE_EVENTS_FILE);
     
     int choice;
     
@@ -61,6 +72,10 @@ int main() {
         // Poll server while waiting for input
         while (!_kbhit()) {
             pollWebServer();
+            processGateEvents();
+            updateRideStatus(park_rides, ride_queues);
+            sweepVisitorExits(time(NULL));
+            runCrowdBalancer(park_rides, ride_queues, park_map);
             Sleep(50);  // Sleep 50ms between polls
         }
         
@@ -108,7 +123,7 @@ int main() {
                 findShortestPath();
                 break;
             case 14:
-                simulateRideCompletion();
+                enjoyRide();
                 break;
             case 0:
                 printf("\nThank you for visiting! Saving data...\n");
@@ -173,6 +188,7 @@ void initializeSystem() {
     park_map = createGraph();
     if (park_map) {
         loadParkGraph(PARK_MAP_FILE, park_map);
+        syncRideLocations(park_map, park_rides);
     }
     
     // Initialize BST
@@ -181,20 +197,14 @@ void initializeSystem() {
         rebuildBST(wait_time_bst, park_rides);
     }
     
+    initializeRideSimulator();
+    
     // Initialize queues for each ride
     for (int i = 0; i < MAX_RIDES; i++) {
         ride_queues[i] = NULL;
     }
     
-    // Initialize visitor histories
-    for (int i = 0; i < MAX_VISITORS; i++) {
-        visitor_histories[i] = NULL;
-    }
-    
-    // Initialize visitor groups
-    for (int i = 0; i < 100; i++) {
-        visitor_groups[i] = NULL;
-    }
+    initVisitorExits(ride_queues);
     
     printSuccess("System initialized successfully!");
 }
@@ -203,8 +213,9 @@ void initializeSystem() {
 void shutdownSystem() {
     printInfo("Shutting down system and saving data...");
     
-    // Stop web server
+    // Stop web server and turnstile feed
     stopWebServer();
+    stopGateIngest();
     
     // Save data
     if (park_rides) {
@@ -217,6 +228,10 @@ void shutdownSystem() {
     
     // Free memory
     shutdownParkSystem(park_rides);
+    resetCongestion();  // Cached route trees point into the park map
+    clearTimeToRideCache();
+    resetCrowdBalancer();
+    resetVirtualQueues();
     freeGraph(park_map);
     freeBST(wait_time_bst);
     
@@ -224,13 +239,7 @@ void shutdownSystem() {
         if (ride_queues[i]) freeDualQueue(ride_queues[i]);
     }
     
-    for (int i = 0; i < MAX_VISITORS; i++) {
-        if (visitor_histories[i]) freeStack(visitor_histories[i]);
-    }
-    
-    for (int i = 0; i < group_count; i++) {
-        if (visitor_groups[i]) freeVisitorGroup(visitor_groups[i]);
-    }
+    freeGroupRegistry();  // Groups, visitors and their histories
     
     printSuccess("System shutdown complete. Goodbye!");
 }
@@ -259,15 +268,22 @@ void addVisitorToPark() {
         return;
     }
     
-    // Ensure current group exists; create only if missing
-    if (visitor_groups[group_count] == NULL) {
-        visitor_groups[group_count] = createVisitorGroup(generateGroupID());
+    // Fill the current group; start a new one once it is full or gone
+    VisitorGroup* group = findGroupById(menu_group_id);
+    if (!group || group->size >= MENU_GROUP_SIZE) {
+        group = createRegisteredGroup();
+        if (!group) {
+            freeVisitor(visitor);
+            printError("Failed to create visitor group");
+            return;
+        }
+        menu_group_id = group->group_id;
     }
     
-    addVisitorToGroup(visitor_groups[group_count], visitor);
+    addVisitorToGroup(group, visitor);
     
     // Create history stack for visitor
-    visitor_histories[visitor_id % MAX_VISITORS] = createStack(visitor_id);
+    attachVisitorHistoryStack(visitor_id, createStack(visitor_id));
     
     printSuccess("Visitor added successfully!");
     printf("Visitor ID: %d\n", visitor_id);
@@ -275,30 +291,17 @@ void addVisitorToPark() {
     if (ticket_type == TICKET_PREMIUM) {
         printf("Fast-Passes: %d\n", visitor->fast_passes_remaining);
     }
-    printf("Assigned to Group: %d\n", visitor_groups[group_count]->group_id);
-    
-    if (visitor_groups[group_count]->size >= 5) {
-        group_count++;
-        if (group_count < 100 && visitor_groups[group_count] == NULL) {
-            visitor_groups[group_count] = createVisitorGroup(generateGroupID());
-        }
-    }
+    printf("Assigned to Group: %d\n", group->group_id);
 }
 
 /* Suggest ride for visitor */
 void suggestRideForVisitor() {
     displayHeader("RIDE SUGGESTIONS");
     
-    int visitor_id = getIntInput("Enter visitor ID", 1000, 9999);
+    int visitor_id = getIntInput("Enter visitor ID", FIRST_VISITOR_ID, 9999);
     
     // Find visitor
-    Visitor* visitor = NULL;
-    for (int i = 0; i <= group_count; i++) {
-        if (visitor_groups[i]) {
-            visitor = findVisitorInGroup(visitor_groups[i], visitor_id);
-            if (visitor) break;
-        }
-    }
+    Visitor* visitor = findVisitorById(visitor_id);
     
     if (!visitor) {
         printError("Visitor not found!");
@@ -354,6 +357,7 @@ void showQueueStatus() {
         
         printf("│ Regular Queue:   %2d visitors            │\n", dq->regular_queue->size);
         printf("│ Fast-Pass Queue: %2d visitors            │\n", dq->fastpass_queue->size);
+        printf("│ Single Riders:   %2d visitors            │\n", dq->single_rider_queue->size);
         printf("│ \033[1;36mWaiting Queue:   %2d visitors\033[0m            │\n", ride->current_occupancy);
         printf("│ Total Queue:     %2d visitors            │\n", total_size);
         printf("│ Wait Time:       %2d minutes             │\n", ride->current_wait_time);
@@ -371,9 +375,9 @@ void showQueueStatus() {
 void displayVisitorHistory() {
     displayHeader("VISITOR RIDE HISTORY");
     
-    int visitor_id = getIntInput("Enter visitor ID", 1000, 9999);
+    int visitor_id = getIntInput("Enter visitor ID", FIRST_VISITOR_ID, 9999);
     
-    Stack* history = visitor_histories[visitor_id % MAX_VISITORS];
+    Stack* history = getVisitorHistoryStack(visitor_id);
     
     if (!history || isStackEmpty(history)) {
         printWarning("No ride history for this visitor");
@@ -409,7 +413,7 @@ void findShortestPath() {
     int start_id = getIntInput("Enter start ride ID", min_id, max_id);
     int end_id = getIntInput("Enter end ride ID", min_id, max_id);
     
-    PathInfo* path = dijkstraShortestPath(park_map, start_id, end_id);
+    PathInfo* path = findShortestRoute(park_map, start_id, end_id);
     
     if (path) {
         printf("\nShortest path found!\n");
@@ -449,11 +453,11 @@ void showRidesByWaitTime() {
     }
 }
 
-/* Simulate ride completion */
-void simulateRideCompletion() {
+/* Visitor enjoys a ride (timer-based, non-blocking) */
+void enjoyRide() {
     displayHeader("ENJOY RIDE WITH TIMER & QUEUE SYSTEM");
     
-    int visitor_id = getIntInput("Enter visitor ID", 1000, 9999);
+    int visitor_id = getIntInput("Enter visitor ID", FIRST_VISITOR_ID, 9999);
     
     displayAllRides(park_rides);
     int ride_id = getIntInput("Enter ride ID", 0, MAX_RIDES - 1);
@@ -471,13 +475,7 @@ void simulateRideCompletion() {
     }
     
     // Find visitor
-    Visitor* visitor = NULL;
-    for (int i = 0; i <= group_count; i++) {
-        if (visitor_groups[i]) {
-            visitor = findVisitorInGroup(visitor_groups[i], visitor_id);
-            if (visitor) break;
-        }
-    }
+    Visitor* visitor = findVisitorById(visitor_id);
     
     if (!visitor) {
         printError("Visitor not found!");
@@ -503,10 +501,8 @@ void simulateRideCompletion() {
         printf("Previous ride has completed automatically\n");
     }
     
-    // Start the ride (non-blocking)
-    ride->ride_in_progress = 1;
-    ride->occupied_until_time = current_time + ride->ride_duration;
-    ride->time_remaining = ride->ride_duration;
+    // Start the ride (non-blocking); the simulator frees it when the cycle ends
+    startRideCycle(ride, current_time);
     
     printSuccess("Ride started!");
     printf("\n%s is now enjoying %s!\n", visitor->name, ride->name);
@@ -515,7 +511,7 @@ void simulateRideCompletion() {
     printf("Other visitors can enjoy different rides!\n");
     
     // Add to history immediately
-    Stack* history = visitor_histories[visitor_id % MAX_VISITORS];
+    Stack* history = getVisitorHistoryStack(visitor_id);
     if (history) {
         push(history, ride, (int)current_time);
     }
@@ -536,21 +532,10 @@ void simulateRideCompletion() {
 void handleUndoRide() {
     displayHeader("UNDO LAST RIDE CHOICE");
     
-    int visitor_id = getIntInput("Enter visitor ID", 1000, 9999);
+    int visitor_id = getIntInput("Enter visitor ID", FIRST_VISITOR_ID, 9999);
     
     // Find visitor
-    Visitor* found_visitor = NULL;
-    for (int i = 0; i < group_count; i++) {
-        VisitorNode* node = visitor_groups[i]->head;
-        while (node) {
-            if (node->visitor->id == visitor_id) {
-                found_visitor = node->visitor;
-                break;
-            }
-            node = node->next;
-        }
-        if (found_visitor) break;
-    }
+    Visitor* found_visitor = findVisitorById(visitor_id);
     
     if (!found_visitor) {
         printWarning("Visitor not found");
@@ -566,7 +551,7 @@ void handleUndoRide() {
 
 /* Display park statistics */
 void displayParkStatistics() {
-    generateParkReport(park_rides, visitor_groups, group_count);
+    generateParkReport(park_rides, getGroups(), getGroupCount());
 }
 
 /* Add new ride to park */
@@ -687,16 +672,17 @@ void editRideDetails() {
     
     switch (choice) {
         case 1:
-            ride->capacity = getIntInput("New capacity", 4, 20);
+            setRideCapacity(ride, getIntInput("New capacity", 4, 20));
             printSuccess("Capacity updated!");
             break;
         case 2:
             ride->thrill_level = getIntInput("New thrill level", 1, 10);
+            markDataChanged(DATA_RIDES);  // Not a stats field, but cached ride JSON shows it
             printSuccess("Thrill level updated!");
             break;
         case 3:
             wait_time_bst->root = deleteRide(wait_time_bst->root, ride->current_wait_time);
-            ride->current_wait_time = getIntInput("New wait time", 0, 120);
+            setRideWaitTime(ride, getIntInput("New wait time", 0, 120));
             wait_time_bst->root = insertRide(wait_time_bst->root, ride);
             printSuccess("Wait time updated!");
             break;
@@ -741,6 +727,7 @@ void toggleRideStatus() {
         printf("'%s' is now closed for maintenance\n", ride->name);
     } else {
         markRideOpen(ride);
+        wakeRide(ride);
         printSuccess("Ride marked as OPEN");
         printf("'%s' is now open for visitors\n", ride->name);
     }
@@ -750,43 +737,21 @@ void toggleRideStatus() {
 void removeVisitor() {
     displayHeader("REMOVE VISITOR FROM PARK");
     
-    int visitor_id = getIntInput("Enter visitor ID to remove", 1000, 9999);
-    
-    // Find and remove visitor from groups
-    for (int i = 0; i <= group_count; i++) {
-        if (visitor_groups[i]) {
-            VisitorNode* current = visitor_groups[i]->head;
-            VisitorNode* prev = NULL;
-            
-            while (current) {
-                if (current->visitor->id == visitor_id) {
-                    // Found the visitor, remove from group
-                    if (prev) {
-                        prev->next = current->next;
-                    } else {
-                        visitor_groups[i]->head = current->next;
-                    }
-                    
-                    visitor_groups[i]->size--;
-                    
-                    // Free visitor history
-                    if (visitor_histories[visitor_id % MAX_VISITORS]) {
-                        freeStack(visitor_histories[visitor_id % MAX_VISITORS]);
-                        visitor_histories[visitor_id % MAX_VISITORS] = NULL;
-                    }
-                    
-                    printf("Removed visitor: %s (ID: %d)\n", current->visitor->name, visitor_id);
-                    free(current->visitor);
-                    free(current);
-                    
-                    printSuccess("Visitor removed successfully!");
-                    return;
-                }
-                prev = current;
-                current = current->next;
-            }
-        }
+    int visitor_id = getIntInput("Enter visitor ID to remove", FIRST_VISITOR_ID, 9999);
+    
+    // Out of every queue and index, history archived, memory freed
+    if (exitVisitor(visitor_id, EXIT_OPERATOR)) {
+        printf("Removed visitor ID: %d\n", visitor_id);
+        printSuccess("Visitor removed successfully!");
+        return;
     }
     
     printError("Visitor not found!");
 }
+
+/* Drain turnstile entries queued by the gate reader thread */
+void processGateEvents() {
+    if (gateIngestPending() == 0) return;
+    
+    drainGateIngest(INGEST_BATCH_SIZE);
+}
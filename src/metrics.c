@@ -0,0 +1,192 @@
+/* Lock-Free Runtime Metrics Registry (Prometheus text exposition) */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/metrics.h"
+#include "../include/utils.h"
+
+/* Exported histogram edges: powers of two from 2^10 ns (~1us) to 2^36 ns (~69s) */
+#define EXPORT_FIRST_SHIFT 10
+#define EXPORT_LAST_SHIFT 36
+
+static MetricHistogram dijkstra_histogram;
+static MetricHistogram tick_histogram;
+static MetricHistogram balance_histogram;
+
+static Metric metrics[MAX_METRICS] = {
+    {"park_dijkstra_calls_total", "Shortest path searches run", "", METRIC_COUNTER, 0, NULL},
+    {"park_dijkstra_duration_seconds", "Time spent in one shortest path search", "",
+     METRIC_HISTOGRAM, 0, &dijkstra_histogram},
+    {"park_simulator_tick_duration_seconds", "Time spent in one ride simulator tick", "",
+     METRIC_HISTOGRAM, 0, &tick_histogram},
+    {"park_crowd_balance_duration_seconds", "Time spent in one crowd balancing run", "",
+     METRIC_HISTOGRAM, 0, &balance_histogram},
+    {"park_timers_pending", "Ride and visitor timers armed on the timing wheel", "", METRIC_GAUGE, 0, NULL},
+    {"park_timers_fired_total", "Timing wheel timers that expired", "", METRIC_COUNTER, 0, NULL},
+    {"park_ride_seats_total", "Seats dispatched on ride cycles", "state=\"filled\"", METRIC_COUNTER, 0, NULL},
+    {"park_ride_seats_total", "Seats dispatched on ride cycles", "state=\"empty\"", METRIC_COUNTER, 0, NULL},
+    {"park_single_riders_total", "Single riders boarded into seats parties left empty", "", METRIC_COUNTER, 0, NULL},
+    {"park_visitor_exits_total", "Visitors who left the park", "reason=\"turnstile\"", METRIC_COUNTER, 0, NULL},
+    {"park_visitor_exits_total", "Visitors who left the park", "reason=\"stay_limit\"", METRIC_COUNTER, 0, NULL},
+    {"park_visitor_exits_total", "Visitors who left the park", "reason=\"inactive\"", METRIC_COUNTER, 0, NULL},
+    {"park_visitor_exits_total", "Visitors who left the park", "reason=\"operator\"", METRIC_COUNTER, 0, NULL},
+    {"park_allocations_total", "Heap allocations on hot paths", "type=\"visitor\"", METRIC_COUNTER, 0, NULL},
+    {"park_allocations_total", "Heap allocations on hot paths", "type=\"visitor_node\"", METRIC_COUNTER, 0, NULL},
+    {"park_allocations_total", "Heap allocations on hot paths", "type=\"queue_node\"", METRIC_COUNTER, 0, NULL},
+    {"park_allocations_total", "Heap allocations on hot paths", "type=\"ride\"", METRIC_COUNTER, 0, NULL}
+};
+static int metric_count = METRIC_BUILTIN_COUNT;
+
+/* Histogram bucket for a value - one leading-zero count and a shift */
+static int histogramBucket(long long nanos) {
+    if (nanos < 2 * METRIC_SUB_BUCKETS) return nanos < 0 ? 0 : (int)nanos;
+
+    int msb = 63 - __builtin_clzll((unsigned long long)nanos);
+    int shift = msb - 4;  // log2(METRIC_SUB_BUCKETS)
+    int bucket = METRIC_SUB_BUCKETS * shift + (int)(nanos >> shift);
+    return bucket < METRIC_HISTOGRAM_BUCKETS ? bucket : METRIC_HISTOGRAM_BUCKETS - 1;
+}
+
+/* Register a metric at startup. Not thread-safe against other registrations;
+ * returns the id to record against, or -1 when the registry is full. */
+int registerMetric(MetricType type, const char* name, const char* help, const char* labels) {
+    int id = __atomic_load_n(&metric_count, __ATOMIC_ACQUIRE);
+    if (id >= MAX_METRICS) {
+        fprintf(stderr, "Error: Metrics registry full, dropping %s\n", name);
+        return -1;
+    }
+
+    Metric* metric = &metrics[id];
+    metric->name = name;
+    metric->help = help;
+    strncpy(metric->labels, labels ? labels : "", sizeof(metric->labels) - 1);
+    metric->labels[sizeof(metric->labels) - 1] = '\0';
+    metric->type = type;
+    metric->value = 0;
+    metric->histogram = NULL;
+
+    if (type == METRIC_HISTOGRAM) {
+        metric->histogram = (MetricHistogram*)calloc(1, sizeof(MetricHistogram));
+        if (!metric->histogram) {
+            fprintf(stderr, "Error: Memory allocation failed for histogram %s\n", name);
+            return -1;
+        }
+    }
+
+    // Publish only after the slot is fully written
+    __atomic_store_n(&metric_count, id + 1, __ATOMIC_RELEASE);
+    return id;
+}
+
+/* Zero every value, keeping registrations */
+void resetMetrics(void) {
+    int count = __atomic_load_n(&metric_count, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < count; i++) {
+        __atomic_store_n(&metrics[i].value, 0, __ATOMIC_RELAXED);
+        if (metrics[i].histogram) {
+            memset(metrics[i].histogram, 0, sizeof(MetricHistogram));
+        }
+    }
+}
+
+/* Add to a counter or gauge */
+void metricAdd(int id, long long delta) {
+    if (id < 0 || id >= MAX_METRICS) return;
+    __atomic_fetch_add(&metrics[id].value, delta, __ATOMIC_RELAXED);
+}
+
+/* Set a gauge */
+void metricSet(int id, long long value) {
+    if (id < 0 || id >= MAX_METRICS) return;
+    __atomic_store_n(&metrics[id].value, value, __ATOMIC_RELAXED);
+}
+
+/* Record one duration sample */
+void metricObserve(int id, long long nanos) {
+    if (id < 0 || id >= MAX_METRICS) return;
+    MetricHistogram* histogram = metrics[id].histogram;
+    if (!histogram) return;
+    if (nanos < 0) nanos = 0;
+
+    __atomic_fetch_add(&histogram->buckets[histogramBucket(nanos)], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&histogram->sum, (unsigned long long)nanos, __ATOMIC_RELAXED);
+}
+
+/* Record the time elapsed since a getMonotonicNanos() reading */
+void metricObserveSince(int id, long long start_nanos) {
+    metricObserve(id, getMonotonicNanos() - start_nanos);
+}
+
+/* Render one histogram series as cumulative power-of-two buckets */
+static int renderHistogram(StringBuffer* out, const Metric* metric) {
+    const MetricHistogram* histogram = metric->histogram;
+    const char* separator = metric->labels[0] ? "," : "";
+    unsigned long long cumulative = 0;
+    int bucket = 0;
+
+    for (int shift = EXPORT_FIRST_SHIFT; shift <= EXPORT_LAST_SHIFT; shift++) {
+        int edge = histogramBucket(1LL << shift);
+        while (bucket < edge) {
+            cumulative += __atomic_load_n(&histogram->buckets[bucket++], __ATOMIC_RELAXED);
+        }
+        if (!stringBufferAppend(out, "%s_bucket{%s%sle=\"%.9g\"} %llu\n", metric->name, metric->labels,
+                                separator, (double)(1LL << shift) / 1e9, cumulative)) {
+            return 0;
+        }
+    }
+
+    while (bucket < METRIC_HISTOGRAM_BUCKETS) {
+        cumulative += __atomic_load_n(&histogram->buckets[bucket++], __ATOMIC_RELAXED);
+    }
+
+    // Count is derived from the buckets so +Inf always matches the last edge
+    unsigned long long count = cumulative;
+    unsigned long long sum = __atomic_load_n(&histogram->sum, __ATOMIC_RELAXED);
+    const char* open = metric->labels[0] ? "{" : "";
+    const char* close = metric->labels[0] ? "}" : "";
+
+    return stringBufferAppend(out, "%s_bucket{%s%sle=\"+Inf\"} %llu\n", metric->name, metric->labels,
+                              separator, count) &&
+           stringBufferAppend(out, "%s_sum%s%s%s %.9f\n", metric->name, open, metric->labels, close,
+                              (double)sum / 1e9) &&
+           stringBufferAppend(out, "%s_count%s%s%s %llu\n", metric->name, open, metric->labels, close, count);
+}
+
+/* Render every registered metric in Prometheus text format, one HELP/TYPE
+ * header per family even when its series were registered apart */
+int renderMetrics(StringBuffer* out) {
+    static const char* type_names[] = {"counter", "gauge", "histogram"};
+    int count = __atomic_load_n(&metric_count, __ATOMIC_ACQUIRE);
+
+    for (int i = 0; i < count; i++) {
+        int seen = 0;
+        for (int j = 0; j < i && !seen; j++) {
+            seen = strcmp(metrics[j].name, metrics[i].name) == 0;
+        }
+        if (seen) continue;
+
+        if (!stringBufferAppend(out, "# HELP %s %s\n# TYPE %s %s\n", metrics[i].name, metrics[i].help,
+                                metrics[i].name, type_names[metrics[i].type])) {
+            return 0;
+        }
+
+        for (int k = i; k < count; k++) {
+            const Metric* metric = &metrics[k];
+            if (strcmp(metric->name, metrics[i].name) != 0) continue;
+
+            int ok;
+            if (metric->type == METRIC_HISTOGRAM) {
+                ok = renderHistogram(out, metric);
+            } else if (metric->labels[0]) {
+                ok = stringBufferAppend(out, "%s{%s} %lld\n", metric->name, metric->labels,
+                                        __atomic_load_n(&metric->value, __ATOMIC_RELAXED));
+            } else {
+                ok = stringBufferAppend(out, "%s %lld\n", metric->name,
+                                        __atomic_load_n(&metric->value, __ATOMIC_RELAXED));
+            }
+            if (!ok) return 0;
+        }
+    }
+
+    return 1;
+}
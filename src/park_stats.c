@@ -0,0 +1,144 @@
+/* Incrementally Maintained Park Statistics */
+#include <stdio.h>
+#include <math.h>
+#include "../include/park_stats.h"
+#include "../include/response_cache.h"
+
+static ParkStats park_stats = {0, 0, 0.0, 0, 0, 0, 0, 0, 0};
+
+/* Get current aggregates - O(1) */
+const ParkStats* getParkStats(void) {
+    return &park_stats;
+}
+
+/* Reset all aggregates */
+void resetParkStats(void) {
+    ParkStats empty = {0, 0, 0.0, 0, 0, 0, 0, 0, 0};
+    park_stats = empty;
+}
+
+/* Visitor entered the park (linked into a group) */
+void statsVisitorAdded(Visitor* visitor) {
+    if (!visitor) return;
+
+    park_stats.total_visitors++;
+    if (visitor->ticket_type == TICKET_PREMIUM) park_stats.premium_visitors++;
+    park_stats.satisfaction_sum += visitor->satisfaction_score;
+    park_stats.total_distance += visitor->total_distance_traveled;
+    markDataChanged(DATA_VISITORS);
+}
+
+/* Visitor left the park (unlinked from its group) */
+void statsVisitorRemoved(Visitor* visitor) {
+    if (!visitor) return;
+
+    park_stats.total_visitors--;
+    if (visitor->ticket_type == TICKET_PREMIUM) park_stats.premium_visitors--;
+    park_stats.satisfaction_sum -= visitor->satisfaction_score;
+    park_stats.total_distance -= visitor->total_distance_traveled;
+    markDataChanged(DATA_VISITORS);
+}
+
+/* Visitor's distance or satisfaction changed */
+void statsVisitorChanged(int distance_delta, float satisfaction_delta) {
+    park_stats.total_distance += distance_delta;
+    park_stats.satisfaction_sum += satisfaction_delta;
+    markDataChanged(DATA_VISITORS);
+}
+
+/* Visitor's inactivity timer fired (1) or they became active again (-1) */
+void statsVisitorIdleChanged(int delta) {
+    park_stats.idle_visitors += delta;
+    markDataChanged(DATA_VISITORS);
+}
+
+/* Ride added to the park's ride list */
+void statsRideAdded(Ride* ride) {
+    if (!ride) return;
+
+    park_stats.total_rides++;
+    if (ride->is_operational) park_stats.active_rides++;
+    park_stats.total_capacity += ride->capacity;
+    park_stats.total_wait_time += ride->current_wait_time;
+    markDataChanged(DATA_RIDES);
+}
+
+/* Ride removed from the park's ride list */
+void statsRideRemoved(Ride* ride) {
+    if (!ride) return;
+
+    park_stats.total_rides--;
+    if (ride->is_operational) park_stats.active_rides--;
+    park_stats.total_capacity -= ride->capacity;
+    park_stats.total_wait_time -= ride->current_wait_time;
+    markDataChanged(DATA_RIDES);
+}
+
+/* Ride opened or closed */
+void statsRideStatusChanged(int was_operational, int is_operational) {
+    park_stats.active_rides += (is_operational ? 1 : 0) - (was_operational ? 1 : 0);
+    markDataChanged(DATA_RIDES);
+}
+
+/* Ride wait time set (the simulator re-sets it every dispatch) */
+void statsRideWaitChanged(int old_wait, int new_wait) {
+    if (old_wait == new_wait) return;  // Keep cached ride bodies valid
+
+    park_stats.total_wait_time += new_wait - old_wait;
+    markDataChanged(DATA_RIDES);
+}
+
+/* Ride capacity changed */
+void statsRideCapacityChanged(int old_capacity, int new_capacity) {
+    park_stats.total_capacity += new_capacity - old_capacity;
+    markDataChanged(DATA_RIDES);
+}
+
+/* Recount everything and compare with the running aggregates.
+ * Returns 1 if they agree, otherwise logs the differences and returns 0. */
+int verifyParkStats(RideList* rides, VisitorGroup* groups[], int group_count) {
+    ParkStats actual = {0, 0, 0.0, 0, 0, 0, 0, 0, 0};
+
+    for (int i = 0; i < group_count; i++) {
+        if (!groups[i]) continue;
+        for (VisitorNode* node = groups[i]->head; node; node = node->next) {
+            actual.total_visitors++;
+            if (node->visitor->ticket_type == TICKET_PREMIUM) actual.premium_visitors++;
+            actual.satisfaction_sum += node->visitor->satisfaction_score;
+            actual.total_distance += node->visitor->total_distance_traveled;
+            actual.idle_visitors += node->visitor->is_idle;
+        }
+    }
+
+    for (RideNode* node = rides ? rides->head : NULL; node; node = node->next) {
+        actual.total_rides++;
+        if (node->ride->is_operational) actual.active_rides++;
+        actual.total_capacity += node->ride->capacity;
+        actual.total_wait_time += node->ride->current_wait_time;
+    }
+
+    int ok = actual.total_visitors == park_stats.total_visitors &&
+             actual.premium_visitors == park_stats.premium_visitors &&
+             fabs(actual.satisfaction_sum - park_stats.satisfaction_sum) < 0.01 * (actual.total_visitors + 1) &&
+             actual.total_distance == park_stats.total_distance &&
+             actual.total_rides == park_stats.total_rides &&
+             actual.active_rides == park_stats.active_rides &&
+             actual.total_capacity == park_stats.total_capacity &&
+             actual.total_wait_time == park_stats.total_wait_time &&
+             actual.idle_visitors == park_stats.idle_visitors;
+
+    if (!ok) {
+        fprintf(stderr, "[STATS] Mismatch: visitors %d/%d premium %d/%d distance %ld/%ld "
+                        "rides %d/%d active %d/%d capacity %ld/%ld wait %ld/%ld idle %d/%d\n",
+                park_stats.total_visitors, actual.total_visitors,
+                park_stats.premium_visitors, actual.premium_visitors,
+                park_stats.total_distance, actual.total_distance,
+                park_stats.total_rides, actual.total_rides,
+                park_stats.active_rides, actual.active_rides,
+                park_stats.total_capacity, actual.total_capacity,
+                park_stats.total_wait_time, actual.total_wait_time,
+                park_stats.idle_visitors, actual.idle_visitors);
+    }
+
+    return ok;
+}
@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <math.h>
 #include "../include/priority_queue.h"
+#include "../include/trace.h"
 
 /* Create priority queue */
 PriorityQueue* createPriorityQueue() {
@@ -131,6 +132,7 @@ float calculatePriority(Visitor* visitor, Ride* ride, int distance) {
 
 /* Build priority queue for visitor */
 PriorityQueue* buildPriorityQueue(Visitor* visitor, RideList* rides, int current_location) {
+    TRACE_SPAN("buildPriorityQueue");
     if (!visitor || !rides) return NULL;
     
     PriorityQueue* pq = createPriorityQueue();
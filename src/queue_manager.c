@@ -1,6 +1,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "../include/queue_manager.h"
+#include "../include/wait_estimator.h"
+#include "../include/metrics.h"
+#include "../include/response_cache.h"
 
 /* Create a new queue */
 Queue* createQueue(int ride_id) {
@@ -14,6 +17,7 @@ Queue* createQueue(int ride_id) {
     q->rear = NULL;
     q->size = 0;
     q->ride_id = ride_id;
+    q->next_ticket = 0;
     
     return q;
 }
@@ -42,10 +46,15 @@ void enqueue(Queue* q, Visitor* visitor) {
         fprintf(stderr, "Error: Memory allocation failed for queue node\n");
         return;
     }
+    metricAdd(METRIC_ALLOC_QUEUE_NODE, 1);
     
     node->visitor = visitor;
+    node->party_left = 1;
     node->next = NULL;
     
+    visitor->queued_ride_id = q->ride_id;
+    visitor->queue_ticket = q->next_ticket++;
+    
     if (q->rear) {
         q->rear->next = node;
     } else {
@@ -54,6 +63,25 @@ void enqueue(Queue* q, Visitor* visitor) {
     
     q->rear = node;
     q->size++;
+    markDataChanged(DATA_QUEUES);
+}
+
+/* Enqueue a party back to back so it boards together. Returns 0 without
+ * enqueueing anyone if the queue has no room for the whole party. */
+int enqueueParty(Queue* q, Visitor* party[], int count) {
+    if (!q || !party || count <= 0 || q->size + count > MAX_QUEUE_SIZE) return 0;
+    
+    for (int i = 0; i < count; i++) {
+        int before = q->size;
+        enqueue(q, party[i]);
+        if (q->size == before) {
+            // Out of memory: take back the members already queued, last first
+            while (i-- > 0) removeFromQueue(q, party[i]);
+            return 0;
+        }
+        q->rear->party_left = count - i;
+    }
+    return 1;
 }
 
 /* Dequeue a visitor */
@@ -72,10 +100,51 @@ Visitor* dequeue(Queue* q) {
     
     free(node);
     q->size--;
+    markDataChanged(DATA_QUEUES);
     
+    visitor->queued_ride_id = -1;
     return visitor;
 }
 
+/* Take a visitor out from anywhere in the queue (they left the line) - O(n).
+ * Those behind move up one ticket so ticket positions stay exact, and a
+ * party the visitor belonged to boards one smaller. */
+int removeFromQueue(Queue* q, Visitor* visitor) {
+    if (isEmpty(q) || !visitor || visitor->queued_ride_id != q->ride_id) return 0;
+    
+    QueueNode* prev = NULL;
+    QueueNode* party_start = q->front;
+    QueueNode* node = q->front;
+    while (node && node->visitor != visitor) {
+        if (node->party_left == 1) party_start = node->next;
+        prev = node;
+        node = node->next;
+    }
+    if (!node) return 0;
+    
+    for (QueueNode* member = party_start; member != node; member = member->next) {
+        member->party_left--;
+    }
+    for (QueueNode* behind = node->next; behind; behind = behind->next) {
+        behind->visitor->queue_ticket--;
+    }
+    
+    if (prev) {
+        prev->next = node->next;
+    } else {
+        q->front = node->next;
+    }
+    if (q->rear == node) q->rear = prev;
+    
+    free(node);
+    q->size--;
+    q->next_ticket--;
+    markDataChanged(DATA_QUEUES);
+    
+    visitor->queued_ride_id = -1;
+    return 1;
+}
+
 /* Peek at front visitor */
 Visitor* queue_peek(Queue* q) {
     if (isEmpty(q)) {
@@ -85,6 +154,11 @@ Visitor* queue_peek(Queue* q) {
     return q->front->visitor;
 }
 
+/* Visitors in the party at the front (0 if empty) - O(1) */
+int getFrontPartySize(Queue* q) {
+    return isEmpty(q) ? 0 : q->front->party_left;
+}
+
 /* Get queue size */
 int getQueueSize(Queue* q) {
     return isEmpty(q) ? 0 : q->size;
@@ -143,14 +217,19 @@ int estimateWaitTime(Queue* q, int ride_capacity) {
         return 0;
     }
     
-    int cycles = (q->size + ride_capacity - 1) / ride_capacity;
-    return cycles * (BASE_RIDE_DURATION + BOARDING_TIME);
+    return predictDefaultWait(q->size, ride_capacity);
 }
 
 /* Merge two queues */
 void mergeQueues(Queue* q1, Queue* q2) {
     if (!q1 || !q2 || isEmpty(q2)) return;
     
+    // Re-ticket q2's visitors so they continue q1's sequence
+    for (QueueNode* node = q2->front; node; node = node->next) {
+        node->visitor->queued_ride_id = q1->ride_id;
+        node->visitor->queue_ticket = q1->next_ticket++;
+    }
+    
     if (isEmpty(q1)) {
         q1->front = q2->front;
         q1->rear = q2->rear;
@@ -165,6 +244,7 @@ void mergeQueues(Queue* q1, Queue* q2) {
     q2->front = NULL;
     q2->rear = NULL;
     q2->size = 0;
+    markDataChanged(DATA_QUEUES);
 }
 
 /* Count visitors in queue */
@@ -210,3 +290,21 @@ int getPositionInQueue(Queue* q, int visitor_id) {
     
     return -1;  // Not found
 }
+
+/* Get position in queue from the visitor's ticket - O(1).
+ * Tickets are handed out in order and only the front leaves, so the
+ * front always holds ticket (next_ticket - size). */
+int getTicketPosition(Queue* q, Visitor* visitor) {
+    if (isEmpty(q) || !visitor || visitor->queued_ride_id != q->ride_id) {
+        return -1;
+    }
+    
+    long front_ticket = q->next_ticket - q->size;
+    long position = visitor->queue_ticket - front_ticket + 1;
+    
+    if (position < 1 || position > q->size) {
+        return -1;  // Ticket belongs to the other lane of this ride
+    }
+    
+    return (int)position;
+}
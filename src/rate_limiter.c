@@ -0,0 +1,84 @@
+/* Per-Client Token-Bucket Rate Limiter */
+#include <string.h>
+#include "../include/rate_limiter.h"
+
+/* Reset the table and set the refill rate */
+void initRateLimiter(RateLimiter* limiter, double per_second, double burst) {
+    memset(limiter->buckets, 0, sizeof(limiter->buckets));
+    limiter->per_second = per_second;
+    limiter->burst = burst < 1.0 ? 1.0 : burst;
+    limiter->idle_ns = per_second > 0 ? (long long)(limiter->burst / per_second * 1e9) : 0;
+    limiter->rejected = 0;
+    limiter->evictions = 0;
+}
+
+/* FNV-1a over the raw address bytes (0 is reserved for empty slots) */
+static unsigned long long hashAddress(const void* address, size_t length) {
+    const unsigned char* bytes = (const unsigned char*)address;
+    unsigned long long hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash ? hash : 1;
+}
+
+/* Take one token for this client - 1 if allowed, 0 if over its rate */
+int rateLimitAllow(RateLimiter* limiter, const void* address, size_t length, long long now_ns) {
+    if (limiter->per_second <= 0) return 1;
+
+    unsigned long long key = hashAddress(address, length);
+    unsigned int home = (unsigned int)(key >> 32) & (RATE_LIMIT_TABLE_SIZE - 1);
+    RateBucket* bucket = NULL;
+    RateBucket* free_slot = NULL;
+    RateBucket* stalest = NULL;
+
+    for (int probe = 0; probe < RATE_LIMIT_PROBES; probe++) {
+        RateBucket* slot = &limiter->buckets[(home + probe) & (RATE_LIMIT_TABLE_SIZE - 1)];
+        if (slot->key == key) {
+            bucket = slot;
+            break;
+        }
+        if (!free_slot && (slot->key == 0 || now_ns - slot->last_ns >= limiter->idle_ns)) {
+            free_slot = slot;
+        }
+        if (!stalest || slot->last_ns < stalest->last_ns) {
+            stalest = slot;
+        }
+    }
+
+    if (!bucket) {
+        if (!free_slot) {
+            free_slot = stalest;
+            limiter->evictions++;
+        }
+        bucket = free_slot;
+        bucket->key = key;
+        bucket->tokens = limiter->burst;
+        bucket->last_ns = now_ns;
+    }
+
+    // Refill for the time since the last request, capped at the burst size
+    if (now_ns > bucket->last_ns) {
+        bucket->tokens += (now_ns - bucket->last_ns) * limiter->per_second / 1e9;
+        if (bucket->tokens > limiter->burst) bucket->tokens = limiter->burst;
+        bucket->last_ns = now_ns;
+    }
+
+    if (bucket->tokens >= 1.0) {
+        bucket->tokens -= 1.0;
+        return 1;
+    }
+    limiter->rejected++;
+    return 0;
+}
+
+/* Clients whose buckets are still refilling - O(table size), for reporting */
+int rateLimitActiveClients(const RateLimiter* limiter, long long now_ns) {
+    int active = 0;
+    for (int i = 0; i < RATE_LIMIT_TABLE_SIZE; i++) {
+        const RateBucket* slot = &limiter->buckets[i];
+        if (slot->key != 0 && now_ns - slot->last_ns < limiter->idle_ns) active++;
+    }
+    return active;
+}
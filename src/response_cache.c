@@ -0,0 +1,91 @@
+/* Versioned Cache of Serialized API Responses */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/response_cache.h"
+
+static unsigned long data_versions[DATA_DOMAIN_COUNT];
+static CachedResponse cache[CACHE_ENDPOINT_COUNT];
+static long cache_hits = 0;
+static long cache_misses = 0;
+
+/* Invalidate every cached body built from this domain - O(1) */
+void markDataChanged(DataDomain domain) {
+    data_versions[domain]++;
+}
+
+unsigned long getDataVersion(DataDomain domain) {
+    return data_versions[domain];
+}
+
+/* Cached body if none of its domains changed since it was built, else NULL */
+const char* getCachedResponse(CachedEndpoint endpoint, size_t* length) {
+    CachedResponse* entry = &cache[endpoint];
+    int fresh = entry->valid;
+
+    for (int d = 0; fresh && d < DATA_DOMAIN_COUNT; d++) {
+        if ((entry->domains & DATA_MASK(d)) && entry->versions[d] != data_versions[d]) {
+            fresh = 0;
+        }
+    }
+
+    if (!fresh) {
+        cache_misses++;
+        return NULL;
+    }
+
+    cache_hits++;
+    if (length) *length = entry->length;
+    return entry->body;
+}
+
+/* Remember a freshly built body against the current domain versions */
+void storeCachedResponse(CachedEndpoint endpoint, unsigned int domains, const char* body) {
+    CachedResponse* entry = &cache[endpoint];
+    size_t length = strlen(body);
+
+    if (length + 1 > entry->capacity) {
+        char* grown = (char*)realloc(entry->body, length + 1);
+        if (!grown) {
+            fprintf(stderr, "Error: Memory allocation failed for cached response\n");
+            entry->valid = 0;
+            return;
+        }
+        entry->body = grown;
+        entry->capacity = length + 1;
+    }
+
+    memcpy(entry->body, body, length + 1);
+    entry->length = length;
+    entry->domains = domains;
+    for (int d = 0; d < DATA_DOMAIN_COUNT; d++) {
+        entry->versions[d] = data_versions[d];
+    }
+    entry->valid = 1;
+}
+
+/* Drop every cached body and reset the counters */
+void clearResponseCache(void) {
+    for (int i = 0; i < CACHE_ENDPOINT_COUNT; i++) {
+        free(cache[i].body);
+        cache[i].body = NULL;
+        cache[i].length = 0;
+        cache[i].capacity = 0;
+        cache[i].valid = 0;
+    }
+    cache_hits = 0;
+    cache_misses = 0;
+}
+
+long getCacheHits(void) {
+    return cache_hits;
+}
+
+long getCacheMisses(void) {
+    return cache_misses;
+}
+
+float getCacheHitRatio(void) {
+    long lookups = cache_hits + cache_misses;
+    return lookups > 0 ? (float)cache_hits / (float)lookups : 0.0f;
+}
@@ -1,8 +1,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include "../include/ride_manager.h"
 #include "../include/file_io.h"
+#include "../include/park_stats.h"
+#include "../include/metrics.h"
 
 /* Create a new ride */
 Ride* createRide(int id, const char* name, int capacity, int thrill_level, int base_wait_time) {
@@ -11,6 +14,7 @@ Ride* createRide(int id, const char* name, int capacity, int thrill_level, int b
         fprintf(stderr, "Error: Memory allocation failed for ride\n");
         return NULL;
     }
+    metricAdd(METRIC_ALLOC_RIDE, 1);
     
     ride->id = id;
     strncpy(ride->name, name, MAX_NAME_LENGTH - 1);
@@ -19,6 +23,9 @@ Ride* createRide(int id, const char* name, int capacity, int thrill_level, int b
     ride->thrill_level = thrill_level;
     ride->current_wait_time = base_wait_time;
     ride->distance_from_entrance = 0;
+    ride->x = 0;
+    ride->y = 0;
+    ride->has_location = 0;
     ride->total_visitors_served = 0;
     ride->is_operational = 1;
     
@@ -27,8 +34,11 @@ Ride* createRide(int id, const char* name, int capacity, int thrill_level, int b
     ride->ride_in_progress = 0;
     ride->time_remaining = 0;
     ride->occupied_until_time = 0;
+    initTimer(&ride->cycle_timer, NULL, ride);
     // Set ride duration based on thrill level (higher thrill = longer ride)
     ride->ride_duration = 30 + (thrill_level * 10); // 40-130 seconds
+    ride->wait_history = NULL;  // Allocated on first wait sample
+    initThroughputEstimate(&ride->throughput, capacity, DEFAULT_CYCLE_SECONDS);
     
     return ride;
 }
@@ -36,6 +46,8 @@ Ride* createRide(int id, const char* name, int capacity, int thrill_level, int b
 /* Free ride memory */
 void freeRide(Ride* ride) {
     if (ride) {
+        cancelTimer(&ride->cycle_timer);
+        freeWaitHistory(ride->wait_history);
         free(ride);
     }
 }
@@ -95,6 +107,7 @@ void addRideToList(RideList* list, Ride* ride) {
     node->next = list->head;
     list->head = node;
     list->count++;
+    statsRideAdded(ride);
 }
 
 /* Find ride by ID */
@@ -127,6 +140,7 @@ void removeRideFromList(RideList* list, int ride_id) {
                 list->head = current->next;
             }
             
+            statsRideRemoved(current->ride);
             freeRide(current->ride);
             free(current);
             list->count--;
@@ -167,6 +181,7 @@ void freeRideList(RideList* list) {
     RideNode* current = list->head;
     while (current) {
         RideNode* next = current->next;
+        statsRideRemoved(current->ride);
         freeRide(current->ride);
         free(current);
         current = next;
@@ -179,18 +194,48 @@ void freeRideList(RideList* list) {
 void updateRideWaitTime(Ride* ride, int queue_size) {
     if (!ride) return;
     
-    if (queue_size == 0) {
-        ride->current_wait_time = 0;
-        return;
+    setRideWaitTime(ride, estimateRideWait(ride, queue_size));
+}
+
+/* Record a boarding batch leaving the station */
+void recordRideDispatch(Ride* ride, int riders, int still_waiting) {
+    if (!ride) return;
+    
+    recordDispatch(&ride->throughput, riders, still_waiting, time(NULL));
+}
+
+/* Predicted wait (minutes) for the visitor at a given queue position */
+int estimateRideWait(Ride* ride, int position) {
+    if (!ride) return 0;
+    
+    return predictWaitForPosition(&ride->throughput, position);
+}
+
+/* Set current wait time and record it in the ride's history */
+void setRideWaitTime(Ride* ride, int wait_minutes) {
+    if (!ride) return;
+    
+    statsRideWaitChanged(ride->current_wait_time, wait_minutes);
+    ride->current_wait_time = wait_minutes;
+    
+    if (!ride->wait_history) {
+        ride->wait_history = createWaitHistory();
     }
-    // Calculate wait time: (queue_size / capacity) * ride_duration + boarding_time
-    int cycles = (queue_size + ride->capacity - 1) / ride->capacity;
-    ride->current_wait_time = cycles * (BASE_RIDE_DURATION + BOARDING_TIME);
+    recordWaitSample(ride->wait_history, time(NULL), wait_minutes);
+}
+
+/* Change seats per cycle */
+void setRideCapacity(Ride* ride, int capacity) {
+    if (!ride) return;
+    
+    statsRideCapacityChanged(ride->capacity, capacity);
+    ride->capacity = capacity;
 }
 
 /* Mark ride as closed */
 void markRideClosed(Ride* ride) {
     if (ride) {
+        statsRideStatusChanged(ride->is_operational, 0);
         ride->is_operational = 0;
     }
 }
@@ -198,6 +243,7 @@ void markRideClosed(Ride* ride) {
 /* Mark ride as open */
 void markRideOpen(Ride* ride) {
     if (ride) {
+        statsRideStatusChanged(ride->is_operational, 1);
         ride->is_operational = 1;
     }
 }
@@ -1,10 +1,13 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include "../include/ride_simulator.h"
 #include "../include/utils.h"
 #include "../include/visitor.h"
 #include "../include/ride_manager.h"
+#include "../include/metrics.h"
+#include "../include/trace.h"
 
 /* Default ride durations */
 static const RideDuration default_durations[] = {
@@ -20,11 +23,12 @@ static const RideDuration default_durations[] = {
     {0, "Virtual Reality", 8, 10}
 };
 
-static time_t last_update = 0;
-static const int UPDATE_INTERVAL = 30; // Update every 30 seconds
+static DualQueue** sim_queues = NULL;  // Queues the cycle callbacks board from
+static Visitor** boarding = NULL;      // One cycle's riders, sized for the largest ride
+static int boarding_seats = 0;
 
 void initializeRideSimulator(void) {
-    last_update = time(NULL);
+    advanceTimingWheel(time(NULL));
 }
 
 int calculateRideDuration(const char* ride_name) {
@@ -39,48 +43,81 @@ int calculateRideDuration(const char* ride_name) {
 void simulateRideCompletion(Ride* ride, DualQueue* queue) {
     if (!ride || !queue) return;
     
-    int total_served = 0;
-    
-    // Process FastPass queue with priority (4:1 ratio)
-    for (int i = 0; i < ride->capacity && total_served < ride->capacity; i++) {
-        if (i % 5 == 0 && !isEmpty(queue->fastpass_queue)) {
-            // Serve FastPass queue
-            Visitor* v = dequeue(queue->fastpass_queue);
-            if (v) {
-                updateVisitorStats(v, ride->id, calculateSatisfactionScore(v, ride));
-                total_served++;
-            }
-        } else if (!isEmpty(queue->regular_queue)) {
-            // Serve regular queue
-            Visitor* v = dequeue(queue->regular_queue);
-            if (v) {
-                updateVisitorStats(v, ride->id, calculateSatisfactionScore(v, ride));
-                total_served++;
-            }
+    if (ride->capacity > boarding_seats) {
+        Visitor** grown = (Visitor**)realloc(boarding, sizeof(Visitor*) * ride->capacity);
+        if (!grown) {
+            fprintf(stderr, "Error: Memory allocation failed for boarding batch\n");
+            return;
         }
+        boarding = grown;
+        boarding_seats = ride->capacity;
+    }
+    
+    // Parties board in the merge order, then single riders pack the gaps
+    int singles_waiting = getQueueSize(queue->single_rider_queue);
+    int total_served = boardDualQueue(queue, boarding, ride->capacity);
+    for (int i = 0; i < total_served; i++) {
+        updateVisitorStats(boarding[i], ride->id, calculateSatisfactionScore(boarding[i], ride));
     }
     
-    // Update wait times
-    int cycles_needed = (queue->regular_queue->size + queue->fastpass_queue->size) / ride->capacity;
-    if ((queue->regular_queue->size + queue->fastpass_queue->size) % ride->capacity > 0) cycles_needed++;
+    metricAdd(METRIC_SEATS_FILLED, total_served);
+    metricAdd(METRIC_SEATS_EMPTY, ride->capacity - total_served);
+    metricAdd(METRIC_SINGLE_RIDERS, singles_waiting - getQueueSize(queue->single_rider_queue));
     
-    ride->current_wait_time = cycles_needed * calculateRideDuration(ride->name);
+    // Feed the observed batch to the estimator, then refresh the wait time
+    int still_waiting = getTotalQueueSize(queue);
+    recordRideDispatch(ride, total_served, still_waiting);
+    updateRideWaitTime(ride, still_waiting);
 }
 
-void updateRideStatus(RideList* rides, DualQueue** queues) {
-    time_t current_time = time(NULL);
-    if (current_time - last_update < UPDATE_INTERVAL) return;
+static DualQueue* rideQueue(Ride* ride) {
+    if (!sim_queues || ride->id < 0 || ride->id >= MAX_RIDES) return NULL;
+    return sim_queues[ride->id];
+}
+
+/* Cycle timer fired: unload, then board the next batch if anyone is waiting */
+static void completeRideCycle(Timer* timer) {
+    Ride* ride = (Ride*)timer->owner;
+    ride->ride_in_progress = 0;
+    ride->time_remaining = 0;
     
-    RideNode* node = rides->head;
-    while (node) {
-        if (node->ride->is_operational) {
-            DualQueue* queue = queues[node->ride->id];
-            if (queue && (queue->regular_queue->size > 0 || queue->fastpass_queue->size > 0)) {
-                simulateRideCompletion(node->ride, queue);
-            }
-        }
-        node = node->next;
+    DualQueue* queue = rideQueue(ride);
+    if (ride->is_operational && queue && getTotalQueueSize(queue) > 0) {
+        simulateRideCompletion(ride, queue);
+        startRideCycle(ride, getTimingWheelTime());
     }
+}
+
+/* Mark the ride occupied for one ride_duration and arm its completion */
+void startRideCycle(Ride* ride, time_t now) {
+    if (!ride) return;
     
-    last_update = current_time;
-}
\ No newline at end of file
+    ride->ride_in_progress = 1;
+    ride->time_remaining = ride->ride_duration;
+    ride->occupied_until_time = now + ride->ride_duration;
+    ride->cycle_timer.callback = completeRideCycle;
+    scheduleTimer(&ride->cycle_timer, ride->occupied_until_time);
+}
+
+/* The ride may have work (visitors joined its queue, or it reopened).
+ * An idle ride boards on the next tick; a running one already will. */
+void wakeRide(Ride* ride) {
+    if (!ride || !ride->is_operational || isTimerArmed(&ride->cycle_timer)) return;
+    
+    ride->cycle_timer.callback = completeRideCycle;
+    scheduleTimer(&ride->cycle_timer, time(NULL));
+}
+
+/* Advance the park clock. Only rides whose cycle ends, and visitors whose
+ * timers expire, are touched; idle rides cost nothing. */
+void updateRideStatus(RideList* rides, DualQueue** queues) {
+    (void)rides;
+    sim_queues = queues;
+    time_t current_time = time(NULL);
+    if (current_time <= getTimingWheelTime()) return;  // Ticks are whole seconds
+    
+    TRACE_SPAN("updateRideStatus");
+    long long tick_started = getMonotonicNanos();
+    advanceTimingWheel(current_time);
+    metricObserveSince(METRIC_SIMULATOR_TICK_SECONDS, tick_started);
+}
@@ -0,0 +1,131 @@
+/* Static 2-D k-d Tree for Nearest-Neighbour Queries */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/spatial_index.h"
+
+static int axisValue(const SpatialPoint* point, int axis) {
+    return axis ? point->y : point->x;
+}
+
+static void swapPoints(SpatialPoint* a, SpatialPoint* b) {
+    SpatialPoint tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+/* Quickselect: put the nth smallest on this axis at points[nth],
+ * smaller-or-equal to its left, larger-or-equal to its right */
+static void selectNth(SpatialPoint* points, int lo, int hi, int nth, int axis) {
+    while (hi - lo > 1) {
+        int pivot = axisValue(&points[lo + (hi - lo) / 2], axis);
+        int i = lo, j = hi - 1;
+        while (i <= j) {
+            while (axisValue(&points[i], axis) < pivot) i++;
+            while (axisValue(&points[j], axis) > pivot) j--;
+            if (i <= j) swapPoints(&points[i++], &points[j--]);
+        }
+        if (nth <= j) hi = j + 1;
+        else if (nth >= i) lo = i;
+        else return;
+    }
+}
+
+/* Arrange points[lo, hi) into an implicit subtree */
+static void buildRange(SpatialPoint* points, int lo, int hi, int depth) {
+    if (hi - lo <= 1) return;
+    int mid = lo + (hi - lo) / 2;
+    selectNth(points, lo, hi, mid, depth & 1);
+    buildRange(points, lo, mid, depth + 1);
+    buildRange(points, mid + 1, hi, depth + 1);
+}
+
+/* Build an index over a copy of the points */
+SpatialIndex* buildSpatialIndex(const SpatialPoint* points, int count) {
+    SpatialIndex* index = (SpatialIndex*)malloc(sizeof(SpatialIndex));
+    if (!index) {
+        fprintf(stderr, "Error: Memory allocation failed for spatial index\n");
+        return NULL;
+    }
+
+    index->count = count > 0 ? count : 0;
+    index->points = NULL;
+    if (index->count > 0) {
+        index->points = (SpatialPoint*)malloc(sizeof(SpatialPoint) * index->count);
+        if (!index->points) {
+            fprintf(stderr, "Error: Memory allocation failed for spatial index\n");
+            free(index);
+            return NULL;
+        }
+        memcpy(index->points, points, sizeof(SpatialPoint) * index->count);
+        buildRange(index->points, 0, index->count, 0);
+    }
+
+    return index;
+}
+
+/* Running k best, kept sorted nearest first */
+typedef struct NearestSearch {
+    int x;
+    int y;
+    int k;
+    int found;
+    SpatialFilter accept;
+    void* context;
+    SpatialMatch* best;
+} NearestSearch;
+
+static void offerMatch(NearestSearch* search, int id, long long distance_sq) {
+    if (search->found == search->k && distance_sq >= search->best[search->k - 1].distance_sq) return;
+
+    int i = search->found < search->k ? search->found++ : search->k - 1;
+    while (i > 0 && search->best[i - 1].distance_sq > distance_sq) {
+        search->best[i] = search->best[i - 1];
+        i--;
+    }
+    search->best[i].id = id;
+    search->best[i].distance_sq = distance_sq;
+}
+
+static void searchRange(const SpatialPoint* points, int lo, int hi, int depth, NearestSearch* search) {
+    if (lo >= hi) return;
+
+    int mid = lo + (hi - lo) / 2;
+    const SpatialPoint* node = &points[mid];
+    long long dx = (long long)node->x - search->x;
+    long long dy = (long long)node->y - search->y;
+
+    if (!search->accept || search->accept(node->id, search->context)) {
+        offerMatch(search, node->id, dx * dx + dy * dy);
+    }
+
+    // Near side first; the far side only if the splitting line is closer than the k-th best
+    long long split = (depth & 1) ? dy : dx;
+    int near_lo = split > 0 ? lo : mid + 1;
+    int near_hi = split > 0 ? mid : hi;
+    int far_lo = split > 0 ? mid + 1 : lo;
+    int far_hi = split > 0 ? hi : mid;
+
+    searchRange(points, near_lo, near_hi, depth + 1, search);
+    if (search->found < search->k || split * split < search->best[search->k - 1].distance_sq) {
+        searchRange(points, far_lo, far_hi, depth + 1, search);
+    }
+}
+
+/* Up to k accepted points nearest to (x, y), nearest first; returns how many */
+int findNearestPoints(const SpatialIndex* index, int x, int y, int k,
+                      SpatialFilter accept, void* context, SpatialMatch* out) {
+    if (!index || !out || k <= 0) return 0;
+
+    NearestSearch search = {x, y, k, 0, accept, context, out};
+    searchRange(index->points, 0, index->count, 0, &search);
+    return search.found;
+}
+
+/* Free spatial index */
+void freeSpatialIndex(SpatialIndex* index) {
+    if (index) {
+        free(index->points);
+        free(index);
+    }
+}
@@ -0,0 +1,82 @@
+/* Rides Ranked by Walking Time plus Predicted Wait */
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include "../include/time_to_ride.h"
+#include "../include/congestion.h"
+#include "../include/response_cache.h"
+#include "../include/trace.h"
+
+static TimeToRideRanking rankings[CONGESTION_TRACKED_SOURCES];
+static unsigned long ranking_clock = 0;
+
+static int compareRideTimes(const void* a, const void* b) {
+    const RideTime* x = (const RideTime*)a;
+    const RideTime* y = (const RideTime*)b;
+    if (x->total_seconds != y->total_seconds) return x->total_seconds - y->total_seconds;
+    return x->ride_id - y->ride_id;
+}
+
+static int isRankingCurrent(const TimeToRideRanking* ranking, Graph* g) {
+    return ranking->valid && ranking->graph == g &&
+           ranking->topology == g->topology_version &&
+           ranking->congestion == getCongestionVersion() &&
+           ranking->rides_version == getDataVersion(DATA_RIDES);
+}
+
+/* Open rides reachable from origin, soonest ride first. NULL if origin is
+ * not on the map. The result stays valid until the next call. */
+const TimeToRideRanking* rankRidesByTimeToRide(Graph* g, RideList* rides, int origin) {
+    if (!rides || !hasGraphNode(g, origin)) return NULL;
+
+    TRACE_SPAN("rankRidesByTimeToRide");
+
+    // Reweighting for new crowds first, so the congestion version is current
+    ShortestPathTree* tree = getRouteTree(g, origin);
+    if (!tree) return NULL;
+
+    int victim = 0;
+    for (int slot = 0; slot < CONGESTION_TRACKED_SOURCES; slot++) {
+        TimeToRideRanking* ranking = &rankings[slot];
+        if (ranking->valid && ranking->origin == origin) {
+            if (isRankingCurrent(ranking, g)) {
+                ranking->used = ++ranking_clock;
+                return ranking;
+            }
+            victim = slot;
+            break;
+        }
+        if (!ranking->valid || (rankings[victim].valid && ranking->used < rankings[victim].used)) victim = slot;
+    }
+
+    TimeToRideRanking* ranking = &rankings[victim];
+    ranking->origin = origin;
+    ranking->count = 0;
+    for (RideNode* node = rides->head; node && ranking->count < MAX_RIDES; node = node->next) {
+        Ride* ride = node->ride;
+        if (!ride->is_operational || ride->id < 0 || ride->id >= tree->capacity) continue;
+        if (tree->dist[ride->id] == INT_MAX) continue;  // No walkway to it
+
+        RideTime* entry = &ranking->rides[ranking->count++];
+        entry->ride_id = ride->id;
+        entry->walk_seconds = (int)(tree->dist[ride->id] / WALKING_SPEED_MPS + 0.5f);
+        entry->wait_minutes = ride->current_wait_time;
+        entry->total_seconds = entry->walk_seconds + entry->wait_minutes * 60;
+    }
+    qsort(ranking->rides, ranking->count, sizeof(RideTime), compareRideTimes);
+
+    ranking->graph = g;
+    ranking->topology = g->topology_version;
+    ranking->congestion = getCongestionVersion();
+    ranking->rides_version = getDataVersion(DATA_RIDES);
+    ranking->used = ++ranking_clock;
+    ranking->valid = 1;
+    return ranking;
+}
+
+/* Forget every ranking (e.g. before the map is freed) */
+void clearTimeToRideCache(void) {
+    for (int slot = 0; slot < CONGESTION_TRACKED_SOURCES; slot++) {
+        rankings[slot].valid = 0;
+    }
+}
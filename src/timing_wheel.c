@@ -0,0 +1,164 @@
+/* Hierarchical Timing Wheel for Ride Cycles and Visitor Timers */
+#include <stdio.h>
+#include "../include/timing_wheel.h"
+#include "../include/metrics.h"
+
+#define SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+#define LEVEL_SHIFT(level) (TIMER_WHEEL_BITS * (level))
+#define WHEEL_SPAN ((time_t)1 << LEVEL_SHIFT(TIMER_WHEEL_LEVELS))  // Furthest a slot can reach
+
+static Timer slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];  // Circular list heads
+static int slots_ready = 0;
+static time_t wheel_time = 0;   // Last tick processed, 0 until first use
+static int pending = 0;         // Armed timers
+
+static void startWheel(time_t now) {
+    if (!slots_ready) {
+        for (int level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+            for (int slot = 0; slot < TIMER_WHEEL_SLOTS; slot++) {
+                slots[level][slot].next = slots[level][slot].prev = &slots[level][slot];
+            }
+        }
+        slots_ready = 1;
+    }
+    if (!wheel_time) wheel_time = now;
+}
+
+/* Link into the slot for its due time. Timers due before earliest go to
+ * earliest's slot; those beyond the top level park in its furthest slot
+ * and are placed again each time that slot cascades. */
+static void linkTimer(Timer* timer, time_t earliest) {
+    time_t due = timer->expires < earliest ? earliest : timer->expires;
+    if (due - wheel_time >= WHEEL_SPAN) due = wheel_time + WHEEL_SPAN - 1;
+
+    time_t delta = due - wheel_time;
+    int level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 && delta >= ((time_t)1 << LEVEL_SHIFT(level + 1))) level++;
+
+    Timer* head = &slots[level][(due >> LEVEL_SHIFT(level)) & SLOT_MASK];
+    timer->next = head;
+    timer->prev = head->prev;
+    head->prev->next = timer;
+    head->prev = timer;
+}
+
+static void unlinkTimer(Timer* timer) {
+    timer->prev->next = timer->next;
+    timer->next->prev = timer->prev;
+    timer->next = timer->prev = NULL;
+}
+
+/* Move one higher-level slot's timers down to the levels they now fit */
+static void cascade(int level, int slot) {
+    Timer* head = &slots[level][slot];
+    if (head->next == head) return;
+
+    // Detach the list first; a parked timer may be linked back into this level
+    Timer* first = head->next;
+    head->prev->next = NULL;
+    head->next = head->prev = head;
+
+    while (first) {
+        Timer* timer = first;
+        first = first->next;
+        linkTimer(timer, wheel_time);
+    }
+}
+
+/* Prepare an embedded timer (a zeroed Timer is also valid and unarmed) */
+void initTimer(Timer* timer, TimerCallback callback, void* owner) {
+    if (!timer) return;
+    timer->next = timer->prev = NULL;
+    timer->expires = 0;
+    timer->callback = callback;
+    timer->owner = owner;
+}
+
+/* Arm for a Unix timestamp, moving it if already armed - O(1).
+ * A time already past fires on the next tick. */
+void scheduleTimer(Timer* timer, time_t expires) {
+    if (!timer) return;
+
+    startWheel(time(NULL));
+    if (timer->next) {
+        unlinkTimer(timer);
+    } else {
+        pending++;
+        metricAdd(METRIC_TIMERS_PENDING, 1);
+    }
+    timer->expires = expires;
+    linkTimer(timer, wheel_time + 1);
+}
+
+/* Disarm without firing - O(1), harmless if not armed */
+void cancelTimer(Timer* timer) {
+    if (!timer || !timer->next) return;
+
+    unlinkTimer(timer);
+    pending--;
+    metricAdd(METRIC_TIMERS_PENDING, -1);
+}
+
+int isTimerArmed(const Timer* timer) {
+    return timer && timer->next != NULL;
+}
+
+/* Process every tick up to now, firing the timers due on each.
+ * Callbacks may schedule or cancel any timer. Returns how many fired. */
+int advanceTimingWheel(time_t now) {
+    startWheel(now);
+    if (pending == 0) {
+        if (now > wheel_time) wheel_time = now;  // Nothing to fire on the way
+        return 0;
+    }
+
+    int fired = 0;
+    while (wheel_time < now) {
+        wheel_time++;
+
+        // Each level whose lower levels just wrapped pulls its next slot down
+        for (int level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+            if (wheel_time & (((time_t)1 << LEVEL_SHIFT(level)) - 1)) break;
+            cascade(level, (int)((wheel_time >> LEVEL_SHIFT(level)) & SLOT_MASK));
+        }
+
+        Timer* head = &slots[0][wheel_time & SLOT_MASK];
+        while (head->next != head) {
+            Timer* timer = head->next;
+            unlinkTimer(timer);
+            pending--;
+            fired++;
+            if (timer->callback) timer->callback(timer);
+        }
+    }
+
+    if (fired) {
+        metricAdd(METRIC_TIMERS_PENDING, -fired);
+        metricAdd(METRIC_TIMERS_FIRED, fired);
+    }
+    return fired;
+}
+
+/* Last tick processed (0 before the wheel has started) */
+time_t getTimingWheelTime(void) {
+    return wheel_time;
+}
+
+int getPendingTimerCount(void) {
+    return pending;
+}
+
+/* Disarm everything and stop the clock */
+void resetTimingWheel(void) {
+    if (slots_ready) {
+        for (int level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+            for (int slot = 0; slot < TIMER_WHEEL_SLOTS; slot++) {
+                Timer* head = &slots[level][slot];
+                while (head->next != head) unlinkTimer(head->next);
+            }
+        }
+    }
+    metricAdd(METRIC_TIMERS_PENDING, -pending);
+    pending = 0;
+    wheel_time = 0;
+}
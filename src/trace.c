@@ -0,0 +1,167 @@
+/* Per-Thread Span Recorder with Chrome Trace-Event Export */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/trace.h"
+#include "../include/utils.h"
+
+int trace_enabled = 0;
+
+static TraceRing* rings[TRACE_MAX_THREADS];
+static int ring_count = 0;
+static long long trace_epoch = 0;       // Exported timestamps are relative to this
+static long long cleared_before = 0;    // Spans starting earlier are hidden
+
+static __thread TraceRing* thread_ring = NULL;
+static __thread int thread_ring_failed = 0;
+static __thread char thread_name[32] = "";
+
+/* Switch recording on or off */
+void setTraceEnabled(int enabled) {
+    if (enabled && trace_epoch == 0) {
+        trace_epoch = getMonotonicNanos();
+    }
+    __atomic_store_n(&trace_enabled, enabled ? 1 : 0, __ATOMIC_RELAXED);
+}
+
+int isTraceEnabled(void) {
+    return __atomic_load_n(&trace_enabled, __ATOMIC_RELAXED);
+}
+
+/* Label the calling thread in exported traces */
+void setTraceThreadName(const char* name) {
+    strncpy(thread_name, name, sizeof(thread_name) - 1);
+    thread_name[sizeof(thread_name) - 1] = '\0';
+    if (thread_ring) {
+        strcpy(thread_ring->thread_name, thread_name);
+    }
+}
+
+/* Hide everything recorded so far (rings are owned by their threads,
+ * so this moves a cutoff instead of touching them) */
+void clearTrace(void) {
+    __atomic_store_n(&cleared_before, getMonotonicNanos(), __ATOMIC_RELAXED);
+}
+
+long long traceTimestamp(void) {
+    return getMonotonicNanos();
+}
+
+/* Claim a ring for the calling thread on its first span */
+static TraceRing* getThreadRing(void) {
+    if (thread_ring || thread_ring_failed) return thread_ring;
+
+    int slot = __atomic_fetch_add(&ring_count, 1, __ATOMIC_ACQ_REL);
+    if (slot >= TRACE_MAX_THREADS) {
+        fprintf(stderr, "Error: Trace thread limit reached, spans from this thread are dropped\n");
+        thread_ring_failed = 1;
+        return NULL;
+    }
+
+    TraceRing* ring = (TraceRing*)calloc(1, sizeof(TraceRing));
+    if (!ring) {
+        fprintf(stderr, "Error: Memory allocation failed for trace ring\n");
+        thread_ring_failed = 1;
+        return NULL;
+    }
+
+    ring->thread_id = slot + 1;
+    if (thread_name[0]) {
+        strcpy(ring->thread_name, thread_name);
+    } else {
+        snprintf(ring->thread_name, sizeof(ring->thread_name), "thread %d", slot + 1);
+    }
+
+    __atomic_store_n(&rings[slot], ring, __ATOMIC_RELEASE);
+    thread_ring = ring;
+    return ring;
+}
+
+/* Close a span (cleanup handler for TRACE_SPAN) */
+void traceEnd(TraceScope* scope) {
+    if (!scope->name) return;
+
+    long long end = traceTimestamp();
+    TraceRing* ring = getThreadRing();
+    if (!ring) return;
+
+    // Single writer per ring: fill the slot, then publish it
+    unsigned long long head = ring->head;
+    TraceEvent* event = &ring->events[head % TRACE_RING_SIZE];
+    event->name = scope->name;
+    event->start_ns = scope->start_ns;
+    event->duration_ns = end - scope->start_ns;
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+/* Escape a span name for JSON (names are identifiers or route patterns) */
+static void escapeTraceName(const char* name, char* out, size_t size) {
+    size_t length = 0;
+    for (; *name && length + 2 < size; name++) {
+        if (*name == '"' || *name == '\\') out[length++] = '\\';
+        out[length++] = *name;
+    }
+    out[length] = '\0';
+}
+
+/* Copy a ring's live window and append its events.
+ * Slots the owner overwrote while we copied, or may be writing now, are
+ * discarded. */
+static int renderRing(StringBuffer* out, TraceRing* ring, TraceEvent* snapshot, int* first) {
+    unsigned long long end = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    unsigned long long begin = end > TRACE_RING_SIZE ? end - TRACE_RING_SIZE : 0;
+
+    for (unsigned long long i = begin; i < end; i++) {
+        snapshot[i - begin] = ring->events[i % TRACE_RING_SIZE];
+    }
+
+    unsigned long long after = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    // The unpublished event at index after shares a slot with after - TRACE_RING_SIZE
+    unsigned long long safe = after >= TRACE_RING_SIZE ? after - TRACE_RING_SIZE + 1 : 0;
+    long long cutoff = __atomic_load_n(&cleared_before, __ATOMIC_RELAXED);
+
+    if (!stringBufferAppend(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                                 "\"args\":{\"name\":\"%s\"}}",
+                            *first ? "" : ",\n", ring->thread_id, ring->thread_name)) {
+        return 0;
+    }
+    *first = 0;
+
+    char name[128];
+    for (unsigned long long i = (begin > safe ? begin : safe); i < end; i++) {
+        const TraceEvent* event = &snapshot[i - begin];
+        if (event->start_ns < cutoff) continue;
+
+        escapeTraceName(event->name, name, sizeof(name));
+        if (!stringBufferAppend(out, ",\n{\"name\":\"%s\",\"cat\":\"park\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+                                     "\"ts\":%.3f,\"dur\":%.3f}",
+                                name, ring->thread_id, (event->start_ns - trace_epoch) / 1000.0,
+                                event->duration_ns / 1000.0)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Render every thread's spans as Chrome trace-event JSON (Perfetto, chrome://tracing) */
+int renderChromeTrace(StringBuffer* out) {
+    TraceEvent* snapshot = (TraceEvent*)malloc(sizeof(TraceEvent) * TRACE_RING_SIZE);
+    if (!snapshot) {
+        fprintf(stderr, "Error: Memory allocation failed for trace snapshot\n");
+        return 0;
+    }
+
+    int ok = stringBufferAppend(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    int first = 1;
+    int count = __atomic_load_n(&ring_count, __ATOMIC_ACQUIRE);
+    if (count > TRACE_MAX_THREADS) count = TRACE_MAX_THREADS;
+
+    for (int i = 0; ok && i < count; i++) {
+        TraceRing* ring = __atomic_load_n(&rings[i], __ATOMIC_ACQUIRE);
+        if (ring) ok = renderRing(out, ring, snapshot, &first);
+    }
+
+    ok = ok && stringBufferAppend(out, "\n]}\n");
+    free(snapshot);
+    return ok;
+}
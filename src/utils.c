@@ -1,12 +1,19 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdarg.h>
 #include <string.h>
 #include <time.h>
 #include <math.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
 #include "graph.h"
 #include "../include/utils.h"
 
-static int visitor_id_counter = 1000;
+static int visitor_id_counter = FIRST_VISITOR_ID;
 static int group_id_counter = 1;
 
 /* Generate visitor ID */
@@ -14,6 +21,13 @@ int generateVisitorID() {
     return visitor_id_counter++;
 }
 
+/* Reserve a contiguous block of visitor IDs, returns the first one */
+int reserveVisitorIDs(int count) {
+    int first = visitor_id_counter;
+    if (count > 0) visitor_id_counter += count;
+    return first;
+}
+
 /* Generate group ID */
 int generateGroupID() {
     return group_id_counter++;
@@ -41,10 +55,7 @@ float calculateSatisfactionScore(Visitor* visitor, Ride* ride) {
 
 /* Calculate estimated wait time */
 int calculateEstimatedWaitTime(int queue_size, int ride_capacity) {
-    if (ride_capacity <= 0) return 0;
-    
-    int cycles = (queue_size + ride_capacity - 1) / ride_capacity;
-    return cycles * (BASE_RIDE_DURATION + BOARDING_TIME);
+    return predictDefaultWait(queue_size, ride_capacity);
 }
 
 /* Format time */
@@ -73,6 +84,24 @@ void getCurrentTimestamp(char* buffer) {
             t->tm_hour, t->tm_min, t->tm_sec);
 }
 
+/* Monotonic clock in nanoseconds (for timing, not wall-clock time) */
+long long getMonotonicNanos() {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    QueryPerformanceCounter(&counter);
+    return (long long)(counter.QuadPart / frequency.QuadPart) * 1000000000LL +
+           (long long)(counter.QuadPart % frequency.QuadPart) * 1000000000LL / frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#endif
+}
+
 /* Display separator */
 void displaySeparator() {
     printf("================================================\n");
@@ -258,3 +287,41 @@ float minf(float a, float b) {
 float maxf(float a, float b) {
     return (a > b) ? a : b;
 }
+
+/* Append formatted text, growing the buffer as needed */
+int stringBufferAppend(StringBuffer* out, const char* format, ...) {
+    for (int attempt = 0; attempt < 2; attempt++) {
+        size_t available = out->capacity - out->length;
+        va_list args;
+        va_start(args, format);
+        int written = vsnprintf(out->data ? out->data + out->length : NULL, available, format, args);
+        va_end(args);
+
+        if (written < 0) return 0;
+        if ((size_t)written < available) {
+            out->length += written;
+            return 1;
+        }
+
+        size_t new_capacity = out->capacity ? out->capacity * 2 : 4096;
+        while (new_capacity < out->length + written + 1) new_capacity *= 2;
+        char* grown = (char*)realloc(out->data, new_capacity);
+        if (!grown) {
+            fprintf(stderr, "Error: Memory allocation failed for string buffer\n");
+            return 0;
+        }
+        out->data = grown;
+        out->capacity = new_capacity;
+    }
+    return 0;
+}
+
+/* Free the buffer and leave it empty for reuse */
+void freeStringBuffer(StringBuffer* out) {
+    if (out) {
+        free(out->data);
+        out->data = NULL;
+        out->length = 0;
+        out->capacity = 0;
+    }
+}
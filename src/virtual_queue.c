@@ -0,0 +1,258 @@
+/* Virtual Queue: Per-Ride Return-Time Calendars */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/virtual_queue.h"
+#include "../include/utils.h"
+
+/* Windows [base_slot, base_slot + VQUEUE_HORIZON_SLOTS) of one ride */
+typedef struct RideCalendar {
+    long base_slot;                     // Window at index 0
+    int capacity;                       // Seats per window the tree was built for
+    int leaves;                         // Power of two >= VQUEUE_HORIZON_SLOTS
+    int booked[VQUEUE_HORIZON_SLOTS];
+    int* free_tree;                     // Max free seats per subtree, root at 1
+} RideCalendar;
+
+static RideCalendar* calendars[MAX_RIDES];
+
+static long currentSlot(void) {
+    return (long)(time(NULL) / VQUEUE_SLOT_SECONDS);
+}
+
+/* Seats per window: the return share of capacity times cycles per window */
+int getReturnWindowCapacity(Ride* ride) {
+    if (!ride) return 0;
+
+    int cycle = ride->ride_duration > 0 ? ride->ride_duration : DEFAULT_CYCLE_SECONDS;
+    int cycles = max(1, VQUEUE_SLOT_SECONDS / cycle);
+    long seats = (long)ride->capacity * cycles * VQUEUE_RETURN_SHARE / 100;
+    return seats > 0 ? (int)seats : 1;
+}
+
+/* Refresh one window's free seats and its ancestors - O(log slots) */
+static void updateWindow(RideCalendar* cal, int index) {
+    int node = cal->leaves + index;
+    cal->free_tree[node] = max(0, cal->capacity - cal->booked[index]);
+    for (node /= 2; node >= 1; node /= 2) {
+        cal->free_tree[node] = max(cal->free_tree[2 * node], cal->free_tree[2 * node + 1]);
+    }
+}
+
+static void rebuildCalendar(RideCalendar* cal) {
+    for (int i = 0; i < cal->leaves; i++) {
+        cal->free_tree[cal->leaves + i] = i < VQUEUE_HORIZON_SLOTS ? max(0, cal->capacity - cal->booked[i]) : 0;
+    }
+    for (int node = cal->leaves - 1; node >= 1; node--) {
+        cal->free_tree[node] = max(cal->free_tree[2 * node], cal->free_tree[2 * node + 1]);
+    }
+}
+
+/* Ride's calendar: created on first use, slid forward once half of it has
+ * passed, and rebuilt if the ride's capacity or cycle time changed */
+static RideCalendar* getCalendar(Ride* ride) {
+    if (!ride || ride->id < 0 || ride->id >= MAX_RIDES) return NULL;
+
+    RideCalendar* cal = calendars[ride->id];
+    long now_slot = currentSlot();
+    int rebuild = 0;
+
+    if (!cal) {
+        cal = (RideCalendar*)calloc(1, sizeof(RideCalendar));
+        int leaves = 1;
+        while (leaves < VQUEUE_HORIZON_SLOTS) leaves *= 2;
+        int* tree = cal ? (int*)calloc(2 * leaves, sizeof(int)) : NULL;
+        if (!tree) {
+            fprintf(stderr, "Error: Memory allocation failed for ride calendar\n");
+            free(cal);
+            return NULL;
+        }
+        cal->base_slot = now_slot;
+        cal->leaves = leaves;
+        cal->free_tree = tree;
+        calendars[ride->id] = cal;
+        rebuild = 1;
+    }
+
+    long passed = now_slot - cal->base_slot;
+    if (passed >= VQUEUE_HORIZON_SLOTS / 2) {
+        // Drop the windows that have closed; the rest move to the front
+        int kept = passed < VQUEUE_HORIZON_SLOTS ? VQUEUE_HORIZON_SLOTS - (int)passed : 0;
+        memmove(cal->booked, cal->booked + (VQUEUE_HORIZON_SLOTS - kept), sizeof(int) * kept);
+        memset(cal->booked + kept, 0, sizeof(int) * (VQUEUE_HORIZON_SLOTS - kept));
+        cal->base_slot = now_slot;
+        rebuild = 1;
+    }
+
+    int capacity = getReturnWindowCapacity(ride);
+    if (capacity != cal->capacity) {
+        cal->capacity = capacity;
+        rebuild = 1;
+    }
+
+    if (rebuild) rebuildCalendar(cal);
+    return cal;
+}
+
+/* Leftmost window at or after index lo with a free seat - O(log slots) */
+static int firstFreeWindow(const RideCalendar* cal, int node, int left, int right, int lo) {
+    if (right < lo || cal->free_tree[node] == 0) return -1;
+    if (left == right) return left;
+
+    int mid = (left + right) / 2;
+    int found = firstFreeWindow(cal, 2 * node, left, mid, lo);
+    return found >= 0 ? found : firstFreeWindow(cal, 2 * node + 1, mid + 1, right, lo);
+}
+
+/* Index of the first window with room whose span ends after earliest (-1 = none) */
+static int findWindow(const RideCalendar* cal, time_t earliest) {
+    long slot = (long)(earliest / VQUEUE_SLOT_SECONDS);
+    if (slot < currentSlot()) slot = currentSlot();
+    long lo = slot - cal->base_slot;
+    if (lo >= VQUEUE_HORIZON_SLOTS) return -1;
+    return firstFreeWindow(cal, 1, 0, cal->leaves - 1, (int)lo);
+}
+
+/* Window timer fired: the visitor did not return in time */
+static void returnWindowClosed(Timer* timer) {
+    Visitor* visitor = (Visitor*)timer->owner;
+    visitor->reservation.ride_id = -1;
+}
+
+/* Give the visitor a seat in an absolute window (counted if still on the calendar) */
+static void holdWindow(Visitor* visitor, RideCalendar* cal, int ride_id, long slot) {
+    long index = cal ? slot - cal->base_slot : -1;
+    if (index >= 0 && index < VQUEUE_HORIZON_SLOTS) {
+        cal->booked[index]++;
+        updateWindow(cal, (int)index);
+    }
+
+    visitor->reservation.ride_id = ride_id;
+    visitor->reservation.slot = slot;
+    visitor->reservation.window_timer.callback = returnWindowClosed;
+    visitor->reservation.window_timer.owner = visitor;
+    scheduleTimer(&visitor->reservation.window_timer,
+                  (time_t)(slot + 1) * VQUEUE_SLOT_SECONDS + VQUEUE_LATE_GRACE);
+}
+
+/* Give the visitor's seat back to its window */
+static void releaseWindow(Visitor* visitor) {
+    int ride_id = visitor->reservation.ride_id;
+    RideCalendar* cal = ride_id >= 0 && ride_id < MAX_RIDES ? calendars[ride_id] : NULL;
+    long index = cal ? visitor->reservation.slot - cal->base_slot : -1;
+    if (index >= 0 && index < VQUEUE_HORIZON_SLOTS && cal->booked[index] > 0) {
+        cal->booked[index]--;
+        updateWindow(cal, (int)index);
+    }
+
+    visitor->reservation.ride_id = -1;
+    cancelTimer(&visitor->reservation.window_timer);
+}
+
+/* Start of the next return window with room at or after earliest (0 = none) */
+time_t findNextReturnTime(Ride* ride, time_t earliest) {
+    if (!ride || !ride->is_operational) return 0;
+
+    RideCalendar* cal = getCalendar(ride);
+    int index = cal ? findWindow(cal, earliest) : -1;
+    return index >= 0 ? (time_t)(cal->base_slot + index) * VQUEUE_SLOT_SECONDS : 0;
+}
+
+/* Spend a fast pass on the first window with room at or after earliest */
+ReserveResult bookReturnTime(Visitor* visitor, Ride* ride, time_t earliest) {
+    if (!visitor || !ride) return RESERVE_INVALID;
+    if (visitor->reservation.ride_id >= 0) return RESERVE_HELD;
+    if (visitor->fast_passes_remaining <= 0) return RESERVE_NO_PASS;
+    if (!ride->is_operational) return RESERVE_CLOSED;
+
+    RideCalendar* cal = getCalendar(ride);
+    if (!cal) return RESERVE_CLOSED;
+    int index = findWindow(cal, earliest);
+    if (index < 0) return RESERVE_FULL;
+
+    holdWindow(visitor, cal, ride->id, cal->base_slot + index);
+    visitor->fast_passes_remaining--;
+    return RESERVE_OK;
+}
+
+/* Move a reservation (possibly to another ride). All or nothing: if no
+ * window has room the visitor keeps the seat they had. */
+ReserveResult rebookReturnTime(Visitor* visitor, Ride* ride, time_t earliest) {
+    if (!visitor || !ride) return RESERVE_INVALID;
+    if (visitor->reservation.ride_id < 0) return RESERVE_NONE;
+    if (!ride->is_operational) return RESERVE_CLOSED;
+
+    RideCalendar* cal = getCalendar(ride);
+    if (!cal) return RESERVE_CLOSED;
+
+    // Free the visitor's own seat first so it is a candidate too
+    int old_ride = visitor->reservation.ride_id;
+    long old_slot = visitor->reservation.slot;
+    releaseWindow(visitor);
+
+    int index = findWindow(cal, earliest);
+    if (index < 0) {
+        holdWindow(visitor, calendars[old_ride], old_ride, old_slot);
+        return RESERVE_FULL;
+    }
+
+    holdWindow(visitor, cal, ride->id, cal->base_slot + index);
+    return RESERVE_OK;
+}
+
+/* Give the window back and refund the fast pass */
+ReserveResult cancelReturnTime(Visitor* visitor) {
+    if (!visitor) return RESERVE_INVALID;
+    if (visitor->reservation.ride_id < 0) return RESERVE_NONE;
+
+    releaseWindow(visitor);
+    visitor->fast_passes_remaining++;
+    return RESERVE_OK;
+}
+
+/* Visitor is back during their window: join the ride's fast-pass lane.
+ * The caller wakes the ride (wakeRide) once this succeeds. */
+ReserveResult redeemReturnTime(Visitor* visitor, DualQueue* queue) {
+    if (!visitor) return RESERVE_INVALID;
+    if (visitor->reservation.ride_id < 0) return RESERVE_NONE;
+    if (!queue || queue->ride_id != visitor->reservation.ride_id) return RESERVE_CLOSED;
+    if (visitor->queued_ride_id >= 0) return RESERVE_IN_QUEUE;
+    if (time(NULL) < getReturnTime(visitor)) return RESERVE_EARLY;
+
+    // The seat was used, so the window keeps it counted
+    visitor->reservation.ride_id = -1;
+    cancelTimer(&visitor->reservation.window_timer);
+    enqueueFastPass(queue, visitor);
+    return RESERVE_OK;
+}
+
+/* Start of the visitor's return window (0 = none held) */
+time_t getReturnTime(const Visitor* visitor) {
+    if (!visitor || visitor->reservation.ride_id < 0) return 0;
+    return (time_t)visitor->reservation.slot * VQUEUE_SLOT_SECONDS;
+}
+
+const char* getReserveResultMessage(ReserveResult result) {
+    switch (result) {
+        case RESERVE_OK: return "OK";
+        case RESERVE_NO_PASS: return "No fast passes remaining";
+        case RESERVE_HELD: return "Visitor already holds a return time";
+        case RESERVE_NONE: return "Visitor holds no return time";
+        case RESERVE_FULL: return "No return time available";
+        case RESERVE_CLOSED: return "Ride is closed";
+        case RESERVE_EARLY: return "Return window has not opened yet";
+        case RESERVE_IN_QUEUE: return "Visitor is already in a ride queue";
+        default: return "Invalid reservation request";
+    }
+}
+
+/* Free every calendar (bookings held by visitors are left as they are) */
+void resetVirtualQueues(void) {
+    for (int i = 0; i < MAX_RIDES; i++) {
+        if (calendars[i]) {
+            free(calendars[i]->free_tree);
+            free(calendars[i]);
+            calendars[i] = NULL;
+        }
+    }
+}
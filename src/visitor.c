@@ -4,6 +4,35 @@
 #include <time.h>
 #include "../include/visitor.h"
 #include "../include/ride_manager.h"
+#include "../include/park_stats.h"
+#include "../include/metrics.h"
+#include "../include/visitor_exit.h"
+#include "../include/group_registry.h"
+#include "../include/virtual_queue.h"
+#include "../include/congestion.h"
+#include "../include/crowd_balancer.h"
+
+/* Inactivity timer fired: no move or ride for VISITOR_IDLE_TIMEOUT seconds.
+ * It stays armed while idle; still idle VISITOR_EXIT_IDLE_TIMEOUT later and
+ * not waiting in a queue, the visitor is taken to have left. */
+static void visitorWentIdle(Timer* timer) {
+    Visitor* visitor = (Visitor*)timer->owner;
+    if (visitor->is_idle && visitor->queued_ride_id < 0) {
+        markVisitorForExit(visitor, EXIT_INACTIVE);
+        return;
+    }
+    
+    if (!visitor->is_idle) {
+        visitor->is_idle = 1;
+        statsVisitorIdleChanged(1);
+    }
+    scheduleTimer(timer, time(NULL) + VISITOR_EXIT_IDLE_TIMEOUT);
+}
+
+/* Stay timer fired: the visitor has been in the park VISITOR_MAX_STAY */
+static void visitorStayEnded(Timer* timer) {
+    markVisitorForExit((Visitor*)timer->owner, EXIT_STAY_LIMIT);
+}
 
 /* Create a new visitor */
 Visitor* createVisitor(int id, const char* name, int thrill_preference) {
@@ -17,6 +46,7 @@ Visitor* createVisitorWithTicket(int id, const char* name, int thrill_preference
         fprintf(stderr, "Error: Memory allocation failed for visitor\n");
         return NULL;
     }
+    metricAdd(METRIC_ALLOC_VISITOR, 1);
     
     visitor->id = id;
     strncpy(visitor->name, name, MAX_NAME_LENGTH - 1);
@@ -29,7 +59,21 @@ Visitor* createVisitorWithTicket(int id, const char* name, int thrill_preference
     visitor->ticket_type = ticket_type;
     visitor->fast_passes_remaining = (ticket_type == TICKET_PREMIUM) ? 3 : 0;
     visitor->entry_time = (int)time(NULL);
-    visitor->ride_history_head = NULL;  // Initialize empty ride history
+    visitor->queued_ride_id = -1;
+    visitor->queue_lane = 0;
+    visitor->queue_ticket = 0;
+    visitor->ride_history = NULL;  // Initialize empty ride history
+    visitor->history_count = 0;
+    visitor->history_capacity = 0;
+    visitor->last_ride_time = 0;
+    memset(visitor->recent_rides, 0, sizeof(visitor->recent_rides));
+    visitor->is_idle = 0;
+    initTimer(&visitor->idle_timer, visitorWentIdle, visitor);
+    initTimer(&visitor->stay_timer, visitorStayEnded, visitor);
+    visitor->pending_exit = EXIT_NONE;
+    visitor->reservation.ride_id = -1;
+    visitor->reservation.slot = 0;
+    initTimer(&visitor->reservation.window_timer, NULL, visitor);
     
     return visitor;
 }
@@ -42,12 +86,8 @@ const char* getTicketTypeName(TicketType type) {
 /* Free visitor memory */
 void freeVisitor(Visitor* visitor) {
     if (visitor) {
-        // Free ride history
-        while (visitor->ride_history_head) {
-            RideHistoryEntry* entry = visitor->ride_history_head;
-            visitor->ride_history_head = entry->next;
-            free(entry);
-        }
+        stopVisitorTimers(visitor);
+        free(visitor->ride_history);
         free(visitor);
     }
 }
@@ -72,6 +112,13 @@ void displayVisitorInfo(Visitor* visitor) {
 /* Update visitor location */
 void updateVisitorLocation(Visitor* visitor, int new_location) {
     if (visitor) {
+        if (visitor->current_location != new_location) {
+            noteCrowdChange(visitor->current_location, -1);
+            noteCrowdChange(new_location, 1);
+            noteCrowdIntent(visitor->current_location, visitor->thrill_preference, -1);
+            noteCrowdIntent(new_location, visitor->thrill_preference, 1);
+            touchVisitor(visitor);
+        }
         visitor->current_location = new_location;
     }
 }
@@ -80,9 +127,72 @@ void updateVisitorLocation(Visitor* visitor, int new_location) {
 void updateVisitorStats(Visitor* visitor, int distance, float satisfaction) {
     if (!visitor) return;
     
+    float old_satisfaction = visitor->satisfaction_score;
     visitor->total_distance_traveled += distance;
     visitor->satisfaction_score = (visitor->satisfaction_score + satisfaction) / 2.0f;
     visitor->rides_completed++;
+    
+    statsVisitorChanged(distance, visitor->satisfaction_score - old_satisfaction);
+    touchVisitor(visitor);
+}
+
+/* Overwrite satisfaction score */
+void setVisitorSatisfaction(Visitor* visitor, float satisfaction) {
+    if (!visitor) return;
+    
+    statsVisitorChanged(0, satisfaction - visitor->satisfaction_score);
+    visitor->satisfaction_score = satisfaction;
+}
+
+/* Visitor entered the park: arm the stay limit and the inactivity timer */
+void startVisitorTimers(Visitor* visitor) {
+    if (!visitor) return;
+    
+    scheduleTimer(&visitor->stay_timer, (time_t)visitor->entry_time + VISITOR_MAX_STAY);
+    touchVisitor(visitor);
+}
+
+/* Visitor did something: clear idleness and restart the inactivity timer - O(1) */
+void touchVisitor(Visitor* visitor) {
+    if (!visitor) return;
+    
+    if (visitor->is_idle) {
+        visitor->is_idle = 0;
+        statsVisitorIdleChanged(-1);
+    }
+    if (visitor->pending_exit == EXIT_INACTIVE) cancelVisitorExit(visitor);  // Back after all
+    scheduleTimer(&visitor->idle_timer, time(NULL) + VISITOR_IDLE_TIMEOUT);
+}
+
+/* Disarm the visitor's timers (left the park or being freed) */
+void stopVisitorTimers(Visitor* visitor) {
+    if (!visitor) return;
+    
+    cancelTimer(&visitor->idle_timer);
+    cancelTimer(&visitor->stay_timer);
+    cancelTimer(&visitor->reservation.window_timer);
+    cancelVisitorExit(visitor);
+    if (visitor->is_idle) {
+        visitor->is_idle = 0;
+        statsVisitorIdleChanged(-1);
+    }
+}
+
+/* Visitor linked into a group: they are in the park */
+static void visitorEntered(Visitor* visitor) {
+    statsVisitorAdded(visitor);
+    noteCrowdChange(visitor->current_location, 1);
+    noteCrowdIntent(visitor->current_location, visitor->thrill_preference, 1);
+    startVisitorTimers(visitor);
+}
+
+/* Visitor unlinked from their group: they have left the park */
+static void visitorLeft(Visitor* visitor) {
+    statsVisitorRemoved(visitor);
+    noteCrowdChange(visitor->current_location, -1);
+    noteCrowdIntent(visitor->current_location, visitor->thrill_preference, -1);
+    cancelReturnTime(visitor);  // Frees the seat in their return window
+    stopVisitorTimers(visitor);
 }
 
 /* Create visitor group */
@@ -98,6 +208,7 @@ VisitorGroup* createVisitorGroup(int group_id) {
     group->size = 0;
     group->group_id = group_id;
     group->average_thrill_preference = 0.0f;
+    group->registry_slot = -1;
     
     return group;
 }
@@ -111,10 +222,12 @@ void addVisitorToGroup(VisitorGroup* group, Visitor* visitor) {
         fprintf(stderr, "Error: Memory allocation failed for visitor node\n");
         return;
     }
+    metricAdd(METRIC_ALLOC_VISITOR_NODE, 1);
     
     node->visitor = visitor;
     node->next = NULL;
     node->prev = group->tail;
+    node->group = group;
     
     if (group->tail) {
         group->tail->next = node;
@@ -124,8 +237,48 @@ void addVisitorToGroup(VisitorGroup* group, Visitor* visitor) {
     
     group->tail = node;
     group->size++;
+    indexVisitorNode(node);
+    visitorEntered(visitor);
     
-    calculateGroupPreference(group);
+    // Running average instead of re-walking the whole group
+    group->average_thrill_preference +=
+        (visitor->thrill_preference - group->average_thrill_preference) / group->size;
+}
+
+/* Append a batch of visitors, updating the average once at the end */
+void appendVisitorsToGroup(VisitorGroup* group, Visitor* visitors[], int count) {
+    if (!group || !visitors || count <= 0) return;
+    
+    float sum = group->average_thrill_preference * group->size;
+    
+    for (int i = 0; i < count; i++) {
+        VisitorNode* node = (VisitorNode*)malloc(sizeof(VisitorNode));
+        if (!node) {
+            fprintf(stderr, "Error: Memory allocation failed for visitor node\n");
+            freeVisitor(visitors[i]);
+            continue;
+        }
+        metricAdd(METRIC_ALLOC_VISITOR_NODE, 1);
+        
+        node->visitor = visitors[i];
+        node->next = NULL;
+        node->prev = group->tail;
+        node->group = group;
+        
+        if (group->tail) {
+            group->tail->next = node;
+        } else {
+            group->head = node;
+        }
+        
+        group->tail = node;
+        group->size++;
+        sum += visitors[i]->thrill_preference;
+        indexVisitorNode(node);
+        visitorEntered(visitors[i]);
+    }
+    
+    group->average_thrill_preference = group->size > 0 ? sum / group->size : 0.0f;
 }
 
 /* Remove visitor from group */
@@ -136,29 +289,42 @@ void removeVisitorFromGroup(VisitorGroup* group, int visitor_id) {
     
     while (current) {
         if (current->visitor->id == visitor_id) {
-            if (current->prev) {
-                current->prev->next = current->next;
-            } else {
-                group->head = current->next;
-            }
-            
-            if (current->next) {
-                current->next->prev = current->prev;
-            } else {
-                group->tail = current->prev;
-            }
-            
-            freeVisitor(current->visitor);
-            free(current);
-            group->size--;
-            
-            calculateGroupPreference(group);
+            removeVisitorNode(group, current);
             return;
         }
         current = current->next;
     }
 }
 
+/* Unlink a node of the group and free it with its visitor - O(1) */
+void removeVisitorNode(VisitorGroup* group, VisitorNode* node) {
+    if (!group || !node) return;
+    
+    if (node->prev) {
+        node->prev->next = node->next;
+    } else {
+        group->head = node->next;
+    }
+    
+    if (node->next) {
+        node->next->prev = node->prev;
+    } else {
+        group->tail = node->prev;
+    }
+    
+    // Running average, the inverse of addVisitorToGroup
+    int thrill = node->visitor->thrill_preference;
+    group->size--;
+    group->average_thrill_preference = group->size > 0
+        ? group->average_thrill_preference + (group->average_thrill_preference - thrill) / group->size
+        : 0.0f;
+    
+    unindexVisitorNode(node);
+    visitorLeft(node->visitor);
+    freeVisitor(node->visitor);
+    free(node);
+}
+
 /* Find visitor in group */
 Visitor* findVisitorInGroup(VisitorGroup* group, int visitor_id) {
     if (!group) return NULL;
@@ -215,13 +381,17 @@ void displayGroupReverse(VisitorGroup* group) {
     printf("=========================================\n");
 }
 
-/* Free visitor group */
+/* Free visitor group (taking it out of the registry if it is in it) */
 void freeVisitorGroup(VisitorGroup* group) {
     if (!group) return;
     
+    unregisterGroup(group);
+    
     VisitorNode* current = group->head;
     while (current) {
         VisitorNode* next = current->next;
+        unindexVisitorNode(current);
+        visitorLeft(current->visitor);
         freeVisitor(current->visitor);
         free(current);
         current = next;
@@ -241,49 +411,55 @@ void moveGroupToRide(VisitorGroup* group, Ride* ride) {
     }
 }
 
-/* Split group into two */
+/* Split group into two: the first count visitors stay, the rest move to a
+ * new registered group. Walks back from the tail, so it costs only the
+ * visitors that move. */
 VisitorGroup* splitGroup(VisitorGroup* group, int count) {
     if (!group || count >= group->size || count <= 0) {
         return NULL;
     }
     
-    VisitorGroup* newGroup = createVisitorGroup(group->group_id + 1000);
+    VisitorGroup* newGroup = createRegisteredGroup();
     if (!newGroup) return NULL;
     
-    VisitorNode* current = group->head;
-    int i = 0;
+    int moved = group->size - count;
+    float moved_sum = 0.0f;
+    VisitorNode* current = group->tail;
     
-    // Move to split point
-    while (current && i < count) {
-        current = current->next;
-        i++;
+    // Walk back to the split point, repointing the nodes that move
+    for (int i = 0; i < moved; i++) {
+        current->group = newGroup;
+        moved_sum += current->visitor->thrill_preference;
+        if (i < moved - 1) current = current->prev;
     }
     
-    if (!current) return newGroup;
-    
     // Split the list
     newGroup->head = current;
     newGroup->tail = group->tail;
     
-    if (current->prev) {
-        current->prev->next = NULL;
-    }
+    current->prev->next = NULL;
     group->tail = current->prev;
     current->prev = NULL;
     
-    // Update sizes
-    newGroup->size = group->size - count;
+    // Update sizes and averages from the moved visitors' sum
+    float total = group->average_thrill_preference * group->size;
+    newGroup->size = moved;
+    newGroup->average_thrill_preference = moved_sum / moved;
     group->size = count;
-    
-    calculateGroupPreference(group);
-    calculateGroupPreference(newGroup);
+    group->average_thrill_preference = (total - moved_sum) / count;
     
     return newGroup;
 }
 
-/* Merge two groups */
+/* Merge g2 into g1 - O(size of g2). g2 is left empty for the caller to free. */
 void mergeGroups(VisitorGroup* g1, VisitorGroup* g2) {
-    if (!g1 || !g2 || !g2->head) return;
+    if (!g1 || !g2 || !g2->head || g1 == g2) return;
+    
+    float sum = g1->average_thrill_preference * g1->size;
+    for (VisitorNode* node = g2->head; node; node = node->next) {
+        node->group = g1;
+        sum += node->visitor->thrill_preference;
+    }
     
     if (g1->tail) {
         g1->tail->next = g2->head;
@@ -295,13 +471,13 @@ void mergeGroups(VisitorGroup* g1, VisitorGroup* g2) {
     }
     
     g1->size += g2->size;
+    g1->average_thrill_preference = sum / g1->size;
     
     // Clear g2 without freeing visitors
     g2->head = NULL;
     g2->tail = NULL;
     g2->size = 0;
-    
-    calculateGroupPreference(g1);
+    g2->average_thrill_preference = 0.0f;
 }
 
 /* Calculate group's average thrill preference */
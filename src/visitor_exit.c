@@ -0,0 +1,165 @@
+/* Visitor Exit Processing and History Archive */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../include/visitor_exit.h"
+#include "../include/metrics.h"
+#include "../include/trace.h"
+#include "../include/group_registry.h"
+
+static DualQueue** exit_queues = NULL;
+
+static int pending_exits = 0;      // Visitors marked for the next sweep
+static int* pending_ids = NULL;    // Ids marked since the last sweep (may repeat or be stale)
+static int pending_id_count = 0;
+static int pending_id_capacity = 0;
+static time_t next_sweep = 0;
+
+/* Ride queues a departing visitor is taken out of */
+void initVisitorExits(DualQueue** queues) {
+    exit_queues = queues;
+    pending_exits = 0;
+    pending_id_count = 0;
+    next_sweep = 0;
+}
+
+/* Append one visitor's record and packed history to the archive */
+static void archiveVisitor(FILE* archive, Visitor* visitor, ExitReason reason, time_t now) {
+    if (!archive) return;
+
+    size_t name_length = strlen(visitor->name);
+    if (name_length > 255) name_length = 255;
+
+    VisitorArchiveRecord record;
+    memset(&record, 0, sizeof(record));
+    record.visitor_id = visitor->id;
+    record.entry_time = visitor->entry_time;
+    record.exit_time = (int)now;
+    record.rides_completed = visitor->rides_completed;
+    record.total_distance_traveled = visitor->total_distance_traveled;
+    record.satisfaction_score = visitor->satisfaction_score;
+    record.history_count = (unsigned int)visitor->history_count;
+    record.reason = (unsigned char)reason;
+    record.ticket_type = (unsigned char)visitor->ticket_type;
+    record.name_length = (unsigned char)name_length;
+
+    if (fwrite(&record, sizeof(record), 1, archive) != 1 ||
+        fwrite(visitor->name, 1, name_length, archive) != name_length ||
+        fwrite(visitor->ride_history, sizeof(RideHistoryEntry), visitor->history_count, archive)
+            != (size_t)visitor->history_count) {
+        fprintf(stderr, "Error: Could not archive visitor %d\n", visitor->id);
+    }
+}
+
+/* Take the visitor out of every park structure, archive and free them.
+ * A registered group they leave empty is freed too. */
+static void departVisitor(VisitorNode* node, ExitReason reason, FILE* archive, time_t now) {
+    Visitor* visitor = node->visitor;
+    VisitorGroup* group = node->group;
+
+    if (exit_queues && visitor->queued_ride_id >= 0 && visitor->queued_ride_id < MAX_RIDES) {
+        leaveDualQueue(exit_queues[visitor->queued_ride_id], visitor);
+    }
+
+    archiveVisitor(archive, visitor, reason, now);
+
+    metricAdd(METRIC_EXITS_TURNSTILE + (reason - EXIT_TURNSTILE), 1);
+    removeVisitorNode(group, node);  // Index entry, undo stack, timers, exit mark and park stats go with it
+
+    if (group->size == 0 && group->registry_slot >= 0) {
+        freeVisitorGroup(group);
+    }
+}
+
+static FILE* openArchive(void) {
+    FILE* archive = fopen(VISITOR_ARCHIVE_FILE, "ab");
+    if (!archive) {
+        fprintf(stderr, "Error: Could not open %s\n", VISITOR_ARCHIVE_FILE);
+    }
+    return archive;
+}
+
+/* Visitor left through a turnstile (or was removed by an operator).
+ * Returns 1 if they were in the park. */
+int exitVisitor(int visitor_id, ExitReason reason) {
+    if (reason == EXIT_NONE) return 0;
+
+    VisitorNode* node = findVisitorNode(visitor_id);
+    if (!node) return 0;
+
+    FILE* archive = openArchive();
+    departVisitor(node, reason, archive, time(NULL));
+    if (archive) fclose(archive);
+    return 1;
+}
+
+/* Queue the visitor for the next sweep (timer callbacks can't free them) */
+void markVisitorForExit(Visitor* visitor, ExitReason reason) {
+    if (!visitor || reason == EXIT_NONE) return;
+
+    if (visitor->pending_exit == EXIT_NONE) {
+        if (pending_id_count == pending_id_capacity) {
+            int capacity = pending_id_capacity ? pending_id_capacity * 2 : 64;
+            int* grown = (int*)realloc(pending_ids, sizeof(int) * capacity);
+            if (!grown) {
+                fprintf(stderr, "Error: Memory allocation failed for exit list\n");
+                return;
+            }
+            pending_ids = grown;
+            pending_id_capacity = capacity;
+        }
+        pending_ids[pending_id_count++] = visitor->id;
+        pending_exits++;
+    }
+    visitor->pending_exit = reason;
+}
+
+void cancelVisitorExit(Visitor* visitor) {
+    if (!visitor || visitor->pending_exit == EXIT_NONE) return;
+
+    visitor->pending_exit = EXIT_NONE;
+    pending_exits--;
+}
+
+/* Let out every marked visitor, looking each one up by id - O(marked).
+ * Does nothing until someone is marked and the sweep interval has passed. */
+int sweepVisitorExits(time_t now) {
+    if (pending_exits == 0) {
+        pending_id_count = 0;  // Every mark was cancelled
+        return 0;
+    }
+    if (now < next_sweep) return 0;
+    next_sweep = now + VISITOR_EXIT_SWEEP_INTERVAL;
+
+    TRACE_SPAN("sweepVisitorExits");
+    FILE* archive = openArchive();
+    int departed = 0;
+
+    // Ids whose mark was cancelled, or who left another way, are skipped
+    for (int i = 0; i < pending_id_count; i++) {
+        VisitorNode* node = findVisitorNode(pending_ids[i]);
+        if (node && node->visitor->pending_exit != EXIT_NONE) {
+            departVisitor(node, (ExitReason)node->visitor->pending_exit, archive, now);
+            departed++;
+        }
+    }
+    pending_id_count = 0;
+
+    if (archive) fclose(archive);
+    return departed;
+}
+
+int getPendingExitCount(void) {
+    return pending_exits;
+}
+
+const char* getExitReasonName(ExitReason reason) {
+    switch (reason) {
+        case EXIT_TURNSTILE: return "turnstile";
+        case EXIT_STAY_LIMIT: return "stay_limit";
+        case EXIT_INACTIVE: return "inactive";
+        case EXIT_OPERATOR: return "operator";
+        default: return "none";
+    }
+}
@@ -1,54 +1,121 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include "../include/visitor.h"
 
+/* Check whether a ride appears in the last RECENT_RIDE_WINDOW entries */
+static int inRecentWindow(Visitor* visitor, int ride_id) {
+    int oldest = visitor->history_count - RECENT_RIDE_WINDOW;
+    if (oldest < 0) oldest = 0;
+
+    for (int i = visitor->history_count - 1; i >= oldest; i--) {
+        if (visitor->ride_history[i].ride_id == ride_id) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* Set or clear a ride's bit in the recent-rides bitset */
+static void setRecentBit(Visitor* visitor, int ride_id, int on) {
+    if (ride_id < 0 || ride_id >= MAX_RIDES) return;
+
+    if (on) {
+        visitor->recent_rides[ride_id / 8] |= (unsigned char)(1 << (ride_id % 8));
+    } else {
+        visitor->recent_rides[ride_id / 8] &= (unsigned char)~(1 << (ride_id % 8));
+    }
+}
+
 /* Add ride to visitor's history */
 void addRideToHistory(Visitor* visitor, int ride_id) {
-    if (!visitor) return;
+    if (!visitor || ride_id < 0 || ride_id > 0xFFFF) return;
 
-    RideHistoryEntry* entry = (RideHistoryEntry*)malloc(sizeof(RideHistoryEntry));
-    if (!entry) {
-        fprintf(stderr, "Error: Memory allocation failed for ride history entry\n");
-        return;
+    if (visitor->history_count == visitor->history_capacity) {
+        int new_capacity = visitor->history_capacity ? visitor->history_capacity * 2 : 4;
+        RideHistoryEntry* grown = (RideHistoryEntry*)realloc(visitor->ride_history,
+                                                              sizeof(RideHistoryEntry) * new_capacity);
+        if (!grown) {
+            fprintf(stderr, "Error: Memory allocation failed for ride history entry\n");
+            return;
+        }
+        visitor->ride_history = grown;
+        visitor->history_capacity = new_capacity;
     }
 
-    entry->ride_id = ride_id;
-    entry->timestamp = time(NULL);
-    entry->next = visitor->ride_history_head;
-    visitor->ride_history_head = entry;
+    time_t now = time(NULL);
+    time_t previous = visitor->history_count > 0 ? visitor->last_ride_time
+                                                 : (time_t)visitor->entry_time;
+    long delta = (long)(now - previous);
+    if (delta < 0) delta = 0;
+    if (delta > 0xFFFF) delta = 0xFFFF;
+
+    RideHistoryEntry* entry = &visitor->ride_history[visitor->history_count++];
+    entry->ride_id = (unsigned short)ride_id;
+    entry->delta_seconds = (unsigned short)delta;
+    visitor->last_ride_time = now;
+
+    // Slide the recent window: the new ride enters, one older ride may leave
+    setRecentBit(visitor, ride_id, 1);
+    int leaving = visitor->history_count - 1 - RECENT_RIDE_WINDOW;
+    if (leaving >= 0) {
+        int old_ride = visitor->ride_history[leaving].ride_id;
+        if (!inRecentWindow(visitor, old_ride)) {
+            setRecentBit(visitor, old_ride, 0);
+        }
+    }
 }
 
-/* Get visitor's ride history */
-RideHistoryEntry* getVisitorRideHistory(Visitor* visitor) {
-    return visitor ? visitor->ride_history_head : NULL;
+/* Number of rides in visitor's history */
+int getRideHistoryCount(Visitor* visitor) {
+    return visitor ? visitor->history_count : 0;
 }
 
-/* Check if ride was recently ridden (in last 3 rides) */
-int wasRecentlyRidden(Visitor* visitor, int ride_id) {
-    if (!visitor || !visitor->ride_history_head) return 0;
+/* Copy visitor's ride history, newest first. Returns number of entries. */
+int getVisitorRideHistory(Visitor* visitor, int ride_ids[], time_t timestamps[], int max_entries) {
+    if (!visitor || max_entries <= 0) return 0;
 
-    RideHistoryEntry* current = visitor->ride_history_head;
     int count = 0;
+    time_t timestamp = visitor->last_ride_time;
 
-    while (current && count < 3) {
-        if (current->ride_id == ride_id) {
-            return 1;
-        }
-        current = current->next;
+    for (int i = visitor->history_count - 1; i >= 0 && count < max_entries; i--) {
+        if (ride_ids) ride_ids[count] = visitor->ride_history[i].ride_id;
+        if (timestamps) timestamps[count] = timestamp;
+        timestamp -= visitor->ride_history[i].delta_seconds;
         count++;
     }
 
-    return 0;
+    return count;
+}
+
+/* Check if ride was recently ridden (in last RECENT_RIDE_WINDOW rides) */
+int wasRecentlyRidden(Visitor* visitor, int ride_id) {
+    if (!visitor || visitor->history_count == 0) return 0;
+
+    if (ride_id >= 0 && ride_id < MAX_RIDES) {
+        return (visitor->recent_rides[ride_id / 8] >> (ride_id % 8)) & 1;
+    }
+
+    return inRecentWindow(visitor, ride_id);
 }
 
 /* Undo last ride */
 int undoLastRide(Visitor* visitor) {
-    if (!visitor || !visitor->ride_history_head) return 0;
+    if (!visitor || visitor->history_count == 0) return 0;
+
+    RideHistoryEntry removed = visitor->ride_history[--visitor->history_count];
+    visitor->last_ride_time -= removed.delta_seconds;
 
-    RideHistoryEntry* entry = visitor->ride_history_head;
-    visitor->ride_history_head = entry->next;
-    free(entry);
+    // Window slides back: the removed ride may leave, an older one re-enters
+    if (!inRecentWindow(visitor, removed.ride_id)) {
+        setRecentBit(visitor, removed.ride_id, 0);
+    }
+    int entering = visitor->history_count - RECENT_RIDE_WINDOW;
+    if (entering >= 0) {
+        setRecentBit(visitor, visitor->ride_history[entering].ride_id, 1);
+    }
 
     if (visitor->rides_completed > 0) {
         visitor->rides_completed--;
@@ -61,9 +128,10 @@ int undoLastRide(Visitor* visitor) {
 void clearRideHistory(Visitor* visitor) {
     if (!visitor) return;
 
-    while (visitor->ride_history_head) {
-        RideHistoryEntry* entry = visitor->ride_history_head;
-        visitor->ride_history_head = entry->next;
-        free(entry);
-    }
-}
\ No newline at end of file
+    free(visitor->ride_history);
+    visitor->ride_history = NULL;
+    visitor->history_count = 0;
+    visitor->history_capacity = 0;
+    visitor->last_ride_time = 0;
+    memset(visitor->recent_rides, 0, sizeof(visitor->recent_rides));
+}
@@ -0,0 +1,56 @@
+/* Wait-Time Estimator based on Observed Ride Throughput */
+#include <stdio.h>
+#include <math.h>
+#include "../include/wait_estimator.h"
+
+/* Initialize with the nominal cycle until real dispatches are seen */
+void initThroughputEstimate(ThroughputEstimate* est, int capacity, int cycle_seconds) {
+    if (!est) return;
+
+    est->dispatch_interval = (float)(cycle_seconds > 0 ? cycle_seconds : DEFAULT_CYCLE_SECONDS);
+    est->riders_per_cycle = (float)(capacity > 0 ? capacity : 1);
+    est->last_dispatch = 0;
+    est->samples = 0;
+}
+
+/* Fold one dispatch batch into the estimate.
+ * still_waiting is the queue left behind: if the batch emptied the queue it
+ * was demand-limited and says nothing about how many riders fit per cycle. */
+void recordDispatch(ThroughputEstimate* est, int riders, int still_waiting, time_t now) {
+    if (!est || riders <= 0) return;
+
+    if (est->last_dispatch > 0) {
+        float gap = (float)(now - est->last_dispatch);
+        // Gaps much longer than a cycle mean the ride sat idle, not a slow cycle
+        if (gap > 0.0f && gap <= est->dispatch_interval * ESTIMATOR_IDLE_FACTOR) {
+            est->dispatch_interval = ESTIMATOR_ALPHA * gap
+                                   + (1.0f - ESTIMATOR_ALPHA) * est->dispatch_interval;
+        }
+    }
+
+    if (still_waiting > 0) {
+        est->riders_per_cycle = ESTIMATOR_ALPHA * (float)riders
+                              + (1.0f - ESTIMATOR_ALPHA) * est->riders_per_cycle;
+    }
+
+    est->last_dispatch = now;
+    est->samples++;
+}
+
+/* Predicted wait for the visitor at 1-based queue position (0 = front of line) */
+int predictWaitForPosition(const ThroughputEstimate* est, int position) {
+    if (!est || position <= 0) return 0;
+
+    float riders = est->riders_per_cycle >= 1.0f ? est->riders_per_cycle : 1.0f;
+    float cycles = ceilf((float)position / riders);
+    return (int)lroundf(cycles * est->dispatch_interval / 60.0f);
+}
+
+/* Prediction for a ride with no observed history */
+int predictDefaultWait(int queue_size, int ride_capacity) {
+    if (ride_capacity <= 0) return 0;
+
+    ThroughputEstimate est;
+    initThroughputEstimate(&est, ride_capacity, DEFAULT_CYCLE_SECONDS);
+    return predictWaitForPosition(&est, queue_size);
+}
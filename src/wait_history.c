@@ -0,0 +1,134 @@
+/* Per-Ride Wait-Time History (ring of minute buckets with histograms) */
+#include <stdio.h>
+#include <stdlib.h>
+#include "../include/wait_history.h"
+
+/* Lower edge of each histogram bin in minutes (last bin is open-ended) */
+static const int bin_edges[WAIT_HISTOGRAM_BINS] = {
+    0, 1, 2, 3, 5, 7, 10, 15, 20, 30, 45, 60, 90, 120, 180, 240
+};
+
+/* Find histogram bin for a wait value */
+static int findWaitBin(int wait_minutes) {
+    int bin = 0;
+    while (bin + 1 < WAIT_HISTOGRAM_BINS && wait_minutes >= bin_edges[bin + 1]) {
+        bin++;
+    }
+    return bin;
+}
+
+/* Ring slot of a minute; non-negative for any minute */
+static int bucketIndex(long minute) {
+    return (int)(((minute % WAIT_HISTORY_MINUTES) + WAIT_HISTORY_MINUTES) % WAIT_HISTORY_MINUTES);
+}
+
+/* Create empty history */
+WaitHistory* createWaitHistory(void) {
+    WaitHistory* history = (WaitHistory*)calloc(1, sizeof(WaitHistory));
+    if (!history) {
+        fprintf(stderr, "Error: Memory allocation failed for wait history\n");
+        return NULL;
+    }
+
+    for (int i = 0; i < WAIT_HISTORY_MINUTES; i++) {
+        history->buckets[i].minute = -1;
+    }
+
+    return history;
+}
+
+/* Free history */
+void freeWaitHistory(WaitHistory* history) {
+    if (history) {
+        free(history);
+    }
+}
+
+/* Record one wait sample - O(1) */
+void recordWaitSample(WaitHistory* history, time_t when, int wait_minutes) {
+    if (!history) return;
+    if (wait_minutes < 0) wait_minutes = 0;
+
+    long minute = (long)(when / 60);
+    WaitBucket* bucket = &history->buckets[bucketIndex(minute)];
+
+    // Bucket still holds an older minute from the previous lap: recycle it
+    if (bucket->minute != minute) {
+        bucket->minute = minute;
+        bucket->sum = 0;
+        bucket->count = 0;
+        bucket->max_wait = 0;
+        for (int i = 0; i < WAIT_HISTOGRAM_BINS; i++) {
+            bucket->bins[i] = 0;
+        }
+    }
+
+    if (bucket->count == 0xFFFF) return;  // Saturated for this minute
+
+    bucket->count++;
+    bucket->sum += wait_minutes;
+    if (wait_minutes > bucket->max_wait) {
+        bucket->max_wait = wait_minutes > 0xFFFF ? 0xFFFF : (unsigned short)wait_minutes;
+    }
+    bucket->bins[findWaitBin(wait_minutes)]++;
+}
+
+/* Summarize samples in [from, to] and estimate quantile q (0-1).
+ * Returns number of samples found. */
+int queryWaitHistory(WaitHistory* history, time_t from, time_t to, float q, WaitSummary* out) {
+    if (!out) return 0;
+
+    out->samples = 0;
+    out->average_wait = 0.0f;
+    out->quantile_wait = 0.0f;
+
+    if (!history || to < from) return 0;
+    if (q < 0.0f) q = 0.0f;
+    if (q > 1.0f) q = 1.0f;
+
+    long to_minute = (long)(to / 60);
+    long from_minute = (long)(from / 60);
+    if (to_minute - from_minute >= WAIT_HISTORY_MINUTES) {
+        from_minute = to_minute - WAIT_HISTORY_MINUTES + 1;  // Older data is gone
+    }
+
+    long total = 0;
+    long sum = 0;
+    int max_wait = 0;
+    long bins[WAIT_HISTOGRAM_BINS] = {0};
+
+    for (long minute = from_minute; minute <= to_minute; minute++) {
+        WaitBucket* bucket = &history->buckets[bucketIndex(minute)];
+        if (bucket->minute != minute || bucket->count == 0) continue;
+
+        total += bucket->count;
+        sum += bucket->sum;
+        if (bucket->max_wait > max_wait) max_wait = bucket->max_wait;
+        for (int i = 0; i < WAIT_HISTOGRAM_BINS; i++) {
+            bins[i] += bucket->bins[i];
+        }
+    }
+
+    if (total == 0) return 0;
+
+    // Walk the merged histogram to the bin holding rank q, interpolate inside it
+    float rank = q * (float)total;
+    long seen = 0;
+    int bin = 0;
+    while (bin < WAIT_HISTOGRAM_BINS - 1 && seen + bins[bin] < rank) {
+        seen += bins[bin];
+        bin++;
+    }
+
+    float low = (float)bin_edges[bin];
+    float high = (bin + 1 < WAIT_HISTOGRAM_BINS) ? (float)bin_edges[bin + 1] : (float)max_wait;
+    if (high > max_wait + 1) high = (float)(max_wait + 1);  // Don't interpolate past the data
+    float fraction = bins[bin] > 0 ? (rank - seen) / (float)bins[bin] : 0.0f;
+    if (high - low <= 1.0f) fraction = 0.0f;  // Single-value bin is exact
+
+    out->samples = (int)total;
+    out->average_wait = (float)sum / (float)total;
+    out->quantile_wait = low + (high - low) * fraction;
+
+    return out->samples;
+}
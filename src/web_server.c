@@ -7,39 +7,109 @@
 #include "../include/utils.h"
 #include "../include/priority_queue.h"
 #include "../include/stack.h"
+#include "../include/file_io.h"
+#include "../include/gate_ingest.h"
+#include "../include/park_stats.h"
+#include "../include/metrics.h"
+#include "../include/trace.h"
+#include "../include/response_cache.h"
+#include "../include/rate_limiter.h"
+#include "../include/ride_simulator.h"
+#include "../include/visitor_exit.h"
+#include "../include/group_registry.h"
+#ifdef PARK_EMBEDDED_WEB
+#include "../include/web_assets.h"
+#endif
 
 /* Function declarations from web_server_handlers.c */
 void handleGetVisitorHistory(struct mg_connection *c, struct mg_http_message *hm);
 void handleGetRideSuggestions(struct mg_connection *c, struct mg_http_message *hm);
+void handleGetTimeToRide(struct mg_connection *c, struct mg_http_message *hm);
 void handleUndoLastRide(struct mg_connection *c, struct mg_http_message *hm);
 void handleGetRidesByWaitTime(struct mg_connection *c);
+void handleGetCrowdBalance(struct mg_connection *c);
 void handleFindPath(struct mg_connection *c, struct mg_http_message *hm);
+void handleGetNearbyRides(struct mg_connection *c, struct mg_http_message *hm);
+void handleGetWaitHistory(struct mg_connection *c, struct mg_http_message *hm);
+void handleGetQueueStatus(struct mg_connection *c, struct mg_http_message *hm);
+void handleVisitorExit(struct mg_connection *c, struct mg_http_message *hm);
+void handleJoinQueue(struct mg_connection *c, struct mg_http_message *hm);
+void handleReservation(struct mg_connection *c, struct mg_http_message *hm);
+void handleRedeemReservation(struct mg_connection *c, struct mg_http_message *hm);
+void handleGetReturnTimes(struct mg_connection *c, struct mg_http_message *hm);
 
 /* Global references to park data */
 RideList* g_rides = NULL;
-VisitorGroup** g_groups = NULL;
-int* g_group_count = NULL;
 DualQueue** g_queues = NULL;
 BST* g_bst = NULL;
 Graph* g_park_map = NULL;
 static struct mg_mgr mgr;
 static int server_running = 0;
 
+/* Route labels for metrics, matched in order (mongoose '*' stops at '/') */
+typedef struct RouteMetric {
+    const char* pattern;
+    int latency_id;     // Request duration histogram
+    int bytes_id;       // Response bytes counter
+} RouteMetric;
+
+static RouteMetric route_metrics[] = {
+    {"/api/visitors", -1, -1},
+    {"/api/visitors/bulk", -1, -1},
+    {"/api/visitors/*/queue-status", -1, -1},
+    {"/api/visitors/*/queue", -1, -1},
+    {"/api/visitors/*/exit", -1, -1},
+    {"/api/visitors/*/history", -1, -1},
+    {"/api/visitors/*/suggest", -1, -1},
+    {"/api/visitors/*/time-to-ride", -1, -1},
+    {"/api/visitors/*/undo", -1, -1},
+    {"/api/visitors/*/reservation", -1, -1},
+    {"/api/visitors/*/reservation/redeem", -1, -1},
+    {"/api/visitors/*", -1, -1},
+    {"/api/rides", -1, -1},
+    {"/api/rides/by-wait-time", -1, -1},
+    {"/api/rides/nearby", -1, -1},
+    {"/api/rides/*/wait-history", -1, -1},
+    {"/api/rides/*/return-times", -1, -1},
+    {"/api/rides/*/experience", -1, -1},
+    {"/api/rides/*", -1, -1},
+    {"/api/queues", -1, -1},
+    {"/api/stats", -1, -1},
+    {"/api/crowd/balance", -1, -1},
+    {"/api/pathfind", -1, -1},
+    {"/metrics", -1, -1},
+    {"/debug/trace", -1, -1},
+    {"#", -1, -1}               // Static files and unknown paths
+};
+#define ROUTE_METRIC_COUNT ((int)(sizeof(route_metrics) / sizeof(route_metrics[0])))
+
+/* Admission control: checked before routing, so a client in a tight loop
+ * costs one table probe per request instead of a handler run */
+static RateLimiter rate_limiter;
+static int open_connections = 0;
+static int rate_limited_id = -1;
+static int overloaded_id = -1;
+static int open_connections_id = -1;
+
 /* Helper function to create JSON response */
 void sendJSON(struct mg_connection *c, int status, const char *json) {
+    TRACE_SPAN("sendJSON");
     mg_http_reply(c, status, "Content-Type: application/json\r\n", "%s", json);
 }
 
 /* Helper to build visitor JSON */
 static void buildVisitorJSON(char *buffer, size_t size, Visitor *v) {
+    VisitorGroup *group = findVisitorGroup(v->id);
+    int group_id = group ? group->group_id : -1;
     snprintf(buffer, size,
         "{\"id\":%d,\"name\":\"%s\",\"current_location\":%d,"
         "\"thrill_preference\":%d,\"rides_completed\":%d,"
         "\"total_distance_traveled\":%d,\"satisfaction_score\":%.2f,"
-        "\"ticket_type\":%d,\"fast_passes_remaining\":%d,\"entry_time\":%d}",
+        "\"ticket_type\":%d,\"fast_passes_remaining\":%d,\"entry_time\":%d,\"idle\":%d,"
+        "\"group_id\":%d}",
         v->id, v->name, v->current_location, v->thrill_preference,
         v->rides_completed, v->total_distance_traveled, v->satisfaction_score,
-        v->ticket_type, v->fast_passes_remaining, v->entry_time);
+        v->ticket_type, v->fast_passes_remaining, v->entry_time, v->is_idle, group_id);
 }
 
 /* Helper to build ride JSON */
@@ -50,37 +120,68 @@ void buildRideJSON(char *buffer, size_t size, Ride *r) {
         "\"wait_time\":%d,\"queue_size\":%d}",
         r->id, r->name, r->thrill_level, r->capacity, r->is_operational,
         r->current_wait_time, 
-        g_queues[r->id] ? (g_queues[r->id]->regular_queue->size + g_queues[r->id]->fastpass_queue->size) : 0);
+        r->id < MAX_RIDES ? getTotalQueueSize(g_queues[r->id]) : 0);
 }
 
-/* GET /api/visitors - Get all visitors */
-static void handleGetVisitors(struct mg_connection *c) {
-    char response[8192] = "[";
-    int first = 1;
+/* GET /api/visitors?offset=&limit= - One page of visitors in registry order.
+ * The body stays a JSON array; X-Total-Count carries the park total. */
+static void handleGetVisitors(struct mg_connection *c, struct mg_http_message *hm) {
+    TRACE_SPAN("handleGetVisitors");
+    char value[16];
+    int offset = 0, limit = VISITOR_PAGE_DEFAULT;
+    if (mg_http_get_var(&hm->query, "offset", value, sizeof(value)) > 0) offset = atoi(value);
+    if (mg_http_get_var(&hm->query, "limit", value, sizeof(value)) > 0) limit = atoi(value);
+    if (offset < 0 || limit < 0 || limit > VISITOR_PAGE_MAX) {
+        char error[96];
+        snprintf(error, sizeof(error),
+            "{\"error\":\"offset must be >= 0 and limit 0-%d\"}", VISITOR_PAGE_MAX);
+        sendJSON(c, 400, error);
+        return;
+    }
     
-    for (int i = 0; i < *g_group_count; i++) {
-        VisitorNode *node = g_groups[i]->head;
-        while (node) {
-            if (!first) strcat(response, ",");
-            first = 0;
-            
+    StringBuffer out = {NULL, 0, 0};
+    int ok = stringBufferAppend(&out, "[");
+    int skipped = 0, listed = 0;
+    
+    // Whole groups before the page are skipped by size
+    VisitorGroup **groups = getGroups();
+    for (int i = 0; ok && i < getGroupCount() && listed < limit; i++) {
+        if (skipped + groups[i]->size <= offset) {
+            skipped += groups[i]->size;
+            continue;
+        }
+        for (VisitorNode *node = groups[i]->head; ok && node && listed < limit; node = node->next) {
+            if (skipped < offset) {
+                skipped++;
+                continue;
+            }
             char visitor_json[512];
             buildVisitorJSON(visitor_json, sizeof(visitor_json), node->visitor);
-            strcat(response, visitor_json);
-            
-            node = node->next;
+            ok = stringBufferAppend(&out, "%s%s", listed > 0 ? "," : "", visitor_json);
+            listed++;
         }
     }
-    
-    strcat(response, "]");
-    sendJSON(c, 200, response);
+    ok = ok && stringBufferAppend(&out, "]");
+    
+    if (ok) {
+        char headers[160];
+        snprintf(headers, sizeof(headers),
+            "Content-Type: application/json\r\n"
+            "Access-Control-Expose-Headers: X-Total-Count\r\n"
+            "X-Total-Count: %d\r\n", getParkStats()->total_visitors);
+        mg_http_reply(c, 200, headers, "%s", out.data);
+    } else {
+        sendJSON(c, 500, "{\"error\":\"Failed to list visitors\"}");
+    }
+    freeStringBuffer(&out);
 }
 
 /* POST /api/visitors - Add new visitor */
 static void handleAddVisitor(struct mg_connection *c, struct mg_http_message *hm) {
+    TRACE_SPAN("handleAddVisitor");
     char name[MAX_NAME_LENGTH] = "";
     int thrill = 5, ticket_type = 0;
-    double thrill_d = 5, ticket_d = 0;
+    double thrill_d = 5, ticket_d = 0, group_d = 0;
     
     char *str = mg_json_get_str(hm->body, "$.name");
     if (str) {
@@ -100,8 +201,19 @@ static void handleAddVisitor(struct mg_connection *c, struct mg_http_message *hm
         return;
     }
     
+    // Join the party given by group_id, otherwise arrive as a new party
+    VisitorGroup *group = NULL;
+    int join = mg_json_get_num(hm->body, "$.group_id", &group_d);
+    if (join) {
+        group = findGroupById((int)group_d);
+        if (!group) {
+            sendJSON(c, 404, "{\"error\":\"Group not found\"}");
+            return;
+        }
+    }
+    
     // Create visitor with generated ID
-    int new_id = generateVisitorID();  // Uses the counter starting from 1000
+    int new_id = generateVisitorID();  // Uses the counter starting from FIRST_VISITOR_ID
     Visitor *visitor = createVisitorWithTicket(new_id, name, thrill, ticket_type);
     
     if (!visitor) {
@@ -109,42 +221,171 @@ static void handleAddVisitor(struct mg_connection *c, struct mg_http_message *hm
         return;
     }
     
-    // Add to first group or create new group
-    if (*g_group_count == 0) {
-        g_groups[0] = createVisitorGroup(0);
-        (*g_group_count)++;
+    if (!group) group = createRegisteredGroup();
+    if (!group) {
+        freeVisitor(visitor);
+        sendJSON(c, 500, "{\"error\":\"Failed to create visitor group\"}");
+        return;
     }
     
-    addVisitorToGroup(g_groups[0], visitor);
+    addVisitorToGroup(group, visitor);
     
     char response[512];
     buildVisitorJSON(response, sizeof(response), visitor);
     sendJSON(c, 201, response);
 }
 
+/* Parse one JSON manifest row into a gate event */
+static int parseBulkJSONRow(struct mg_str row, GateEvent *event) {
+    double thrill_d = 5, ticket_d = 0;
+    char *str = mg_json_get_str(row, "$.name");
+    if (!str) return 0;
+    
+    strncpy(event->name, str, MAX_NAME_LENGTH - 1);
+    event->name[MAX_NAME_LENGTH - 1] = '\0';
+    free(str);
+    
+    mg_json_get_num(row, "$.thrill_preference", &thrill_d);
+    mg_json_get_num(row, "$.ticket_type", &ticket_d);
+    event->thrill_preference = (int)thrill_d;
+    event->ticket_type = ((int)ticket_d == TICKET_PREMIUM) ? TICKET_PREMIUM : TICKET_NORMAL;
+    
+    return strlen(event->name) > 0 &&
+           validateInput(event->thrill_preference, MIN_THRILL_LEVEL, MAX_THRILL_LEVEL);
+}
+
+/* POST /api/visitors/bulk - Import a manifest (JSON array or CSV) */
+static void handleBulkAddVisitors(struct mg_connection *c, struct mg_http_message *hm) {
+    TRACE_SPAN("handleBulkAddVisitors");
+    struct mg_str body = hm->body;
+    while (body.len > 0 && (*body.buf == ' ' || *body.buf == '\t' ||
+                            *body.buf == '\r' || *body.buf == '\n')) {
+        body.buf++, body.len--;
+    }
+    
+    char content_type[64] = "";
+    struct mg_str *ct = mg_http_get_header(hm, "Content-Type");
+    if (ct) {
+        snprintf(content_type, sizeof(content_type), "%.*s", (int)ct->len, ct->buf);
+    }
+    int is_json = body.len > 0 && *body.buf == '[' && !strstr(content_type, "csv");
+    
+    // Pass 1: count rows so storage is sized once
+    int row_count = 0;
+    struct mg_str val;
+    if (is_json) {
+        size_t ofs = 0;
+        while ((ofs = mg_json_next(body, ofs, NULL, &val)) > 0) row_count++;
+    } else {
+        for (size_t i = 0; i < body.len; i++) {
+            if (body.buf[i] == '\n') row_count++;
+        }
+        if (body.len > 0 && body.buf[body.len - 1] != '\n') row_count++;
+    }
+    
+    if (row_count == 0) {
+        sendJSON(c, 400, "{\"error\":\"Empty manifest\"}");
+        return;
+    }
+    
+    GateEvent *rows = (GateEvent*)malloc(sizeof(GateEvent) * row_count);
+    Visitor **visitors = (Visitor**)malloc(sizeof(Visitor*) * row_count);
+    if (!rows || !visitors) {
+        free(rows);
+        free(visitors);
+        sendJSON(c, 500, "{\"error\":\"Failed to allocate manifest\"}");
+        return;
+    }
+    
+    // Pass 2: parse and validate every row
+    int valid = 0, rejected = 0;
+    if (is_json) {
+        size_t ofs = 0;
+        while ((ofs = mg_json_next(body, ofs, NULL, &val)) > 0) {
+            if (parseBulkJSONRow(val, &rows[valid])) valid++;
+            else rejected++;
+        }
+    } else {
+        size_t start = 0;
+        while (start < body.len) {
+            size_t end = start;
+            while (end < body.len && body.buf[end] != '\n') end++;
+            
+            char line[256];
+            size_t len = end - start < sizeof(line) - 1 ? end - start : sizeof(line) - 1;
+            memcpy(line, body.buf + start, len);
+            line[len] = '\0';
+            start = end + 1;
+            
+            if (strstr(line, "thrill_preference") || trimWhitespace(line)[0] == '\0') continue;
+            if (parseGateEvent(line, &rows[valid])) valid++;
+            else rejected++;
+        }
+    }
+    
+    // Create all visitors from one reserved ID range
+    int first_id = reserveVisitorIDs(valid);
+    int imported = 0;
+    for (int i = 0; i < valid; i++) {
+        Visitor *visitor = createVisitorWithTicket(first_id + i, rows[i].name,
+                                                   rows[i].thrill_preference,
+                                                   (TicketType)rows[i].ticket_type);
+        if (visitor) visitors[imported++] = visitor;
+        else rejected++;
+    }
+    
+    // The manifest arrives as one party in its own group
+    VisitorGroup *group = imported > 0 ? createRegisteredGroup() : NULL;
+    if (group) {
+        appendVisitorsToGroup(group, visitors, imported);
+    } else {
+        for (int i = 0; i < imported; i++) freeVisitor(visitors[i]);
+        rejected += imported;
+        imported = 0;
+    }
+    
+    free(rows);
+    free(visitors);
+    
+    char response[256];
+    snprintf(response, sizeof(response),
+        "{\"imported\":%d,\"rejected\":%d,\"first_id\":%d,\"last_id\":%d,\"group_id\":%d}",
+        imported, rejected, first_id, imported > 0 ? first_id + valid - 1 : first_id,
+        group ? group->group_id : -1);
+    sendJSON(c, imported > 0 ? 201 : 400, response);
+}
+
 /* GET /api/rides - Get all rides */
 static void handleGetRides(struct mg_connection *c) {
-    char response[8192] = "[";
-    int first = 1;
+    TRACE_SPAN("handleGetRides");
+    const char *cached = getCachedResponse(CACHE_RIDES_LIST, NULL);
+    if (cached) {
+        sendJSON(c, 200, cached);
+        return;
+    }
     
-    RideNode *node = g_rides->head;
-    while (node) {
-        if (!first) strcat(response, ",");
-        first = 0;
-        
+    StringBuffer out = {NULL, 0, 0};
+    int ok = stringBufferAppend(&out, "[");
+    
+    for (RideNode *node = g_rides->head; ok && node; node = node->next) {
         char ride_json[512];
         buildRideJSON(ride_json, sizeof(ride_json), node->ride);
-        strcat(response, ride_json);
-        
-        node = node->next;
+        ok = stringBufferAppend(&out, "%s%s", node == g_rides->head ? "" : ",", ride_json);
     }
+    ok = ok && stringBufferAppend(&out, "]");
     
-    strcat(response, "]");
-    sendJSON(c, 200, response);
+    if (ok) {
+        storeCachedResponse(CACHE_RIDES_LIST, DATA_MASK(DATA_RIDES) | DATA_MASK(DATA_QUEUES), out.data);
+        sendJSON(c, 200, out.data);
+    } else {
+        sendJSON(c, 500, "{\"error\":\"Failed to list rides\"}");
+    }
+    freeStringBuffer(&out);
 }
 
 /* POST /api/rides - Add new ride */
 static void handleAddRide(struct mg_connection *c, struct mg_http_message *hm) {
+    TRACE_SPAN("handleAddRide");
     char name[MAX_NAME_LENGTH] = "";
     int thrill = 5, capacity = 20, duration = 5;
     double thrill_d = 5, capacity_d = 20, duration_d = 5;
@@ -175,8 +416,8 @@ static void handleAddRide(struct mg_connection *c, struct mg_http_message *hm) {
     // Create queue for ride
     if (ride->id < MAX_RIDES) {
         g_queues[ride->id] = createDualQueue(ride->id, 4);
-        // Initialize wait time based on queue size and capacity
-        ride->current_wait_time = calculateEstimatedWaitTime(0, ride->capacity);
+        // Initialize wait time from the ride's (still empty) queue
+        updateRideWaitTime(ride, 0);
     }
     
     char response[512];
@@ -186,70 +427,58 @@ static void handleAddRide(struct mg_connection *c, struct mg_http_message *hm) {
 
 /* GET /api/queues - Get queue status */
 static void handleGetQueues(struct mg_connection *c) {
-    char response[8192] = "[";
+    TRACE_SPAN("handleGetQueues");
+    const char *cached = getCachedResponse(CACHE_QUEUES, NULL);
+    if (cached) {
+        sendJSON(c, 200, cached);
+        return;
+    }
+    
+    StringBuffer out = {NULL, 0, 0};
+    int ok = stringBufferAppend(&out, "[");
     int first = 1;
     
-    RideNode *node = g_rides->head;
-    while (node) {
+    for (RideNode *node = g_rides->head; ok && node; node = node->next) {
         Ride *ride = node->ride;
-        DualQueue *queue = g_queues[ride->id];
-        
-        if (queue) {
-            if (!first) strcat(response, ",");
-            first = 0;
-            
-            char queue_json[512];
-            snprintf(queue_json, sizeof(queue_json),
-                "{\"ride_id\":%d,\"ride_name\":\"%s\",\"size\":%d,"
-                "\"capacity\":%d,\"wait_time\":%d,\"premium_size\":%d,\"is_operational\":%d}",
-                ride->id, ride->name,
-                queue->regular_queue->size + queue->fastpass_queue->size,
-                ride->capacity, ride->current_wait_time,
-                queue->fastpass_queue->size, ride->is_operational);
-            strcat(response, queue_json);
-        }
+        DualQueue *queue = ride->id < MAX_RIDES ? g_queues[ride->id] : NULL;
+        if (!queue) continue;
         
-        node = node->next;
+        ok = stringBufferAppend(&out,
+            "%s{\"ride_id\":%d,\"ride_name\":\"%s\",\"size\":%d,"
+            "\"capacity\":%d,\"wait_time\":%d,\"premium_size\":%d,\"single_rider_size\":%d,"
+            "\"is_operational\":%d}",
+            first ? "" : ",", ride->id, ride->name, getTotalQueueSize(queue),
+            ride->capacity, ride->current_wait_time,
+            queue->fastpass_queue->size, queue->single_rider_queue->size, ride->is_operational);
+        first = 0;
     }
+    ok = ok && stringBufferAppend(&out, "]");
     
-    strcat(response, "]");
-    sendJSON(c, 200, response);
+    if (ok) {
+        storeCachedResponse(CACHE_QUEUES, DATA_MASK(DATA_RIDES) | DATA_MASK(DATA_QUEUES), out.data);
+        sendJSON(c, 200, out.data);
+    } else {
+        sendJSON(c, 500, "{\"error\":\"Failed to list queues\"}");
+    }
+    freeStringBuffer(&out);
 }
 
 /* DELETE /api/visitors/:id - Delete visitor */
 static void handleDeleteVisitor(struct mg_connection *c, struct mg_http_message *hm) {
+    TRACE_SPAN("handleDeleteVisitor");
     // Parse visitor ID from URI (e.g., /api/visitors/1001)
     int visitor_id = 0;
     sscanf(hm->uri.buf, "/api/visitors/%d", &visitor_id);
     
-    if (visitor_id < 1000) {
+    if (visitor_id < FIRST_VISITOR_ID) {
         sendJSON(c, 400, "{\"error\":\"Invalid visitor ID\"}");
         return;
     }
     
-    // Find and remove visitor
-    for (int i = 0; i < *g_group_count; i++) {
-        if (g_groups[i]) {
-            VisitorNode *current = g_groups[i]->head;
-            VisitorNode *prev = NULL;
-            
-            while (current) {
-                if (current->visitor->id == visitor_id) {
-                    if (prev) {
-                        prev->next = current->next;
-                    } else {
-                        g_groups[i]->head = current->next;
-                    }
-                    g_groups[i]->size--;
-                    free(current->visitor);
-                    free(current);
-                    sendJSON(c, 200, "{\"message\":\"Visitor deleted\"}");
-                    return;
-                }
-                prev = current;
-                current = current->next;
-            }
-        }
+    // Out of every queue and index, history archived, memory freed
+    if (exitVisitor(visitor_id, EXIT_OPERATOR)) {
+        sendJSON(c, 200, "{\"message\":\"Visitor deleted\"}");
+        return;
     }
     
     sendJSON(c, 404, "{\"error\":\"Visitor not found\"}");
@@ -257,6 +486,7 @@ static void handleDeleteVisitor(struct mg_connection *c, struct mg_http_message
 
 /* DELETE /api/rides/:id - Delete ride */
 static void handleDeleteRide(struct mg_connection *c, struct mg_http_message *hm) {
+    TRACE_SPAN("handleDeleteRide");
     int ride_id = 0;
     sscanf(hm->uri.buf, "/api/rides/%d", &ride_id);
     
@@ -272,6 +502,7 @@ static void handleDeleteRide(struct mg_connection *c, struct mg_http_message *hm
 
 /* PUT /api/rides/:id/toggle - Toggle ride status */
 static void handleToggleRide(struct mg_connection *c, struct mg_http_message *hm) {
+    TRACE_SPAN("handleToggleRide");
     int ride_id = 0;
     sscanf(hm->uri.buf, "/api/rides/%d/toggle", &ride_id);
     
@@ -281,7 +512,12 @@ static void handleToggleRide(struct mg_connection *c, struct mg_http_message *hm
         return;
     }
     
-    ride->is_operational = !ride->is_operational;
+    if (ride->is_operational) {
+        markRideClosed(ride);
+    } else {
+        markRideOpen(ride);
+        wakeRide(ride);
+    }
     
     char response[256];
     snprintf(response, sizeof(response),
@@ -292,6 +528,7 @@ static void handleToggleRide(struct mg_connection *c, struct mg_http_message *hm
 
 /* POST /api/rides/:id/experience - Visitor enjoys ride */
 static void handleExperienceRide(struct mg_connection *c, struct mg_http_message *hm) {
+    TRACE_SPAN("handleExperienceRide");
     int ride_id = 0;
     sscanf(hm->uri.buf, "/api/rides/%d/experience", &ride_id);
     
@@ -313,26 +550,13 @@ static void handleExperienceRide(struct mg_connection *c, struct mg_http_message
         visitor_id = (int)visitor_id_d;
     }
     
-    if (visitor_id < 1000) {
+    if (visitor_id < FIRST_VISITOR_ID) {
         sendJSON(c, 400, "{\"error\":\"Invalid visitor ID\"}");
         return;
     }
     
     // Find visitor
-    Visitor *visitor = NULL;
-    for (int i = 0; i < *g_group_count; i++) {
-        if (g_groups[i]) {
-            VisitorNode *node = g_groups[i]->head;
-            while (node) {
-                if (node->visitor->id == visitor_id) {
-                    visitor = node->visitor;
-                    break;
-                }
-                node = node->next;
-            }
-            if (visitor) break;
-        }
-    }
+    Visitor *visitor = findVisitorById(visitor_id);
     
     if (!visitor) {
         sendJSON(c, 404, "{\"error\":\"Visitor not found\"}");
@@ -351,7 +575,7 @@ static void handleExperienceRide(struct mg_connection *c, struct mg_http_message
     incrementVisitorCount(ride, 1);
     
     // Update visitor info
-    visitor->satisfaction_score = satisfaction;
+    setVisitorSatisfaction(visitor, satisfaction);
     
     char response[512];
     snprintf(response, sizeof(response),
@@ -362,146 +586,389 @@ static void handleExperienceRide(struct mg_connection *c, struct mg_http_message
 
 /* GET /api/stats - Get park statistics */
 static void handleGetStats(struct mg_connection *c) {
-    int total_visitors = 0;
-    int premium_visitors = 0;
-    float total_satisfaction = 0;
-    int total_distance = 0;
-    int active_rides = 0;
-    int total_capacity = 0;
-    int total_wait_time = 0;
-    int ride_count = 0;
-    
-    // Count visitors
-    for (int i = 0; i < *g_group_count; i++) {
-        VisitorNode *node = g_groups[i]->head;
-        while (node) {
-            total_visitors++;
-            if (node->visitor->ticket_type == TICKET_PREMIUM) {
-                premium_visitors++;
-            }
-            total_satisfaction += node->visitor->satisfaction_score;
-            total_distance += node->visitor->total_distance_traveled;
-            node = node->next;
-        }
+    TRACE_SPAN("handleGetStats");
+    // Running aggregates are kept current by every mutation path - O(1)
+    const ParkStats *stats = getParkStats();
+    
+#ifdef PARK_STATS_DEBUG
+    verifyParkStats(g_rides, getGroups(), getGroupCount());
+#endif
+    
+    // Park fields are cached until a ride or visitor changes; cache counters are always live
+    char fields[1024];
+    const char *cached = getCachedResponse(CACHE_STATS, NULL);
+    if (!cached) {
+        float avg_satisfaction = stats->total_visitors > 0
+            ? (float)(stats->satisfaction_sum / stats->total_visitors) : 0;
+        int avg_wait_time = stats->total_rides > 0
+            ? (int)(stats->total_wait_time / stats->total_rides) : 0;
+        
+        snprintf(fields, sizeof(fields),
+            "\"total_visitors\":%d,\"premium_visitors\":%d,"
+            "\"avg_satisfaction\":%.2f,\"total_distance\":%ld,"
+            "\"total_rides\":%d,\"active_rides\":%d,"
+            "\"avg_wait_time\":%d,\"total_capacity\":%ld,\"idle_visitors\":%d",
+            stats->total_visitors, stats->premium_visitors, avg_satisfaction, stats->total_distance,
+            stats->total_rides, stats->active_rides, avg_wait_time, stats->total_capacity,
+            stats->idle_visitors);
+        storeCachedResponse(CACHE_STATS, DATA_MASK(DATA_RIDES) | DATA_MASK(DATA_VISITORS), fields);
+        cached = fields;
     }
     
-    // Count rides
-    RideNode *node = g_rides->head;
-    while (node) {
-        ride_count++;
-        if (node->ride->is_operational) {
-            active_rides++;
-        }
-        total_capacity += node->ride->capacity;
-        total_wait_time += node->ride->current_wait_time;
-        node = node->next;
-    }
+    char response[1280];
+    snprintf(response, sizeof(response),
+        "{%s,\"cache_hit_ratio\":%.3f,\"cache_hits\":%ld,\"cache_misses\":%ld}",
+        cached, getCacheHitRatio(), getCacheHits(), getCacheMisses());
     
-    float avg_satisfaction = total_visitors > 0 ? total_satisfaction / total_visitors : 0;
-    int avg_wait_time = ride_count > 0 ? total_wait_time / ride_count : 0;
+    sendJSON(c, 200, response);
+}
+
+/* GET /metrics - Prometheus text exposition */
+static void handleGetMetrics(struct mg_connection *c) {
+    TRACE_SPAN("handleGetMetrics");
+    StringBuffer out = {NULL, 0, 0};
+    int ok = renderMetrics(&out);
+    
+    // Queue lengths are read at scrape time rather than mirrored on every enqueue
+    ok = ok && stringBufferAppend(&out, "# HELP park_ride_queue_length Visitors waiting per ride and lane\n"
+                                        "# TYPE park_ride_queue_length gauge\n");
+    for (RideNode *node = g_rides ? g_rides->head : NULL; ok && node; node = node->next) {
+        DualQueue *queue = g_queues[node->ride->id];
+        if (!queue) continue;
+        ok = stringBufferAppend(&out, "park_ride_queue_length{ride=\"%d\",lane=\"regular\"} %d\n"
+                                      "park_ride_queue_length{ride=\"%d\",lane=\"fastpass\"} %d\n"
+                                      "park_ride_queue_length{ride=\"%d\",lane=\"single_rider\"} %d\n",
+                                node->ride->id, queue->regular_queue->size,
+                                node->ride->id, queue->fastpass_queue->size,
+                                node->ride->id, queue->single_rider_queue->size);
+    }
     
-    char response[1024];
-    snprintf(response, sizeof(response),
-        "{\"total_visitors\":%d,\"premium_visitors\":%d,"
-        "\"avg_satisfaction\":%.2f,\"total_distance\":%d,"
-        "\"total_rides\":%d,\"active_rides\":%d,"
-        "\"avg_wait_time\":%d,\"total_capacity\":%d}",
-        total_visitors, premium_visitors, avg_satisfaction, total_distance,
-        ride_count, active_rides, avg_wait_time, total_capacity);
+    if (ok) {
+        mg_http_reply(c, 200, "Content-Type: text/plain; version=0.0.4\r\n", "%s", out.data);
+    } else {
+        mg_http_reply(c, 500, "Content-Type: text/plain\r\n", "metrics unavailable\n");
+    }
+    freeStringBuffer(&out);
+}
+
+/* GET /debug/trace - Chrome trace-event JSON of recent spans (read-only) */
+static void handleGetTrace(struct mg_connection *c) {
+    StringBuffer out = {NULL, 0, 0};
+    if (renderChromeTrace(&out)) {
+        mg_http_reply(c, 200, "Content-Type: application/json\r\n", "%s", out.data);
+    } else {
+        sendJSON(c, 500, "{\"error\":\"Failed to render trace\"}");
+    }
+    freeStringBuffer(&out);
+}
+
+/* POST /debug/trace - ?enable=1 / ?enable=0 switch recording, ?clear=1 drops
+ * what is buffered. Kept off GET so a crawler or prefetch cannot flip it. */
+static void handleTraceControl(struct mg_connection *c, struct mg_http_message *hm) {
+    char value[8];
+    if (mg_http_get_var(&hm->query, "enable", value, sizeof(value)) > 0) {
+        setTraceEnabled(atoi(value));
+    }
+    if (mg_http_get_var(&hm->query, "clear", value, sizeof(value)) > 0 && atoi(value)) {
+        clearTrace();
+    }
     
+    char response[64];
+    snprintf(response, sizeof(response), "{\"enabled\":%s}", isTraceEnabled() ? "true" : "false");
     sendJSON(c, 200, response);
 }
 
-/* HTTP event handler */
-static void httpHandler(struct mg_connection *c, int ev, void *ev_data) {
-    if (ev == MG_EV_HTTP_MSG) {
-        struct mg_http_message *hm = (struct mg_http_message *)ev_data;
+#ifdef PARK_EMBEDDED_WEB
+/* Binary search the packed asset table (sorted by path) */
+static const WebAsset *findWebAsset(struct mg_str path) {
+    int low = 0, high = web_asset_count - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        int cmp = strncmp(web_assets[mid].path, path.buf, path.len);
+        if (cmp == 0) cmp = web_assets[mid].path[path.len] == '\0' ? 0 : 1;
+        if (cmp == 0) return &web_assets[mid];
+        if (cmp < 0) low = mid + 1;
+        else high = mid - 1;
+    }
+    return NULL;
+}
+
+/* Case-sensitive substring test on a header value */
+static int headerContains(const struct mg_str *header, const char *needle) {
+    size_t length = strlen(needle);
+    for (size_t i = 0; header && i + length <= header->len; i++) {
+        if (memcmp(header->buf + i, needle, length) == 0) return 1;
+    }
+    return 0;
+}
+
+/* Serve a file packed into the binary: no disk reads, gzip chosen from the
+ * precompressed variant. Returns 0 when the path is not embedded. */
+static int serveEmbeddedAsset(struct mg_connection *c, struct mg_http_message *hm) {
+    struct mg_str path = hm->uri;
+    if (path.len == 1) path = mg_str("/index.html");
+    
+    const WebAsset *asset = findWebAsset(path);
+    if (!asset) return 0;
+    
+    int use_gzip = asset->gzip_data && headerContains(mg_http_get_header(hm, "Accept-Encoding"), "gzip");
+    const char *etag = use_gzip ? asset->gzip_etag : asset->etag;
+    const char *cache = strncmp(asset->content_type, "text/html", 9) == 0
+        ? WEB_PAGE_CACHE_CONTROL : WEB_ASSET_CACHE_CONTROL;
+    const char *vary = asset->gzip_data ? "Vary: Accept-Encoding\r\n" : "";
+    
+    if (headerContains(mg_http_get_header(hm, "If-None-Match"), etag)) {
+        mg_printf(c, "HTTP/1.1 304 Not Modified\r\nETag: %s\r\nCache-Control: %s\r\n%s"
+                     "Content-Length: 0\r\n\r\n", etag, cache, vary);
+        c->is_resp = 0;  // Response complete: let mongoose parse the next keep-alive request
+        return 1;
+    }
+    
+    size_t size = use_gzip ? asset->gzip_size : asset->size;
+    mg_printf(c, "HTTP/1.1 200 OK\r\nContent-Type: %s\r\nContent-Length: %lu\r\n"
+                 "ETag: %s\r\nCache-Control: %s\r\n%s%s\r\n",
+              asset->content_type, (unsigned long)size, etag, cache, vary,
+              use_gzip ? "Content-Encoding: gzip\r\n" : "");
+    if (mg_strcmp(hm->method, mg_str("HEAD")) != 0) {
+        mg_send(c, use_gzip ? asset->gzip_data : asset->data, size);
+    }
+    c->is_resp = 0;
+    return 1;
+}
+#endif
+
+/* Register per-route latency and byte metrics (once per process) */
+static void registerRouteMetrics(void) {
+    static char labels[ROUTE_METRIC_COUNT][64];
+    if (route_metrics[0].latency_id >= 0) return;
+    
+    for (int i = 0; i < ROUTE_METRIC_COUNT; i++) {
+        const char *route = strcmp(route_metrics[i].pattern, "#") == 0 ? "static" : route_metrics[i].pattern;
+        snprintf(labels[i], sizeof(labels[i]), "route=\"%s\"", route);
+        route_metrics[i].latency_id = registerMetric(METRIC_HISTOGRAM, "park_http_request_duration_seconds",
+                                                     "Time to handle one HTTP request", labels[i]);
+        route_metrics[i].bytes_id = registerMetric(METRIC_COUNTER, "park_http_response_bytes_total",
+                                                   "Response bytes queued by handlers", labels[i]);
+    }
+}
+
+/* Set the per-client limits (PARK_RATE_LIMIT=requests per second, 0 disables) */
+static void initAdmissionControl(void) {
+    double per_second = RATE_LIMIT_PER_SECOND;
+    const char *override = getenv("PARK_RATE_LIMIT");
+    if (override) per_second = atof(override);
+    
+    double burst = per_second * 2 > RATE_LIMIT_BURST ? per_second * 2 : RATE_LIMIT_BURST;
+    initRateLimiter(&rate_limiter, per_second, burst);
+    open_connections = 0;
+    
+    if (rate_limited_id < 0) {
+        rate_limited_id = registerMetric(METRIC_COUNTER, "park_http_rejected_total",
+                                         "Requests refused before routing", "reason=\"rate_limited\"");
+        overloaded_id = registerMetric(METRIC_COUNTER, "park_http_rejected_total",
+                                       "Requests refused before routing", "reason=\"overloaded\"");
+        open_connections_id = registerMetric(METRIC_GAUGE, "park_http_open_connections",
+                                             "Accepted connections not yet closed", "");
+    }
+    
+    if (per_second > 0) {
+        printf("Rate limit: %.0f requests/s per client (burst %.0f), %d connections max\n",
+               per_second, burst, MAX_OPEN_CONNECTIONS);
+    }
+}
+
+/* Count a new connection; past the cap it gets 503 and is closed unread */
+static void admitConnection(struct mg_connection *c) {
+    open_connections++;
+    metricSet(open_connections_id, open_connections);
+    
+    if (open_connections > MAX_OPEN_CONNECTIONS) {
+        metricAdd(overloaded_id, 1);
+        mg_printf(c, "HTTP/1.1 503 Service Unavailable\r\nRetry-After: 1\r\n"
+                     "Connection: close\r\nContent-Length: 0\r\n\r\n");
+        c->is_draining = 1;
+    }
+}
+
+/* Spend one of the client's tokens - 0 (after replying 429) if it has none */
+static int admitRequest(struct mg_connection *c) {
+    if (c->is_draining) return 0;  // Refused at accept, already answered
+    size_t length = c->rem.is_ip6 ? sizeof(c->rem.ip) : sizeof(c->rem.ip4);
+    if (rateLimitAllow(&rate_limiter, c->rem.ip, length, getMonotonicNanos())) return 1;
+    
+    metricAdd(rate_limited_id, 1);
+    mg_http_reply(c, 429, "Content-Type: application/json\r\nRetry-After: 1\r\n",
+                  "{\"error\":\"Too many requests\"}");
+    return 0;
+}
+
+/* Dispatch one HTTP request to its handler */
+static void routeRequest(struct mg_connection *c, struct mg_http_message *hm) {
+    // CORS headers
+    if (mg_strcmp(mg_str_n(hm->uri.buf, 5), mg_str("/api/")) == 0) {
+        mg_printf(c, "HTTP/1.1 200 OK\r\n"
+                    "Access-Control-Allow-Origin: *\r\n"
+                    "Access-Control-Allow-Methods: GET, POST, PUT, DELETE, OPTIONS\r\n"
+                    "Access-Control-Allow-Headers: Content-Type\r\n");
         
-        // CORS headers
-        if (mg_strcmp(mg_str_n(hm->uri.buf, 5), mg_str("/api/")) == 0) {
-            mg_printf(c, "HTTP/1.1 200 OK\r\n"
-                        "Access-Control-Allow-Origin: *\r\n"
-                        "Access-Control-Allow-Methods: GET, POST, PUT, DELETE, OPTIONS\r\n"
-                        "Access-Control-Allow-Headers: Content-Type\r\n");
-            
-            if (mg_strcmp(hm->method, mg_str("OPTIONS")) == 0) {
-                mg_printf(c, "\r\n");
-                return;
-            }
+        if (mg_strcmp(hm->method, mg_str("OPTIONS")) == 0) {
+            mg_printf(c, "\r\n");
+            return;
         }
-        // API Routes
-        if (mg_strcmp(hm->uri, mg_str("/api/visitors")) == 0) {
-            if (mg_strcmp(hm->method, mg_str("GET")) == 0) {
-                handleGetVisitors(c);
-            } else if (mg_strcmp(hm->method, mg_str("POST")) == 0) {
-                handleAddVisitor(c, hm);
-            }
+    }
+    // API Routes
+    if (mg_strcmp(hm->uri, mg_str("/api/visitors")) == 0) {
+        if (mg_strcmp(hm->method, mg_str("GET")) == 0) {
+            handleGetVisitors(c, hm);
+        } else if (mg_strcmp(hm->method, mg_str("POST")) == 0) {
+            handleAddVisitor(c, hm);
         }
-        else if (strncmp(hm->uri.buf, "/api/visitors/", 14) == 0) {
-            if (mg_strcmp(hm->method, mg_str("DELETE")) == 0) {
-                handleDeleteVisitor(c, hm);
-            }
+    }
+    else if (mg_strcmp(hm->uri, mg_str("/api/visitors/bulk")) == 0) {
+        if (mg_strcmp(hm->method, mg_str("POST")) == 0) {
+            handleBulkAddVisitors(c, hm);
         }
-        else if (mg_strcmp(hm->uri, mg_str("/api/rides")) == 0) {
-            if (mg_strcmp(hm->method, mg_str("GET")) == 0) {
-                handleGetRides(c);
-            } else if (mg_strcmp(hm->method, mg_str("POST")) == 0) {
-                handleAddRide(c, hm);
-            }
+    }
+    else if (strncmp(hm->uri.buf, "/api/visitors/", 14) == 0) {
+        if (mg_strcmp(hm->method, mg_str("GET")) == 0 &&
+            mg_match(hm->uri, mg_str("/api/visitors/*/queue-status"), NULL)) {
+            handleGetQueueStatus(c, hm);  // Position and boarding estimate
+        } else if (mg_strcmp(hm->method, mg_str("POST")) == 0 &&
+            mg_match(hm->uri, mg_str("/api/visitors/*/queue"), NULL)) {
+            handleJoinQueue(c, hm);  // Standby, single rider, or with the group
+        } else if (mg_strcmp(hm->method, mg_str("POST")) == 0 &&
+            mg_match(hm->uri, mg_str("/api/visitors/*/exit"), NULL)) {
+            handleVisitorExit(c, hm);  // Turnstile exit event
+        } else if (mg_match(hm->uri, mg_str("/api/visitors/*/history"), NULL)) {
+            handleGetVisitorHistory(c, hm);  // Get visitor ride history
+        } else if (mg_match(hm->uri, mg_str("/api/visitors/*/suggest"), NULL)) {
+            handleGetRideSuggestions(c, hm);  // Get ride suggestions
+        } else if (mg_match(hm->uri, mg_str("/api/visitors/*/time-to-ride"), NULL)) {
+            handleGetTimeToRide(c, hm);  // Walk plus wait, soonest first
+        } else if (mg_match(hm->uri, mg_str("/api/visitors/*/undo"), NULL)) {
+            handleUndoLastRide(c, hm);  // Undo last ride
+        } else if (mg_match(hm->uri, mg_str("/api/visitors/*/reservation"), NULL)) {
+            handleReservation(c, hm);  // Book, rebook or cancel a return time
+        } else if (mg_strcmp(hm->method, mg_str("POST")) == 0 &&
+            mg_match(hm->uri, mg_str("/api/visitors/*/reservation/redeem"), NULL)) {
+            handleRedeemReservation(c, hm);  // Back in the window: fast-pass lane
+        } else if (mg_strcmp(hm->method, mg_str("DELETE")) == 0) {
+            handleDeleteVisitor(c, hm);
         }
-        else if (strncmp(hm->uri.buf, "/api/rides/", 11) == 0) {
-            if (mg_strcmp(hm->method, mg_str("DELETE")) == 0) {
-                handleDeleteRide(c, hm);
-            } else if (mg_strcmp(hm->method, mg_str("PUT")) == 0) {
-                handleToggleRide(c, hm);
-            } else if (mg_strcmp(hm->method, mg_str("POST")) == 0) {
-                handleExperienceRide(c, hm);
-            }
+    }
+    else if (mg_strcmp(hm->uri, mg_str("/api/rides")) == 0) {
+        if (mg_strcmp(hm->method, mg_str("GET")) == 0) {
+            handleGetRides(c);
+        } else if (mg_strcmp(hm->method, mg_str("POST")) == 0) {
+            handleAddRide(c, hm);
         }
-        else if (mg_strcmp(hm->uri, mg_str("/api/queues")) == 0) {
-            if (mg_strcmp(hm->method, mg_str("GET")) == 0) {
-                handleGetQueues(c);
-            }
+    }
+    else if (strncmp(hm->uri.buf, "/api/rides/", 11) == 0) {
+        if (mg_strcmp(hm->uri, mg_str("/api/rides/by-wait-time")) == 0) {
+            handleGetRidesByWaitTime(c);  // BST-based wait time sorting
+        } else if (mg_strcmp(hm->uri, mg_str("/api/rides/nearby")) == 0) {
+            handleGetNearbyRides(c, hm);  // k-d tree, then walking distance
+        } else if (mg_strcmp(hm->method, mg_str("GET")) == 0 &&
+            mg_match(hm->uri, mg_str("/api/rides/*/wait-history"), NULL)) {
+            handleGetWaitHistory(c, hm);  // Wait-time percentiles over a range
+        } else if (mg_strcmp(hm->method, mg_str("GET")) == 0 &&
+            mg_match(hm->uri, mg_str("/api/rides/*/return-times"), NULL)) {
+            handleGetReturnTimes(c, hm);  // Next bookable return window
+        } else if (mg_strcmp(hm->method, mg_str("DELETE")) == 0) {
+            handleDeleteRide(c, hm);
+        } else if (mg_strcmp(hm->method, mg_str("PUT")) == 0) {
+            handleToggleRide(c, hm);
+        } else if (mg_strcmp(hm->method, mg_str("POST")) == 0) {
+            handleExperienceRide(c, hm);
         }
-        else if (mg_strcmp(hm->uri, mg_str("/api/stats")) == 0) {
-            if (mg_strcmp(hm->method, mg_str("GET")) == 0) {
-                handleGetStats(c);
-            }
+    }
+    else if (mg_strcmp(hm->uri, mg_str("/api/queues")) == 0) {
+        if (mg_strcmp(hm->method, mg_str("GET")) == 0) {
+            handleGetQueues(c);
         }
-        else if (strncmp(hm->uri.buf, "/api/visitors/", 14) == 0 && strstr(hm->uri.buf, "/history")) {
-            handleGetVisitorHistory(c, hm);  // Get visitor ride history
+    }
+    else if (mg_strcmp(hm->uri, mg_str("/api/stats")) == 0) {
+        if (mg_strcmp(hm->method, mg_str("GET")) == 0) {
+            handleGetStats(c);
         }
-        else if (strncmp(hm->uri.buf, "/api/visitors/", 14) == 0 && strstr(hm->uri.buf, "/suggest")) {
-            handleGetRideSuggestions(c, hm);  // Get ride suggestions
+    }
+    else if (mg_strcmp(hm->uri, mg_str("/api/crowd/balance")) == 0) {
+        if (mg_strcmp(hm->method, mg_str("GET")) == 0) {
+            handleGetCrowdBalance(c);  // Min-cost flow over next-ride intents
         }
-        else if (mg_strcmp(hm->uri, mg_str("/api/rides/by-wait-time")) == 0) {
-            handleGetRidesByWaitTime(c);  // BST-based wait time sorting
+    }
+    else if (mg_strcmp(hm->uri, mg_str("/api/pathfind")) == 0) {
+        handleFindPath(c, hm);  // Find shortest path between rides
+    }
+    else if (mg_strcmp(hm->uri, mg_str("/metrics")) == 0) {
+        handleGetMetrics(c);
+    }
+    else if (mg_strcmp(hm->uri, mg_str("/debug/trace")) == 0) {
+        if (mg_strcmp(hm->method, mg_str("GET")) == 0) {
+            handleGetTrace(c);
+        } else if (mg_strcmp(hm->method, mg_str("POST")) == 0) {
+            handleTraceControl(c, hm);
+        } else {
+            sendJSON(c, 405, "{\"error\":\"Method not allowed\"}");
         }
-        else if (mg_strcmp(hm->uri, mg_str("/api/pathfind")) == 0) {
-            handleFindPath(c, hm);  // Find shortest path between rides
+    }
+    else {
+#ifdef PARK_EMBEDDED_WEB
+        if (serveEmbeddedAsset(c, hm)) return;  // Packed at build time
+#endif
+        // Serve static files from disk
+        struct mg_http_serve_opts opts = {.root_dir = WEB_ROOT_DIR};
+        mg_http_serve_dir(c, hm, &opts);
+    }
+}
+
+/* HTTP event handler - admits, then times every request against its route */
+static void httpHandler(struct mg_connection *c, int ev, void *ev_data) {
+    if (ev == MG_EV_ACCEPT) {
+        admitConnection(c);
+    } else if (ev == MG_EV_CLOSE && c->is_accepted) {
+        open_connections--;
+        metricSet(open_connections_id, open_connections);
+    } else if (ev == MG_EV_HTTP_MSG) {
+        struct mg_http_message *hm = (struct mg_http_message *)ev_data;
+        TRACE_SPAN("httpHandler");
+        if (!admitRequest(c)) return;
+        
+        long long started = getMonotonicNanos();
+        size_t queued_before = c->send.len;
+        
+        RouteMetric *route = &route_metrics[ROUTE_METRIC_COUNT - 1];
+        for (int i = 0; i < ROUTE_METRIC_COUNT; i++) {
+            if (mg_match(hm->uri, mg_str(route_metrics[i].pattern), NULL)) {
+                route = &route_metrics[i];
+                break;
+            }
         }
-        else if (strncmp(hm->uri.buf, "/api/visitors/", 14) == 0 && strstr(hm->uri.buf, "/undo")) {
-            handleUndoLastRide(c, hm);  // Undo last ride
+        
+        {
+            TRACE_SPAN(route->pattern);  // Route span parents the handler's spans
+            routeRequest(c, hm);
         }
-        else {
-            // Serve static files
-            struct mg_http_serve_opts opts = {.root_dir = WEB_ROOT_DIR};
-            mg_http_serve_dir(c, hm, &opts);
+        
+        // Static files may stream later; bytes count what the handler queued now
+        metricObserveSince(route->latency_id, started);
+        if (c->send.len > queued_before) {
+            metricAdd(route->bytes_id, (long long)(c->send.len - queued_before));
         }
     }
-    
 }
 
 /* Start web server */
-void startWebServer(RideList* rides, VisitorGroup** groups, int* group_count,
-                   DualQueue** queues, BST* bst, Graph* park_map) {
+void startWebServer(RideList* rides, DualQueue** queues, BST* bst, Graph* park_map) {
     printf("DEBUG: startWebServer called\n");
     g_rides = rides;
-    g_groups = groups;
-    g_group_count = group_count;
     g_queues = queues;
     g_bst = bst;
     g_park_map = park_map;
+    registerRouteMetrics();
+    initAdmissionControl();
+    setTraceThreadName("park_main");
+    if (getenv("PARK_TRACE")) setTraceEnabled(1);  // Trace from startup
     
     mg_mgr_init(&mgr);
     
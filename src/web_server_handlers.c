@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 #include "../include/web_server.h"
 #include "../include/mongoose.h"
 #include "../include/visitor.h"
@@ -10,11 +11,20 @@
 #include "../include/priority_queue.h"
 #include "../include/bst.h"
 #include "../include/graph.h"
+#include "../include/wait_history.h"
+#include "../include/trace.h"
+#include "../include/response_cache.h"
+#include "../include/congestion.h"
+#include "../include/time_to_ride.h"
+#include "../include/crowd_balancer.h"
+#include "../include/virtual_queue.h"
+#include "../include/ride_simulator.h"
+#include "../include/visitor_exit.h"
+#include "../include/park_stats.h"
+#include "../include/group_registry.h"
 
 /* External declarations from web_server.c */
 extern RideList* g_rides;
-extern VisitorGroup** g_groups;
-extern int* g_group_count;
 extern DualQueue** g_queues;
 extern BST* g_bst;
 extern Graph* g_park_map;  /* Park layout graph */
@@ -23,25 +33,12 @@ extern Graph* g_park_map;  /* Park layout graph */
 extern void sendJSON(struct mg_connection *c, int status, const char *json);
 extern void buildRideJSON(char *buffer, size_t size, Ride *r);
 
-// Helper function to find visitor by ID
-static Visitor* findVisitorById(int visitor_id) {
-    for (int i = 0; i < *g_group_count; i++) {
-        VisitorNode* node = g_groups[i]->head;
-        while (node) {
-            if (node->visitor->id == visitor_id) {
-                return node->visitor;
-            }
-            node = node->next;
-        }
-    }
-    return NULL;
-}
-
 void handleGetVisitorHistory(struct mg_connection *c, struct mg_http_message *hm) {
+    TRACE_SPAN("handleGetVisitorHistory");
     int visitor_id = 0;
     sscanf(hm->uri.buf, "/api/visitors/%d/history", &visitor_id);
     
-    if (visitor_id < 1000) {
+    if (visitor_id < FIRST_VISITOR_ID) {
         sendJSON(c, 400, "{\"error\":\"Invalid visitor ID\"}");
         return;
     }
@@ -53,33 +50,40 @@ void handleGetVisitorHistory(struct mg_connection *c, struct mg_http_message *hm
         return;
     }
     
-    // Get visitor's ride history
-    RideHistoryEntry* history = getVisitorRideHistory(visitor);
-    if (!history) {
+    // Get visitor's ride history (newest first, as many as fit the response)
+    int ride_ids[HISTORY_RESPONSE_LIMIT];
+    time_t timestamps[HISTORY_RESPONSE_LIMIT];
+    int count = getVisitorRideHistory(visitor, ride_ids, timestamps, HISTORY_RESPONSE_LIMIT);
+    if (count == 0) {
         sendJSON(c, 404, "{\"error\":\"No ride history found\"}");
         return;
     }
     
+    // Resolve ride names with one pass over the ride list
+    Ride* rides_by_id[MAX_RIDES] = {NULL};
+    for (RideNode* node = g_rides->head; node; node = node->next) {
+        if (node->ride->id >= 0 && node->ride->id < MAX_RIDES) {
+            rides_by_id[node->ride->id] = node->ride;
+        }
+    }
+    
     // Build history JSON
     char response[4096] = "{\"visitor_id\":";
     char temp[256];
-    sprintf(temp, "%d,\"rides\":[", visitor_id);
+    sprintf(temp, "%d,\"total_rides\":%d,\"rides\":[", visitor_id, getRideHistoryCount(visitor));
     strcat(response, temp);
     
-    RideHistoryEntry* entry = history;
     int first = 1;
-    
-    while (entry) {
+    for (int i = 0; i < count; i++) {
+        Ride* ride = (ride_ids[i] < MAX_RIDES) ? rides_by_id[ride_ids[i]] : NULL;
+        if (!ride) continue;
+        
         if (!first) strcat(response, ",");
         first = 0;
         
-        Ride* ride = findRideById(g_rides, entry->ride_id);
-        if (ride) {
-            sprintf(temp, "{\"ride_id\":%d,\"name\":\"%s\",\"timestamp\":%lld}",
-                    ride->id, ride->name, (long long)entry->timestamp);
-            strcat(response, temp);
-        }
-        entry = entry->next;
+        sprintf(temp, "{\"ride_id\":%d,\"name\":\"%s\",\"timestamp\":%lld}",
+                ride->id, ride->name, (long long)timestamps[i]);
+        strcat(response, temp);
     }
     
     strcat(response, "]}");
@@ -87,10 +91,11 @@ void handleGetVisitorHistory(struct mg_connection *c, struct mg_http_message *hm
 }
 
 void handleGetRideSuggestions(struct mg_connection *c, struct mg_http_message *hm) {
+    TRACE_SPAN("handleGetRideSuggestions");
     int visitor_id = 0;
     sscanf(hm->uri.buf, "/api/visitors/%d/suggest", &visitor_id);
     
-    if (visitor_id < 1000) {
+    if (visitor_id < FIRST_VISITOR_ID) {
         sendJSON(c, 400, "{\"error\":\"Invalid visitor ID\"}");
         return;
     }
@@ -138,37 +143,131 @@ void handleGetRideSuggestions(struct mg_connection *c, struct mg_http_message *h
     sendJSON(c, 200, response);
 }
 
-void handleGetRidesByWaitTime(struct mg_connection *c) {
-    if (!g_bst) {
-        sendJSON(c, 500, "{\"error\":\"BST not initialized\"}");
+/* GET /api/visitors/:id/time-to-ride - open rides by walk plus predicted wait */
+void handleGetTimeToRide(struct mg_connection *c, struct mg_http_message *hm) {
+    TRACE_SPAN("handleGetTimeToRide");
+    int visitor_id = 0;
+    sscanf(hm->uri.buf, "/api/visitors/%d/time-to-ride", &visitor_id);
+    
+    Visitor* visitor = findVisitorById(visitor_id);
+    if (!visitor) {
+        sendJSON(c, 404, "{\"error\":\"Visitor not found\"}");
         return;
     }
     
-    char response[4096] = "{\"rides\":[";
-    char temp[512];
-    int first = 1;
+    char var[16];
+    int limit = MAX_RIDES;
+    if (mg_http_get_var(&hm->query, "limit", var, sizeof(var)) > 0) limit = atoi(var);
+    if (limit < 1) {
+        sendJSON(c, 400, "{\"error\":\"limit must be positive\"}");
+        return;
+    }
     
-    // Visit BST nodes in-order
-    void visitNode(BSTNode* node) {
-        if (!node) return;
-        
-        visitNode(node->left);
-        
-        if (!first) strcat(response, ",");
-        first = 0;
+    const TimeToRideRanking* ranking = rankRidesByTimeToRide(g_park_map, g_rides, visitor->current_location);
+    if (!ranking) {
+        sendJSON(c, 404, "{\"error\":\"Visitor location is not on the park map\"}");
+        return;
+    }
+    
+    char response[8192];
+    int len = snprintf(response, sizeof(response), "{\"visitor_id\":%d,\"location\":%d,\"rides\":[",
+                       visitor_id, visitor->current_location);
+    
+    for (int i = 0; i < ranking->count && i < limit; i++) {
+        const RideTime* entry = &ranking->rides[i];
+        Ride* ride = findRideById(g_rides, entry->ride_id);
+        if (!ride) continue;
+        if (len >= (int)sizeof(response) - 256) break;  // Keep room to close the JSON
         
-        buildRideJSON(temp, sizeof(temp), node->ride);
-        strcat(response, temp);
+        len += snprintf(response + len, sizeof(response) - len,
+                        "%s{\"ride_id\":%d,\"name\":\"%s\",\"walk_seconds\":%d,"
+                        "\"wait_minutes\":%d,\"total_minutes\":%.1f}",
+                        i > 0 ? "," : "", ride->id, ride->name, entry->walk_seconds,
+                        entry->wait_minutes, entry->total_seconds / 60.0f);
+    }
+    
+    snprintf(response + len, sizeof(response) - len, "]}");
+    sendJSON(c, 200, response);
+}
+
+/* GET /api/crowd/balance - diversions that even out the predicted waits */
+void handleGetCrowdBalance(struct mg_connection *c) {
+    TRACE_SPAN("handleGetCrowdBalance");
+    const BalancePlan* plan = balanceCrowds(g_rides, g_queues, g_park_map);
+    if (!plan) {
+        sendJSON(c, 500, "{\"error\":\"Rides not initialized\"}");
+        return;
+    }
+    
+    char response[8192];
+    int len = snprintf(response, sizeof(response),
+                       "{\"computed_at\":%ld,\"solve_ms\":%.3f,\"visitors\":%d,\"classes\":%d,"
+                       "\"rides\":%d,\"max_wait_before\":%d,\"max_wait_after\":%d,"
+                       "\"diverted\":%d,\"diversions\":[",
+                       (long)plan->computed_at, plan->solve_nanos / 1e6, plan->visitors, plan->classes,
+                       plan->rides, plan->max_wait_before, plan->max_wait_after, plan->diverted);
+    
+    for (int i = 0; i < plan->diversion_count; i++) {
+        const Diversion* d = &plan->diversions[i];
+        Ride* from = findRideById(g_rides, d->from_ride);
+        Ride* to = findRideById(g_rides, d->to_ride);
+        if (!from || !to) continue;
+        if (len >= (int)sizeof(response) - 512) break;  // Keep room to close the JSON
         
-        visitNode(node->right);
+        len += snprintf(response + len, sizeof(response) - len,
+                        "%s{\"location\":%d,\"from_ride\":%d,\"from_name\":\"%s\",\"to_ride\":%d,"
+                        "\"to_name\":\"%s\",\"visitors\":%d,\"intended_wait\":%d,\"suggested_wait\":%d}",
+                        i > 0 ? "," : "", d->location, from->id, from->name, to->id, to->name,
+                        d->visitors, d->intended_wait, d->suggested_wait);
     }
     
-    visitNode(g_bst->root);
-    strcat(response, "]}");
+    snprintf(response + len, sizeof(response) - len, "]}");
     sendJSON(c, 200, response);
 }
 
+/* Append the subtree's rides in wait-time order (0 = out of memory) */
+static int appendRidesInOrder(StringBuffer* out, BSTNode* node, int* first) {
+    if (!node) return 1;
+    if (!appendRidesInOrder(out, node->left, first)) return 0;
+    
+    char ride_json[512];
+    buildRideJSON(ride_json, sizeof(ride_json), node->ride);
+    if (!stringBufferAppend(out, "%s%s", *first ? "" : ",", ride_json)) return 0;
+    *first = 0;
+    
+    return appendRidesInOrder(out, node->right, first);
+}
+
+void handleGetRidesByWaitTime(struct mg_connection *c) {
+    TRACE_SPAN("handleGetRidesByWaitTime");
+    if (!g_bst) {
+        sendJSON(c, 500, "{\"error\":\"BST not initialized\"}");
+        return;
+    }
+    
+    const char* cached = getCachedResponse(CACHE_RIDES_BY_WAIT, NULL);
+    if (cached) {
+        sendJSON(c, 200, cached);
+        return;
+    }
+    
+    StringBuffer out = {NULL, 0, 0};
+    int first = 1;
+    int ok = stringBufferAppend(&out, "{\"rides\":[") &&
+             appendRidesInOrder(&out, g_bst->root, &first) &&
+             stringBufferAppend(&out, "]}");
+    
+    if (ok) {
+        storeCachedResponse(CACHE_RIDES_BY_WAIT, DATA_MASK(DATA_RIDES) | DATA_MASK(DATA_QUEUES), out.data);
+        sendJSON(c, 200, out.data);
+    } else {
+        sendJSON(c, 500, "{\"error\":\"Failed to list rides\"}");
+    }
+    freeStringBuffer(&out);
+}
+
 void handleFindPath(struct mg_connection *c, struct mg_http_message *hm) {
+    TRACE_SPAN("handleFindPath");
     double from_d = 0, to_d = 0;
     if (!mg_json_get_num(hm->body, "$.from_ride", &from_d) ||
         !mg_json_get_num(hm->body, "$.to_ride", &to_d)) {
@@ -179,51 +278,166 @@ void handleFindPath(struct mg_connection *c, struct mg_http_message *hm) {
     int from_ride = (int)from_d;
     int to_ride = (int)to_d;
     
+    // mode=fastest (query or body) routes around crowds, default is shortest
+    char mode[16];
+    if (mg_http_get_var(&hm->query, "mode", mode, sizeof(mode)) <= 0) {
+        char* body_mode = mg_json_get_str(hm->body, "$.mode");
+        snprintf(mode, sizeof(mode), "%s", body_mode ? body_mode : "shortest");
+        free(body_mode);
+    }
+    int fastest = strcmp(mode, "fastest") == 0;
+    if (!fastest && strcmp(mode, "shortest") != 0) {
+        sendJSON(c, 400, "{\"error\":\"mode must be shortest or fastest\"}");
+        return;
+    }
+    
     // Verify rides exist
     if (!findRideById(g_rides, from_ride) || !findRideById(g_rides, to_ride)) {
         sendJSON(c, 404, "{\"error\":\"Invalid ride IDs\"}");
         return;
     }
     
-    int path[MAX_RIDES];
-    int distances[MAX_RIDES];
-    int path_length = 0;
-    
-    // Find shortest path using Dijkstra's algorithm
-    PathInfo* path_info = dijkstraShortestPath(g_park_map, from_ride, to_ride);
+    // Shortest: hierarchy or Dijkstra on meters. Fastest: cached tree on crowd-weighted cost
+    PathInfo* path_info = fastest ? findFastestPath(g_park_map, from_ride, to_ride)
+                                  : findShortestRoute(g_park_map, from_ride, to_ride);
     if (!path_info || path_info->path_length == 0) {
         sendJSON(c, 500, "{\"error\":\"Failed to find path between rides\"}");
         if (path_info) freePathInfo(path_info);
         return;
     }
     
-    // Build path JSON
-    char response[4096] = "{\"path\":[";
-    char temp[256];
+    // Build path JSON (walkway junctions only add distance, rides are listed)
+    char response[4096];
+    int len = snprintf(response, sizeof(response), "{\"path\":[");
     int curr_distance = 0;
+    int listed = 0;
     
     for (int i = 0; i < path_info->path_length; i++) {
         if (i > 0) {
-            strcat(response, ",");
             curr_distance += getDistanceBetweenRides(g_park_map, path_info->path[i-1], path_info->path[i]);
         }
         
         Ride* ride = findRideById(g_rides, path_info->path[i]);
-        sprintf(temp, "{\"ride_id\":%d,\"name\":\"%s\",\"distance\":%d}",
-                ride->id, ride->name, curr_distance);
-        strcat(response, temp);
+        if (!ride) continue;
+        
+        if (len >= (int)sizeof(response) - 256) continue;  // Keep room to close the JSON, keep summing
+        len += snprintf(response + len, sizeof(response) - len,
+                        "%s{\"ride_id\":%d,\"name\":\"%s\",\"distance\":%d}",
+                        listed++ > 0 ? "," : "", ride->id, ride->name, curr_distance);
     }
     
-    strcat(response, "]}");
+    if (fastest) {
+        // Walking meters come from the edges; the tree's total is the crowd-weighted cost
+        snprintf(response + len, sizeof(response) - len,
+                 "],\"mode\":\"fastest\",\"total_distance\":%d,\"travel_cost\":%d,\"estimated_seconds\":%d}",
+                 curr_distance, path_info->total_distance,
+                 (int)(path_info->total_distance / WALKING_SPEED_MPS + 0.5f));
+    } else {
+        snprintf(response + len, sizeof(response) - len, "],\"total_distance\":%d}",
+                 path_info->total_distance);
+    }
     freePathInfo(path_info);
     sendJSON(c, 200, response);
 }
 
+/* Spatial filter for nearby rides: a ride in the park, open unless asked otherwise */
+typedef struct NearbyFilter {
+    int open_only;
+    int exclude_id;     // The node the visitor stands on
+} NearbyFilter;
+
+static int acceptNearbyRide(int ride_id, void* context) {
+    NearbyFilter* filter = (NearbyFilter*)context;
+    if (ride_id == filter->exclude_id) return 0;
+    Ride* ride = findRideById(g_rides, ride_id);
+    return ride && (!filter->open_only || ride->is_operational);
+}
+
+/* GET /api/rides/nearby?visitor=ID | location=NODE | x=&y= [&k=N&open=0]
+ * k-d tree picks the k nearest rides in a straight line, then one
+ * Dijkstra search gives exact walking meters to each */
+void handleGetNearbyRides(struct mg_connection *c, struct mg_http_message *hm) {
+    TRACE_SPAN("handleGetNearbyRides");
+    char var[32];
+    int k = NEARBY_DEFAULT_RESULTS;
+    int x = 0, y = 0;
+    int start = -1;
+    NearbyFilter filter = {1, -1};
+    
+    if (mg_http_get_var(&hm->query, "k", var, sizeof(var)) > 0) k = atoi(var);
+    if (mg_http_get_var(&hm->query, "open", var, sizeof(var)) > 0) filter.open_only = atoi(var) != 0;
+    if (k < 1 || k > NEARBY_MAX_RESULTS) {
+        char error[64];
+        snprintf(error, sizeof(error), "{\"error\":\"k must be between 1 and %d\"}", NEARBY_MAX_RESULTS);
+        sendJSON(c, 400, error);
+        return;
+    }
+    
+    // Origin: a visitor's location, a map node, or a point snapped to the nearest node
+    if (mg_http_get_var(&hm->query, "visitor", var, sizeof(var)) > 0) {
+        Visitor* visitor = findVisitorById(atoi(var));
+        if (!visitor) {
+            sendJSON(c, 404, "{\"error\":\"Visitor not found\"}");
+            return;
+        }
+        start = visitor->current_location;
+    } else if (mg_http_get_var(&hm->query, "location", var, sizeof(var)) > 0) {
+        start = atoi(var);
+    }
+    
+    if (start >= 0) {
+        if (!getNodeLocation(g_park_map, start, &x, &y)) {
+            sendJSON(c, 404, "{\"error\":\"Location has no coordinates\"}");
+            return;
+        }
+        filter.exclude_id = start;
+    } else {
+        char y_var[32];
+        if (mg_http_get_var(&hm->query, "x", var, sizeof(var)) <= 0 ||
+            mg_http_get_var(&hm->query, "y", y_var, sizeof(y_var)) <= 0) {
+            sendJSON(c, 400, "{\"error\":\"Give visitor, location, or x and y\"}");
+            return;
+        }
+        x = atoi(var);
+        y = atoi(y_var);
+        start = findNearestNode(g_park_map, x, y);
+    }
+    
+    SpatialMatch matches[NEARBY_MAX_RESULTS];
+    int ride_ids[NEARBY_MAX_RESULTS];
+    int walking[NEARBY_MAX_RESULTS];
+    int count = findNearestRidesAt(g_park_map, x, y, k, acceptNearbyRide, &filter, matches);
+    
+    for (int i = 0; i < count; i++) ride_ids[i] = matches[i].id;
+    walkingDistances(g_park_map, start, ride_ids, count, walking);
+    
+    char response[8192];
+    int len = snprintf(response, sizeof(response),
+                       "{\"origin\":{\"x\":%d,\"y\":%d,\"node\":%d},\"rides\":[", x, y, start);
+    
+    for (int i = 0; i < count; i++) {
+        Ride* ride = findRideById(g_rides, ride_ids[i]);
+        char walking_json[16] = "null";  // No walkway to this ride
+        if (len >= (int)sizeof(response) - 256) break;  // Keep room to close the JSON
+        if (walking[i] >= 0) snprintf(walking_json, sizeof(walking_json), "%d", walking[i]);
+        
+        len += snprintf(response + len, sizeof(response) - len,
+                        "%s{\"id\":%d,\"name\":\"%s\",\"x\":%d,\"y\":%d,\"wait_time\":%d,"
+                        "\"is_operational\":%d,\"straight_line\":%d,\"walking_distance\":%s}",
+                        i > 0 ? "," : "", ride->id, ride->name, ride->x, ride->y, ride->current_wait_time,
+                        ride->is_operational, (int)lround(sqrt((double)matches[i].distance_sq)), walking_json);
+    }
+    
+    snprintf(response + len, sizeof(response) - len, "]}");
+    sendJSON(c, 200, response);
+}
+
 void handleUndoLastRide(struct mg_connection *c, struct mg_http_message *hm) {
+    TRACE_SPAN("handleUndoLastRide");
     int visitor_id = 0;
     sscanf(hm->uri.buf, "/api/visitors/%d/undo", &visitor_id);
     
-    if (visitor_id < 1000) {
+    if (visitor_id < FIRST_VISITOR_ID) {
         sendJSON(c, 400, "{\"error\":\"Invalid visitor ID\"}");
         return;
     }
@@ -239,4 +453,372 @@ void handleUndoLastRide(struct mg_connection *c, struct mg_http_message *hm) {
     } else {
         sendJSON(c, 404, "{\"error\":\"No rides to undo\"}");
     }
-}
\ No newline at end of file
+}
+
+void handleGetWaitHistory(struct mg_connection *c, struct mg_http_message *hm) {
+    TRACE_SPAN("handleGetWaitHistory");
+    int ride_id = 0;
+    sscanf(hm->uri.buf, "/api/rides/%d/wait-history", &ride_id);
+    
+    Ride* ride = findRideById(g_rides, ride_id);
+    if (!ride) {
+        sendJSON(c, 404, "{\"error\":\"Ride not found\"}");
+        return;
+    }
+    
+    // Defaults: last hour, p95
+    char var[32];
+    time_t to = time(NULL);
+    time_t from = to - 3600;
+    float q = 0.95f;
+    
+    if (mg_http_get_var(&hm->query, "to", var, sizeof(var)) > 0) to = (time_t)atoll(var);
+    if (mg_http_get_var(&hm->query, "from", var, sizeof(var)) > 0) from = (time_t)atoll(var);
+    if (mg_http_get_var(&hm->query, "q", var, sizeof(var)) > 0) q = (float)atof(var);
+    
+    if (from > to || q < 0.0f || q > 1.0f) {
+        sendJSON(c, 400, "{\"error\":\"Invalid range or quantile\"}");
+        return;
+    }
+    
+    // Only the last WAIT_HISTORY_MINUTES are kept; clamp the range to them
+    time_t now = time(NULL);
+    time_t oldest = now - (time_t)WAIT_HISTORY_MINUTES * 60;
+    if (from < oldest) from = oldest;
+    if (from > now) from = now;
+    if (to < oldest) to = oldest;
+    if (to > now) to = now;
+    
+    WaitSummary summary;
+    queryWaitHistory(ride->wait_history, from, to, q, &summary);
+    
+    char response[512];
+    snprintf(response, sizeof(response),
+        "{\"ride_id\":%d,\"name\":\"%s\",\"from\":%lld,\"to\":%lld,"
+        "\"q\":%.3f,\"samples\":%d,\"avg_wait\":%.2f,\"quantile_wait\":%.2f}",
+        ride->id, ride->name, (long long)from, (long long)to,
+        q, summary.samples, summary.average_wait, summary.quantile_wait);
+    sendJSON(c, 200, response);
+}
+
+static const char* getLaneName(int lane) {
+    switch (lane) {
+        case LANE_FASTPASS: return "fastpass";
+        case LANE_SINGLE_RIDER: return "single_rider";
+        default: return "regular";
+    }
+}
+
+void handleGetQueueStatus(struct mg_connection *c, struct mg_http_message *hm) {
+    TRACE_SPAN("handleGetQueueStatus");
+    int visitor_id = 0;
+    sscanf(hm->uri.buf, "/api/visitors/%d/queue-status", &visitor_id);
+    
+    if (visitor_id < FIRST_VISITOR_ID) {
+        sendJSON(c, 400, "{\"error\":\"Invalid visitor ID\"}");
+        return;
+    }
+    
+    Visitor* visitor = findVisitorById(visitor_id);
+    if (!visitor) {
+        sendJSON(c, 404, "{\"error\":\"Visitor not found\"}");
+        return;
+    }
+    
+    char response[512];
+    int ride_id = visitor->queued_ride_id;
+    Ride* ride = ride_id >= 0 ? findRideById(g_rides, ride_id) : NULL;
+    DualQueue* queue = (ride && ride_id < MAX_RIDES) ? g_queues[ride_id] : NULL;
+    int position = getDualQueuePosition(queue, visitor);
+    
+    if (position < 0) {
+        snprintf(response, sizeof(response),
+            "{\"visitor_id\":%d,\"in_queue\":0}", visitor_id);
+        sendJSON(c, 200, response);
+        return;
+    }
+    
+    Queue* lane = queue->regular_queue;
+    if (visitor->queue_lane == LANE_FASTPASS) lane = queue->fastpass_queue;
+    if (visitor->queue_lane == LANE_SINGLE_RIDER) lane = queue->single_rider_queue;
+    int lane_position = getTicketPosition(lane, visitor);
+    int wait = estimateRideWait(ride, position);
+    
+    snprintf(response, sizeof(response),
+        "{\"visitor_id\":%d,\"in_queue\":1,\"ride_id\":%d,\"ride_name\":\"%s\","
+        "\"lane\":\"%s\",\"lane_position\":%d,\"position\":%d,\"queue_size\":%d,"
+        "\"estimated_wait\":%d,\"estimated_boarding_time\":%lld}",
+        visitor_id, ride->id, ride->name, getLaneName(visitor->queue_lane),
+        lane_position, position, getTotalQueueSize(queue),
+        wait, (long long)(time(NULL) + wait * 60));
+    sendJSON(c, 200, response);
+}
+
+/* POST /api/visitors/:id/queue - join a ride's queue
+ * Body: {"ride_id":3,"single_rider":false,"with_group":false}. with_group
+ * queues the visitor's group members not already in a queue as one party
+ * that boards the same cycle; single_rider fills seats parties leave. */
+void handleJoinQueue(struct mg_connection *c, struct mg_http_message *hm) {
+    TRACE_SPAN("handleJoinQueue");
+    int visitor_id = 0;
+    sscanf(hm->uri.buf, "/api/visitors/%d/queue", &visitor_id);
+    
+    Visitor* visitor = findVisitorById(visitor_id);
+    if (!visitor) {
+        sendJSON(c, 404, "{\"error\":\"Visitor not found\"}");
+        return;
+    }
+    
+    double ride_d = -1;
+    bool single_rider = false, with_group = false;
+    mg_json_get_num(hm->body, "$.ride_id", &ride_d);
+    mg_json_get_bool(hm->body, "$.single_rider", &single_rider);
+    mg_json_get_bool(hm->body, "$.with_group", &with_group);
+    
+    Ride* ride = findRideById(g_rides, (int)ride_d);
+    if (!ride || ride->id >= MAX_RIDES) {
+        sendJSON(c, 404, "{\"error\":\"Ride not found\"}");
+        return;
+    }
+    if (single_rider && with_group) {
+        sendJSON(c, 400, "{\"error\":\"A single rider cannot queue with a group\"}");
+        return;
+    }
+    if (!ride->is_operational) {
+        sendJSON(c, 409, "{\"error\":\"Ride is closed\"}");
+        return;
+    }
+    if (visitor->queued_ride_id >= 0) {
+        sendJSON(c, 409, "{\"error\":\"Visitor is already in a ride queue\"}");
+        return;
+    }
+    
+    if (!g_queues[ride->id]) g_queues[ride->id] = createDualQueue(ride->id, 4);  // Rides from rides.txt
+    DualQueue* queue = g_queues[ride->id];
+    if (!queue) {
+        sendJSON(c, 500, "{\"error\":\"Failed to create queue\"}");
+        return;
+    }
+    
+    int party_size = 1;
+    if (with_group) {
+        VisitorGroup* group = findVisitorGroup(visitor->id);
+        Visitor** party = (Visitor**)malloc(sizeof(Visitor*) * (group ? group->size : 1));
+        if (!party) {
+            sendJSON(c, 500, "{\"error\":\"Failed to allocate party\"}");
+            return;
+        }
+        
+        // The visitor leads; group members already queued elsewhere stay there
+        party_size = 0;
+        party[party_size++] = visitor;
+        for (VisitorNode* node = group ? group->head : NULL; node; node = node->next) {
+            if (node->visitor != visitor && node->visitor->queued_ride_id < 0) {
+                party[party_size++] = node->visitor;
+            }
+        }
+        
+        if (queue->regular_queue->size + party_size > MAX_QUEUE_SIZE) {
+            free(party);
+            sendJSON(c, 409, "{\"error\":\"Queue is full\"}");
+            return;
+        }
+        int queued = enqueueDualParty(queue, party, party_size);
+        free(party);
+        if (!queued) {
+            sendJSON(c, 500, "{\"error\":\"Failed to queue party\"}");
+            return;
+        }
+    } else if (isFull(single_rider ? queue->single_rider_queue : queue->regular_queue)) {
+        sendJSON(c, 409, "{\"error\":\"Queue is full\"}");
+        return;
+    } else if (single_rider) {
+        enqueueSingleRider(queue, visitor);
+    } else {
+        enqueueDual(queue, visitor);
+    }
+    wakeRide(ride);
+    
+    char response[256];
+    snprintf(response, sizeof(response),
+        "{\"visitor_id\":%d,\"ride_id\":%d,\"lane\":\"%s\",\"party_size\":%d,\"position\":%d}",
+        visitor->id, ride->id, getLaneName(visitor->queue_lane), party_size,
+        getDualQueuePosition(queue, visitor));
+    sendJSON(c, 201, response);
+}
+
+/* POST /api/visitors/:id/exit - turnstile exit event
+ * The visitor leaves every queue and index; their history goes to the archive */
+void handleVisitorExit(struct mg_connection *c, struct mg_http_message *hm) {
+    TRACE_SPAN("handleVisitorExit");
+    int visitor_id = 0;
+    sscanf(hm->uri.buf, "/api/visitors/%d/exit", &visitor_id);
+    
+    Visitor* visitor = findVisitorById(visitor_id);
+    if (!visitor) {
+        sendJSON(c, 404, "{\"error\":\"Visitor not found\"}");
+        return;
+    }
+    
+    int rides_completed = visitor->rides_completed;
+    int stayed = (int)(time(NULL) - visitor->entry_time);
+    exitVisitor(visitor_id, EXIT_TURNSTILE);
+    
+    char response[256];
+    snprintf(response, sizeof(response),
+        "{\"visitor_id\":%d,\"rides_completed\":%d,\"stay_seconds\":%d,\"visitors_in_park\":%d}",
+        visitor_id, rides_completed, stayed, getParkStats()->total_visitors);
+    sendJSON(c, 200, response);
+}
+
+/* HTTP status for a refused reservation request */
+static int reserveStatus(ReserveResult result) {
+    switch (result) {
+        case RESERVE_INVALID: return 400;
+        case RESERVE_NO_PASS: return 403;
+        case RESERVE_NONE: return 404;
+        default: return 409;
+    }
+}
+
+static void sendReserveError(struct mg_connection *c, ReserveResult result) {
+    char response[128];
+    snprintf(response, sizeof(response), "{\"error\":\"%s\"}", getReserveResultMessage(result));
+    sendJSON(c, reserveStatus(result), response);
+}
+
+static void sendReservation(struct mg_connection *c, int status, Visitor* visitor) {
+    char response[512];
+    time_t from = getReturnTime(visitor);
+    Ride* ride = from ? findRideById(g_rides, visitor->reservation.ride_id) : NULL;
+    
+    if (!ride) {
+        snprintf(response, sizeof(response),
+            "{\"visitor_id\":%d,\"has_reservation\":0,\"fast_passes_remaining\":%d}",
+            visitor->id, visitor->fast_passes_remaining);
+    } else {
+        snprintf(response, sizeof(response),
+            "{\"visitor_id\":%d,\"has_reservation\":1,\"ride_id\":%d,\"ride_name\":\"%s\","
+            "\"return_from\":%lld,\"return_until\":%lld,\"fast_passes_remaining\":%d}",
+            visitor->id, ride->id, ride->name, (long long)from,
+            (long long)(from + VQUEUE_SLOT_SECONDS + VQUEUE_LATE_GRACE), visitor->fast_passes_remaining);
+    }
+    sendJSON(c, status, response);
+}
+
+/* GET, POST (book), PUT (rebook), DELETE (cancel) /api/visitors/:id/reservation
+ * Body for POST and PUT: {"ride_id":3,"earliest":<unix time, optional>} */
+void handleReservation(struct mg_connection *c, struct mg_http_message *hm) {
+    TRACE_SPAN("handleReservation");
+    int visitor_id = 0;
+    sscanf(hm->uri.buf, "/api/visitors/%d/reservation", &visitor_id);
+    
+    Visitor* visitor = findVisitorById(visitor_id);
+    if (!visitor) {
+        sendJSON(c, 404, "{\"error\":\"Visitor not found\"}");
+        return;
+    }
+    
+    if (mg_strcmp(hm->method, mg_str("GET")) == 0) {
+        sendReservation(c, 200, visitor);
+        return;
+    }
+    if (mg_strcmp(hm->method, mg_str("DELETE")) == 0) {
+        ReserveResult result = cancelReturnTime(visitor);
+        if (result != RESERVE_OK) {
+            sendReserveError(c, result);
+            return;
+        }
+        sendReservation(c, 200, visitor);
+        return;
+    }
+    
+    int is_book = mg_strcmp(hm->method, mg_str("POST")) == 0;
+    if (!is_book && mg_strcmp(hm->method, mg_str("PUT")) != 0) {
+        sendJSON(c, 405, "{\"error\":\"Method not allowed\"}");
+        return;
+    }
+    
+    // Rebooking keeps the same ride unless the body names another
+    double ride_d = is_book ? -1 : visitor->reservation.ride_id;
+    double earliest_d = 0;
+    mg_json_get_num(hm->body, "$.ride_id", &ride_d);
+    mg_json_get_num(hm->body, "$.earliest", &earliest_d);
+    
+    Ride* ride = findRideById(g_rides, (int)ride_d);
+    if (!ride) {
+        sendJSON(c, 404, "{\"error\":\"Ride not found\"}");
+        return;
+    }
+    
+    time_t earliest = (time_t)earliest_d;
+    ReserveResult result = is_book ? bookReturnTime(visitor, ride, earliest)
+                                   : rebookReturnTime(visitor, ride, earliest);
+    if (result != RESERVE_OK) {
+        sendReserveError(c, result);
+        return;
+    }
+    sendReservation(c, is_book ? 201 : 200, visitor);
+}
+
+/* POST /api/visitors/:id/reservation/redeem - back in the window: join the fast-pass lane */
+void handleRedeemReservation(struct mg_connection *c, struct mg_http_message *hm) {
+    TRACE_SPAN("handleRedeemReservation");
+    int visitor_id = 0;
+    sscanf(hm->uri.buf, "/api/visitors/%d/reservation/redeem", &visitor_id);
+    
+    Visitor* visitor = findVisitorById(visitor_id);
+    if (!visitor) {
+        sendJSON(c, 404, "{\"error\":\"Visitor not found\"}");
+        return;
+    }
+    
+    Ride* ride = findRideById(g_rides, visitor->reservation.ride_id);
+    DualQueue* queue = NULL;
+    if (ride && ride->id < MAX_RIDES) {
+        if (!g_queues[ride->id]) g_queues[ride->id] = createDualQueue(ride->id, 4);  // Rides from rides.txt
+        queue = g_queues[ride->id];
+    }
+    ReserveResult result = redeemReturnTime(visitor, queue);
+    if (result != RESERVE_OK) {
+        sendReserveError(c, result);
+        return;
+    }
+    wakeRide(ride);
+    
+    char response[256];
+    snprintf(response, sizeof(response),
+        "{\"visitor_id\":%d,\"ride_id\":%d,\"lane\":\"fastpass\",\"position\":%d}",
+        visitor->id, ride->id, getDualQueuePosition(queue, visitor));
+    sendJSON(c, 200, response);
+}
+
+/* GET /api/rides/:id/return-times?after=<unix time> - next return window with room */
+void handleGetReturnTimes(struct mg_connection *c, struct mg_http_message *hm) {
+    TRACE_SPAN("handleGetReturnTimes");
+    int ride_id = 0;
+    sscanf(hm->uri.buf, "/api/rides/%d/return-times", &ride_id);
+    
+    Ride* ride = findRideById(g_rides, ride_id);
+    if (!ride) {
+        sendJSON(c, 404, "{\"error\":\"Ride not found\"}");
+        return;
+    }
+    
+    char var[24];
+    time_t after = 0;
+    if (mg_http_get_var(&hm->query, "after", var, sizeof(var)) > 0) after = (time_t)atoll(var);
+    
+    time_t next = findNextReturnTime(ride, after);
+    char response[256];
+    if (next) {
+        snprintf(response, sizeof(response),
+            "{\"ride_id\":%d,\"window_seconds\":%d,\"window_capacity\":%d,\"next_return_time\":%lld}",
+            ride->id, VQUEUE_SLOT_SECONDS, getReturnWindowCapacity(ride), (long long)next);
+    } else {
+        snprintf(response, sizeof(response),
+            "{\"ride_id\":%d,\"window_seconds\":%d,\"window_capacity\":%d,\"next_return_time\":null}",
+            ride->id, VQUEUE_SLOT_SECONDS, getReturnWindowCapacity(ride));
+    }
+    sendJSON(c, 200, response);
+}
@@ -0,0 +1,833 @@
+/* HTTP Load Tester for the Embedded Park Server
+ *
+ * Drives the real API mix over keep-alive raw sockets from a single
+ * select() loop and reports throughput plus p50/p99/p99.9 latency per
+ * route from log-linear histograms (about 3% bucket precision).
+ *
+ * Closed loop (default): every connection sends its next request as soon
+ * as the previous response arrives, so offered load adapts to the server.
+ * Open loop (--rate): requests are scheduled at a fixed rate whether or
+ * not the server keeps up, and latency is measured from the scheduled
+ * start, so queueing delay is not hidden (no coordinated omission).
+ *
+ * Usage: load_test [options]
+ *   --host ADDR        Server address (default 127.0.0.1)
+ *   --port N           Server port (default 8000)
+ *   --connections N    Concurrent connections (default 16)
+ *   --duration S       Measured seconds (default 10)
+ *   --warmup S         Unmeasured seconds before that (default 1)
+ *   --rate R           Open loop at R requests/second (default: closed loop)
+ *   --poisson          Exponential inter-arrival times in open loop
+ *   --timeout MS       Per-request timeout (default 2000)
+ *   --close            New connection per request instead of keep-alive
+ *   --mix SPEC         Route weights, e.g. rides:30,stats:20,suggest:15,
+ *                      experience:15,pathfind:10,add_visitor:10
+ *                      (static files: index, image - e.g. index:50,image:50)
+ *   --visitors N       Visitors created before the run (default 50)
+ *   --csv FILE         Append per-route results as CSV
+ */
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <ctype.h>
+
+#ifdef _WIN32
+#define FD_SETSIZE 1024
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET socket_t;
+#define closeSocket closesocket
+#define socketWouldBlock() (WSAGetLastError() == WSAEWOULDBLOCK)
+#else
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+typedef int socket_t;
+#define INVALID_SOCKET (-1)
+#define closeSocket close
+#define socketWouldBlock() (errno == EAGAIN || errno == EWOULDBLOCK)
+#endif
+
+#define LT_MAX_CONNECTIONS 512
+#define LT_MAX_RIDES 64
+#define LT_MAX_VISITORS 4096
+#define LT_REQUEST_SIZE 512
+#define LT_HIST_BUCKETS 1024
+#define LT_BACKLOG_LIMIT 1000000
+#define LT_MAX_IMAGES 64
+
+/* Routes in the mix */
+typedef enum {
+    ROUTE_RIDES,
+    ROUTE_STATS,
+    ROUTE_SUGGEST,
+    ROUTE_EXPERIENCE,
+    ROUTE_PATHFIND,
+    ROUTE_ADD_VISITOR,
+    ROUTE_INDEX,
+    ROUTE_IMAGE,
+    ROUTE_COUNT
+} RouteType;
+
+static const char* route_names[ROUTE_COUNT] = {
+    "rides", "stats", "suggest", "experience", "pathfind", "add_visitor", "index", "image"
+};
+
+/* Log-linear latency histogram in microseconds: 32 sub-buckets per power of two */
+typedef struct LatencyHistogram {
+    long long buckets[LT_HIST_BUCKETS];
+    long long count;
+    long long max_us;
+} LatencyHistogram;
+
+typedef struct RouteStats {
+    LatencyHistogram latency;
+    long long ok;
+    long long client_errors;   // 4xx
+    long long server_errors;   // 5xx
+    long long failures;        // Timeouts, resets, unparsable responses
+    long long bytes;
+} RouteStats;
+
+typedef enum {
+    CONN_IDLE,
+    CONN_SENDING,
+    CONN_RECEIVING
+} ConnState;
+
+typedef struct Connection {
+    socket_t fd;
+    ConnState state;
+    RouteType route;
+    char request[LT_REQUEST_SIZE];
+    int request_len;
+    int sent;
+    char* response;
+    int response_len;
+    int response_cap;
+    long long start_ns;     // Scheduled (open loop) or actual (closed loop) start
+    long long deadline_ns;
+} Connection;
+
+typedef struct LoadOptions {
+    char host[64];
+    int port;
+    int connections;
+    double duration;
+    double warmup;
+    double rate;
+    int poisson;
+    int timeout_ms;
+    int close_each;
+    int weights[ROUTE_COUNT];
+    int visitors;
+    char csv[256];
+} LoadOptions;
+
+static LoadOptions opts;
+static struct sockaddr_in server_addr;
+static Connection conns[LT_MAX_CONNECTIONS];
+static RouteStats stats[ROUTE_COUNT];
+static int measuring = 0;
+static unsigned int rng_state = 2463534242u;
+
+static int ride_ids[LT_MAX_RIDES];
+static int ride_count = 0;
+static int visitor_ids[LT_MAX_VISITORS];
+static int visitor_count = 0;
+static char image_paths[LT_MAX_IMAGES][96];
+static int image_count = 0;
+
+/* Open-loop backlog: scheduled starts waiting for a free connection */
+static long long* backlog = NULL;
+static int backlog_head = 0;
+static int backlog_tail = 0;
+static long long backlog_dropped = 0;
+
+static long long nowNanos() {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (long long)(counter.QuadPart / frequency.QuadPart) * 1000000000LL +
+           (long long)(counter.QuadPart % frequency.QuadPart) * 1000000000LL / frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#endif
+}
+
+static unsigned int loadRandom() {
+    unsigned int x = rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng_state = x;
+    return x;
+}
+
+/* Histogram */
+static int histogramIndex(long long us) {
+    if (us < 64) return (int)(us < 0 ? 0 : us);
+    int msb = 63 - __builtin_clzll((unsigned long long)us);
+    int shift = msb - 5;
+    int index = 32 * shift + (int)(us >> shift);
+    return index < LT_HIST_BUCKETS ? index : LT_HIST_BUCKETS - 1;
+}
+
+static long long histogramValue(int index) {
+    if (index < 64) return index;
+    int shift = index / 32 - 1;
+    return (long long)(index - 32 * shift) << shift;
+}
+
+static void recordLatency(LatencyHistogram* h, long long us) {
+    h->buckets[histogramIndex(us)]++;
+    h->count++;
+    if (us > h->max_us) h->max_us = us;
+}
+
+static long long histogramPercentile(const LatencyHistogram* h, double q) {
+    if (h->count == 0) return 0;
+    long long rank = (long long)ceil(q * h->count);
+    if (rank < 1) rank = 1;
+    long long seen = 0;
+    for (int i = 0; i < LT_HIST_BUCKETS; i++) {
+        seen += h->buckets[i];
+        if (seen >= rank) {
+            long long value = histogramValue(i);
+            return value < h->max_us ? value : h->max_us;
+        }
+    }
+    return h->max_us;
+}
+
+static void mergeHistogram(LatencyHistogram* into, const LatencyHistogram* from) {
+    for (int i = 0; i < LT_HIST_BUCKETS; i++) into->buckets[i] += from->buckets[i];
+    into->count += from->count;
+    if (from->max_us > into->max_us) into->max_us = from->max_us;
+}
+
+/* Sockets */
+static socket_t openConnection() {
+    socket_t fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (fd == INVALID_SOCKET) return INVALID_SOCKET;
+
+    // Localhost connects complete immediately, so connect blocking then switch
+    if (connect(fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) != 0) {
+        closeSocket(fd);
+        return INVALID_SOCKET;
+    }
+
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, (const char*)&one, sizeof(one));
+#ifdef _WIN32
+    u_long nonblocking = 1;
+    ioctlsocket(fd, FIONBIO, &nonblocking);
+#else
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+#endif
+    return fd;
+}
+
+static void dropConnection(Connection* conn) {
+    if (conn->fd != INVALID_SOCKET) closeSocket(conn->fd);
+    conn->fd = INVALID_SOCKET;
+    conn->state = CONN_IDLE;
+}
+
+/* Build the next request for a route */
+static int buildRequest(RouteType route, char* buffer, int size) {
+    const char* keep = opts.close_each ? "close" : "keep-alive";
+    int ride = ride_count ? ride_ids[loadRandom() % ride_count] : 1;
+    int other = ride_count ? ride_ids[loadRandom() % ride_count] : 2;
+    int visitor = visitor_count ? visitor_ids[loadRandom() % visitor_count] : 1000;
+    char body[128] = "";
+    const char* method = "GET";
+    char path[96];
+
+    switch (route) {
+        case ROUTE_RIDES:
+            strcpy(path, "/api/rides");
+            break;
+        case ROUTE_STATS:
+            strcpy(path, "/api/stats");
+            break;
+        case ROUTE_SUGGEST:
+            snprintf(path, sizeof(path), "/api/visitors/%d/suggest", visitor);
+            break;
+        case ROUTE_EXPERIENCE:
+            method = "POST";
+            snprintf(path, sizeof(path), "/api/rides/%d/experience", ride);
+            snprintf(body, sizeof(body), "{\"visitor_id\":%d}", visitor);
+            break;
+        case ROUTE_PATHFIND:
+            method = "POST";
+            strcpy(path, "/api/pathfind");
+            snprintf(body, sizeof(body), "{\"from_ride\":%d,\"to_ride\":%d}", ride, other);
+            break;
+        case ROUTE_INDEX:
+            strcpy(path, "/index.html");
+            break;
+        case ROUTE_IMAGE:
+            strcpy(path, image_count ? image_paths[loadRandom() % image_count] : "/images/default-ride.jpg");
+            break;
+        case ROUTE_ADD_VISITOR:
+        default:
+            method = "POST";
+            strcpy(path, "/api/visitors");
+            snprintf(body, sizeof(body), "{\"name\":\"Load %u\",\"thrill_preference\":%u,\"ticket_type\":%u}",
+                     loadRandom() % 100000, 1 + loadRandom() % 10, loadRandom() % 5 == 0);
+            break;
+    }
+
+    return snprintf(buffer, size,
+                    "%s %s HTTP/1.1\r\nHost: %s\r\nConnection: %s\r\nAccept-Encoding: gzip\r\n"
+                    "Content-Type: application/json\r\nContent-Length: %d\r\n\r\n%s",
+                    method, path, opts.host, keep, (int)strlen(body), body);
+}
+
+/* Complete response length if buffered, 0 if more bytes are needed, -1 if malformed.
+ * The server may emit an extra status line before the real one, so the last
+ * status line and Content-Length before the blank line win. */
+static int parseResponse(const char* data, int len, int* status) {
+    const char* end = NULL;
+    for (int i = 0; i + 3 < len; i++) {
+        if (data[i] == '\r' && data[i + 1] == '\n' && data[i + 2] == '\r' && data[i + 3] == '\n') {
+            end = data + i;
+            break;
+        }
+    }
+    if (!end) return len > 65536 ? -1 : 0;
+
+    long content_length = -1;
+    *status = 0;
+    const char* line = data;
+    while (line < end) {
+        const char* next = line;
+        while (next < end && *next != '\n') next++;
+        if (strncmp(line, "HTTP/1.", 7) == 0 && next - line > 12) {
+            *status = atoi(line + 9);
+        } else if ((next - line) > 15 &&
+                   (strncmp(line, "Content-Length:", 15) == 0 || strncmp(line, "content-length:", 15) == 0)) {
+            content_length = strtol(line + 15, NULL, 10);
+        }
+        line = next + 1;
+    }
+
+    if (*status == 0 || content_length < 0) return -1;
+    int total = (int)(end - data) + 4 + (int)content_length;
+    return len >= total ? total : 0;
+}
+
+/* Parse "id":N values out of a JSON array response */
+static int collectIds(const char* json, int* out, int max) {
+    int count = 0;
+    const char* p = json;
+    while (count < max && (p = strstr(p, "\"id\":")) != NULL) {
+        p += 5;
+        out[count++] = atoi(p);
+    }
+    return count;
+}
+
+/* Blocking request used for setup before the measured run */
+static int simpleRequest(RouteType route, const char* raw, char* body_out, int body_size) {
+    char request[LT_REQUEST_SIZE];
+    int len = raw ? (int)strlen(strcpy(request, raw)) : buildRequest(route, request, sizeof(request));
+
+    socket_t fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (fd == INVALID_SOCKET) return 0;
+    if (connect(fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) != 0) {
+        closeSocket(fd);
+        return 0;
+    }
+    send(fd, request, len, 0);
+
+    static char buffer[1 << 20];
+    int received = 0;
+    int status = 0;
+    int total = 0;
+    while (received < (int)sizeof(buffer) - 1) {
+        int n = recv(fd, buffer + received, sizeof(buffer) - 1 - received, 0);
+        if (n <= 0) break;
+        received += n;
+        total = parseResponse(buffer, received, &status);
+        if (total != 0) break;
+    }
+    closeSocket(fd);
+    buffer[received] = '\0';
+
+    if (total <= 0) return 0;
+    if (body_out) {
+        const char* body = strstr(buffer, "\r\n\r\n") + 4;
+        strncpy(body_out, body, body_size - 1);
+        body_out[body_size - 1] = '\0';
+    }
+    return status;
+}
+
+/* Find the images the UI references ("images/x.jpg" in its HTML and JS) */
+static void collectImagePaths() {
+    static const char* pages[] = {"/index.html", "/app.js"};
+    static char body[1 << 20];
+    char request[LT_REQUEST_SIZE];
+
+    for (int p = 0; p < 2; p++) {
+        snprintf(request, sizeof(request), "GET %s HTTP/1.1\r\nHost: %s\r\nConnection: close\r\n\r\n",
+                 pages[p], opts.host);
+        if (simpleRequest(ROUTE_INDEX, request, body, sizeof(body)) != 200) continue;
+
+        for (const char* s = strstr(body, "images/"); s && image_count < LT_MAX_IMAGES; s = strstr(s + 7, "images/")) {
+            int length = 7;
+            while (s[length] && (isalnum((unsigned char)s[length]) || strchr("._-", s[length]))) length++;
+            if (length <= 7 || length > 90) continue;
+
+            char path[96];
+            snprintf(path, sizeof(path), "/%.*s", length, s);
+            int known = 0;
+            for (int i = 0; i < image_count && !known; i++) known = strcmp(image_paths[i], path) == 0;
+            if (!known) strcpy(image_paths[image_count++], path);
+        }
+    }
+}
+
+/* Create the visitors and learn the ride ids the mix will use */
+static int prepareServer() {
+    static char body[1 << 20];
+
+    if (simpleRequest(ROUTE_RIDES, NULL, body, sizeof(body)) != 200) {
+        fprintf(stderr, "Error: GET /api/rides failed - is the server running on %s:%d?\n",
+                opts.host, opts.port);
+        return 0;
+    }
+    ride_count = collectIds(body, ride_ids, LT_MAX_RIDES);
+
+    for (int i = 0; i < opts.visitors && visitor_count < LT_MAX_VISITORS; i++) {
+        if (simpleRequest(ROUTE_ADD_VISITOR, NULL, body, sizeof(body)) / 100 == 2) {
+            int id = 0;
+            if (collectIds(body, &id, 1) == 1) visitor_ids[visitor_count++] = id;
+        }
+    }
+
+    if (opts.weights[ROUTE_IMAGE] > 0) collectImagePaths();
+
+    printf("Prepared %d rides, %d visitors, %d images\n", ride_count, visitor_count, image_count);
+    return ride_count > 0;
+}
+
+static RouteType pickRoute() {
+    int total = 0;
+    for (int i = 0; i < ROUTE_COUNT; i++) total += opts.weights[i];
+    int roll = (int)(loadRandom() % (unsigned int)total);
+    for (int i = 0; i < ROUTE_COUNT; i++) {
+        if (roll < opts.weights[i]) return (RouteType)i;
+        roll -= opts.weights[i];
+    }
+    return ROUTE_RIDES;
+}
+
+/* Start a request on an idle connection */
+static void startRequest(Connection* conn, long long start_ns) {
+    if (conn->fd == INVALID_SOCKET) {
+        conn->fd = openConnection();
+        if (conn->fd == INVALID_SOCKET) {
+            if (measuring) stats[pickRoute()].failures++;
+            return;
+        }
+    }
+
+    conn->route = pickRoute();
+    conn->request_len = buildRequest(conn->route, conn->request, sizeof(conn->request));
+    conn->sent = 0;
+    conn->response_len = 0;
+    conn->start_ns = start_ns;
+    conn->deadline_ns = nowNanos() + (long long)opts.timeout_ms * 1000000LL;
+    conn->state = CONN_SENDING;
+}
+
+static void finishRequest(Connection* conn, int status, int bytes) {
+    if (measuring) {
+        RouteStats* route = &stats[conn->route];
+        long long us = (nowNanos() - conn->start_ns) / 1000;
+
+        if (status == 0) {
+            route->failures++;
+        } else {
+            recordLatency(&route->latency, us);
+            route->bytes += bytes;
+            if (status >= 500) route->server_errors++;
+            else if (status >= 400) route->client_errors++;
+            else route->ok++;
+        }
+    }
+
+    if (status == 0 || opts.close_each) {
+        dropConnection(conn);
+    } else {
+        conn->state = CONN_IDLE;
+    }
+}
+
+static void handleWritable(Connection* conn) {
+    int n = send(conn->fd, conn->request + conn->sent, conn->request_len - conn->sent, 0);
+    if (n < 0) {
+        if (!socketWouldBlock()) finishRequest(conn, 0, 0);
+        return;
+    }
+    conn->sent += n;
+    if (conn->sent == conn->request_len) conn->state = CONN_RECEIVING;
+}
+
+static void handleReadable(Connection* conn) {
+    if (conn->response_cap - conn->response_len < 4096) {
+        int new_cap = conn->response_cap ? conn->response_cap * 2 : 16384;
+        char* grown = (char*)realloc(conn->response, new_cap);
+        if (!grown) {
+            finishRequest(conn, 0, 0);
+            return;
+        }
+        conn->response = grown;
+        conn->response_cap = new_cap;
+    }
+
+    int n = recv(conn->fd, conn->response + conn->response_len,
+                 conn->response_cap - conn->response_len, 0);
+    if (n <= 0) {
+        if (n < 0 && socketWouldBlock()) return;
+        finishRequest(conn, 0, 0);  // Server closed mid-response
+        return;
+    }
+    conn->response_len += n;
+
+    int status = 0;
+    int total = parseResponse(conn->response, conn->response_len, &status);
+    if (total < 0) finishRequest(conn, 0, 0);
+    else if (total > 0) finishRequest(conn, status, total);
+}
+
+static int backlogPush(long long when) {
+    if (backlog_tail - backlog_head >= LT_BACKLOG_LIMIT) {
+        backlog_dropped++;
+        return 0;
+    }
+    backlog[backlog_tail++ % LT_BACKLOG_LIMIT] = when;
+    return 1;
+}
+
+static long long nextInterval() {
+    double mean_ns = 1e9 / opts.rate;
+    if (!opts.poisson) return (long long)mean_ns;
+    double u = ((loadRandom() >> 8) + 1) / 16777217.0;
+    return (long long)(-log(u) * mean_ns);
+}
+
+/* Main select() loop */
+static double runLoad() {
+    long long begin = nowNanos();
+    long long measure_from = begin + (long long)(opts.warmup * 1e9);
+    long long stop_at = measure_from + (long long)(opts.duration * 1e9);
+    long long next_arrival = begin;
+
+    while (1) {
+        long long now = nowNanos();
+        if (!measuring && now >= measure_from) measuring = 1;
+        if (now >= stop_at) break;
+
+        // Open loop: queue every arrival that is due, then hand them to idle connections
+        if (opts.rate > 0) {
+            while (next_arrival <= now) {
+                backlogPush(next_arrival);
+                next_arrival += nextInterval();
+            }
+        }
+
+        for (int i = 0; i < opts.connections; i++) {
+            Connection* conn = &conns[i];
+            if (conn->state != CONN_IDLE) continue;
+            if (opts.rate > 0) {
+                if (backlog_head == backlog_tail) break;
+                startRequest(conn, backlog[backlog_head++ % LT_BACKLOG_LIMIT]);
+            } else {
+                startRequest(conn, now);
+            }
+        }
+
+        fd_set read_set, write_set;
+        FD_ZERO(&read_set);
+        FD_ZERO(&write_set);
+        socket_t max_fd = 0;
+        int active = 0;
+
+        for (int i = 0; i < opts.connections; i++) {
+            Connection* conn = &conns[i];
+            if (conn->state == CONN_IDLE || conn->fd == INVALID_SOCKET) continue;
+            if (now > conn->deadline_ns) {
+                finishRequest(conn, 0, 0);  // Timed out
+                continue;
+            }
+            if (conn->state == CONN_SENDING) FD_SET(conn->fd, &write_set);
+            else FD_SET(conn->fd, &read_set);
+            if (conn->fd > max_fd) max_fd = conn->fd;
+            active++;
+        }
+
+        // Wake for the next arrival in open loop, otherwise for I/O or timeouts
+        long long wait_ns = 10000000LL;
+        if (opts.rate > 0 && next_arrival - now < wait_ns) wait_ns = next_arrival - now;
+        if (wait_ns < 0) wait_ns = 0;
+        struct timeval tv = {(long)(wait_ns / 1000000000LL), (long)((wait_ns % 1000000000LL) / 1000)};
+
+        if (!active) {
+#ifdef _WIN32
+            Sleep((DWORD)(wait_ns / 1000000));
+#else
+            select(0, NULL, NULL, NULL, &tv);
+#endif
+            continue;
+        }
+
+        if (select((int)max_fd + 1, &read_set, &write_set, NULL, &tv) <= 0) continue;
+
+        for (int i = 0; i < opts.connections; i++) {
+            Connection* conn = &conns[i];
+            if (conn->fd == INVALID_SOCKET) continue;
+            if (conn->state == CONN_SENDING && FD_ISSET(conn->fd, &write_set)) handleWritable(conn);
+            else if (conn->state == CONN_RECEIVING && FD_ISSET(conn->fd, &read_set)) handleReadable(conn);
+        }
+    }
+
+    return (nowNanos() - measure_from) / 1e9;
+}
+
+static void printRow(FILE* out, const char* name, const RouteStats* s, double seconds) {
+    long long done = s->ok + s->client_errors + s->server_errors;
+    fprintf(out, "%-12s %9lld %10.1f %9lld %9lld %9lld %10lld %6lld %6lld %6lld\n",
+            name, done, done / seconds,
+            histogramPercentile(&s->latency, 0.50),
+            histogramPercentile(&s->latency, 0.99),
+            histogramPercentile(&s->latency, 0.999),
+            s->latency.max_us, s->client_errors, s->server_errors, s->failures);
+}
+
+static void appendCSV(const char* name, const RouteStats* s, double seconds, time_t started) {
+    FILE* existing = fopen(opts.csv, "r");
+    int header = existing == NULL;
+    if (existing) fclose(existing);
+
+    FILE* file = fopen(opts.csv, "a");
+    if (!file) return;
+
+    char stamp[32];
+    strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S", localtime(&started));
+    if (header) {
+        fprintf(file, "run,mode,connections,rate,route,requests,rps,p50_us,p99_us,p999_us,max_us,"
+                      "client_errors,server_errors,failures,bytes\n");
+    }
+
+    long long done = s->ok + s->client_errors + s->server_errors;
+    fprintf(file, "%s,%s,%d,%.0f,%s,%lld,%.1f,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld\n",
+            stamp, opts.rate > 0 ? "open" : "closed", opts.connections, opts.rate, name,
+            done, done / seconds,
+            histogramPercentile(&s->latency, 0.50),
+            histogramPercentile(&s->latency, 0.99),
+            histogramPercentile(&s->latency, 0.999),
+            s->latency.max_us, s->client_errors, s->server_errors, s->failures, s->bytes);
+    fclose(file);
+}
+
+static void printReport(double seconds, time_t started) {
+    RouteStats total;
+    memset(&total, 0, sizeof(total));
+
+    printf("\n%s loop, %d connections%s, %.1f s measured\n",
+           opts.rate > 0 ? "Open" : "Closed", opts.connections,
+           opts.close_each ? " (new connection per request)" : "", seconds);
+    if (opts.rate > 0) {
+        printf("Target rate %.0f req/s%s, %lld arrivals dropped from a full backlog\n",
+               opts.rate, opts.poisson ? " (Poisson)" : "", backlog_dropped);
+    }
+
+    printf("\n%-12s %9s %10s %9s %9s %9s %10s %6s %6s %6s\n",
+           "route", "requests", "req/s", "p50 us", "p99 us", "p99.9 us", "max us", "4xx", "5xx", "fail");
+    printf("---------------------------------------------------------------------------------------------\n");
+
+    for (int i = 0; i < ROUTE_COUNT; i++) {
+        if (opts.weights[i] == 0) continue;
+        printRow(stdout, route_names[i], &stats[i], seconds);
+        mergeHistogram(&total.latency, &stats[i].latency);
+        total.ok += stats[i].ok;
+        total.client_errors += stats[i].client_errors;
+        total.server_errors += stats[i].server_errors;
+        total.failures += stats[i].failures;
+        total.bytes += stats[i].bytes;
+        if (opts.csv[0]) appendCSV(route_names[i], &stats[i], seconds, started);
+    }
+
+    printf("---------------------------------------------------------------------------------------------\n");
+    printRow(stdout, "all", &total, seconds);
+    if (opts.csv[0]) appendCSV("all", &total, seconds, started);
+
+    // Coarse latency distribution (one row per power of two)
+    printf("\nLatency distribution (all routes)\n");
+    long long cumulative = 0;
+    for (int shift = 0; shift < LT_HIST_BUCKETS / 32 && cumulative < total.latency.count; shift++) {
+        int first = shift == 0 ? 0 : 32 * shift + 32;
+        int last = 32 * shift + 63;
+        long long in_range = 0;
+        for (int i = first; i <= last && i < LT_HIST_BUCKETS; i++) in_range += total.latency.buckets[i];
+        if (in_range == 0) continue;
+        cumulative += in_range;
+        printf("  < %10lld us  %9lld  %6.2f%%\n", histogramValue(last + 1), in_range,
+               100.0 * cumulative / total.latency.count);
+    }
+}
+
+static int parseMix(const char* spec) {
+    for (int i = 0; i < ROUTE_COUNT; i++) opts.weights[i] = 0;
+
+    char copy[256];
+    strncpy(copy, spec, sizeof(copy) - 1);
+    copy[sizeof(copy) - 1] = '\0';
+
+    for (char* item = strtok(copy, ","); item; item = strtok(NULL, ",")) {
+        char* colon = strchr(item, ':');
+        if (!colon) return 0;
+        *colon = '\0';
+
+        int found = 0;
+        for (int i = 0; i < ROUTE_COUNT; i++) {
+            if (strcmp(item, route_names[i]) == 0) {
+                opts.weights[i] = atoi(colon + 1);
+                found = 1;
+            }
+        }
+        if (!found) {
+            fprintf(stderr, "Error: Unknown route '%s' in mix\n", item);
+            return 0;
+        }
+    }
+
+    int total = 0;
+    for (int i = 0; i < ROUTE_COUNT; i++) total += opts.weights[i];
+    return total > 0;
+}
+
+static void printUsage() {
+    printf("Usage: load_test [--host ADDR] [--port N] [--connections N] [--duration S]\n");
+    printf("                 [--warmup S] [--rate R] [--poisson] [--timeout MS] [--close]\n");
+    printf("                 [--mix route:weight,...] [--visitors N] [--csv FILE]\n");
+    printf("Routes: rides stats suggest experience pathfind add_visitor index image\n");
+}
+
+static int parseOptions(int argc, char* argv[]) {
+    strcpy(opts.host, "127.0.0.1");
+    opts.port = 8000;
+    opts.connections = 16;
+    opts.duration = 10.0;
+    opts.warmup = 1.0;
+    opts.rate = 0.0;
+    opts.timeout_ms = 2000;
+    opts.visitors = 50;
+    parseMix("rides:30,stats:20,suggest:15,experience:15,pathfind:10,add_visitor:10");
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : "";
+
+        if (strcmp(arg, "--help") == 0) { printUsage(); exit(0); }
+        else if (strcmp(arg, "--poisson") == 0) { opts.poisson = 1; continue; }
+        else if (strcmp(arg, "--close") == 0) { opts.close_each = 1; continue; }
+        else if (strcmp(arg, "--host") == 0) { strncpy(opts.host, value, sizeof(opts.host) - 1); }
+        else if (strcmp(arg, "--port") == 0) opts.port = atoi(value);
+        else if (strcmp(arg, "--connections") == 0) opts.connections = atoi(value);
+        else if (strcmp(arg, "--duration") == 0) opts.duration = atof(value);
+        else if (strcmp(arg, "--warmup") == 0) opts.warmup = atof(value);
+        else if (strcmp(arg, "--rate") == 0) opts.rate = atof(value);
+        else if (strcmp(arg, "--timeout") == 0) opts.timeout_ms = atoi(value);
+        else if (strcmp(arg, "--visitors") == 0) opts.visitors = atoi(value);
+        else if (strcmp(arg, "--csv") == 0) { strncpy(opts.csv, value, sizeof(opts.csv) - 1); }
+        else if (strcmp(arg, "--mix") == 0) {
+            if (!parseMix(value)) return 0;
+        } else {
+            fprintf(stderr, "Error: Unknown option %s\n", arg);
+            return 0;
+        }
+        i++;
+    }
+
+    if (opts.connections < 1 || opts.connections > LT_MAX_CONNECTIONS) {
+        fprintf(stderr, "Error: --connections must be 1..%d\n", LT_MAX_CONNECTIONS);
+        return 0;
+    }
+    if (opts.duration <= 0 || opts.timeout_ms <= 0) {
+        fprintf(stderr, "Error: --duration and --timeout must be positive\n");
+        return 0;
+    }
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    if (!parseOptions(argc, argv)) {
+        printUsage();
+        return 1;
+    }
+
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        fprintf(stderr, "Error: WSAStartup failed\n");
+        return 1;
+    }
+#endif
+
+    memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons((unsigned short)opts.port);
+    if (inet_pton(AF_INET, opts.host, &server_addr.sin_addr) != 1) {
+        fprintf(stderr, "Error: --host must be an IPv4 address\n");
+        return 1;
+    }
+
+    for (int i = 0; i < LT_MAX_CONNECTIONS; i++) {
+        conns[i].fd = INVALID_SOCKET;
+        conns[i].state = CONN_IDLE;
+    }
+
+    if (opts.rate > 0) {
+        backlog = (long long*)malloc(sizeof(long long) * LT_BACKLOG_LIMIT);
+        if (!backlog) {
+            fprintf(stderr, "Error: Memory allocation failed for backlog\n");
+            return 1;
+        }
+    }
+
+    if (!prepareServer()) return 1;
+
+    time_t started = time(NULL);
+    double seconds = runLoad();
+    printReport(seconds, started);
+
+    for (int i = 0; i < opts.connections; i++) {
+        dropConnection(&conns[i]);
+        free(conns[i].response);
+    }
+    free(backlog);
+
+#ifdef _WIN32
+    WSACleanup();
+#endif
+    return 0;
+}
@@ -0,0 +1,380 @@
+/* Web Asset Packer
+ *
+ * Build step that embeds web/ into the server binary. Every file is
+ * written to a generated C source as a byte array, together with a
+ * precompressed gzip variant (when it saves at least 10%), a strong ETag
+ * and its Content-Type, so the server never touches the disk or runs a
+ * compressor while serving. The gzip encoder is self-contained (LZ77 with
+ * hash chains, fixed Huffman codes) so the build needs no zlib.
+ *
+ * Usage: pack_web <web_dir> <output.c>
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#define PACK_MAX_FILES 256
+#define PACK_MAX_PATH 512
+
+#define LZ_WINDOW 32768
+#define LZ_HASH_BITS 15
+#define LZ_MIN_MATCH 3
+#define LZ_MAX_MATCH 258
+#define LZ_MAX_CHAIN 128
+
+typedef struct PackedFile {
+    char uri[PACK_MAX_PATH];        // "/images/swing.jpg"
+    char disk_path[PACK_MAX_PATH];
+} PackedFile;
+
+typedef struct BitWriter {
+    unsigned char* data;
+    size_t length;
+    size_t capacity;
+    unsigned int bit_buffer;
+    int bit_count;
+} BitWriter;
+
+static PackedFile files[PACK_MAX_FILES];
+static int file_count = 0;
+
+/* Extensions worth embedding; anything else stays on disk */
+static const struct {
+    const char* extension;
+    const char* content_type;
+} content_types[] = {
+    {".html", "text/html; charset=utf-8"},
+    {".js", "application/javascript; charset=utf-8"},
+    {".css", "text/css; charset=utf-8"},
+    {".json", "application/json"},
+    {".svg", "image/svg+xml"},
+    {".png", "image/png"},
+    {".jpg", "image/jpeg"},
+    {".jpeg", "image/jpeg"},
+    {".gif", "image/gif"},
+    {".ico", "image/x-icon"}
+};
+#define CONTENT_TYPE_COUNT ((int)(sizeof(content_types) / sizeof(content_types[0])))
+
+static const char* findContentType(const char* path) {
+    const char* dot = strrchr(path, '.');
+    if (!dot) return NULL;
+    for (int i = 0; i < CONTENT_TYPE_COUNT; i++) {
+        if (strcmp(dot, content_types[i].extension) == 0) return content_types[i].content_type;
+    }
+    return NULL;
+}
+
+/* Output Buffer */
+static void putByte(BitWriter* w, unsigned char byte) {
+    if (w->length == w->capacity) {
+        w->capacity = w->capacity ? w->capacity * 2 : 65536;
+        w->data = (unsigned char*)realloc(w->data, w->capacity);
+        if (!w->data) {
+            fprintf(stderr, "Error: Memory allocation failed for gzip output\n");
+            exit(1);
+        }
+    }
+    w->data[w->length++] = byte;
+}
+
+/* Deflate writes fields least-significant bit first */
+static void putBits(BitWriter* w, unsigned int value, int count) {
+    w->bit_buffer |= value << w->bit_count;
+    w->bit_count += count;
+    while (w->bit_count >= 8) {
+        putByte(w, (unsigned char)(w->bit_buffer & 0xFF));
+        w->bit_buffer >>= 8;
+        w->bit_count -= 8;
+    }
+}
+
+/* Huffman codes are defined most-significant bit first */
+static void putHuffman(BitWriter* w, unsigned int code, int length) {
+    unsigned int reversed = 0;
+    for (int i = 0; i < length; i++) {
+        reversed = (reversed << 1) | ((code >> i) & 1);
+    }
+    putBits(w, reversed, length);
+}
+
+static void flushBits(BitWriter* w) {
+    if (w->bit_count > 0) putByte(w, (unsigned char)(w->bit_buffer & 0xFF));
+    w->bit_buffer = 0;
+    w->bit_count = 0;
+}
+
+/* Fixed literal/length code from RFC 1951 section 3.2.6 */
+static void putLiteralSymbol(BitWriter* w, int symbol) {
+    if (symbol < 144) putHuffman(w, 0x30 + symbol, 8);
+    else if (symbol < 256) putHuffman(w, 0x190 + (symbol - 144), 9);
+    else if (symbol < 280) putHuffman(w, symbol - 256, 7);
+    else putHuffman(w, 0xC0 + (symbol - 280), 8);
+}
+
+static const int length_base[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const int length_extra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const int distance_base[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const int distance_extra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+static void putMatch(BitWriter* w, int length, int distance) {
+    int code = 28;
+    while (length_base[code] > length) code--;
+    putLiteralSymbol(w, 257 + code);
+    putBits(w, (unsigned int)(length - length_base[code]), length_extra[code]);
+
+    code = 29;
+    while (distance_base[code] > distance) code--;
+    putHuffman(w, (unsigned int)code, 5);
+    putBits(w, (unsigned int)(distance - distance_base[code]), distance_extra[code]);
+}
+
+static unsigned int hash3(const unsigned char* p) {
+    return ((p[0] << 10) ^ (p[1] << 5) ^ p[2]) & ((1u << LZ_HASH_BITS) - 1);
+}
+
+/* One fixed-Huffman deflate block over the whole input (greedy LZ77) */
+static void deflateFixed(BitWriter* w, const unsigned char* data, size_t size) {
+    int* head = (int*)malloc(sizeof(int) * (1u << LZ_HASH_BITS));
+    int* prev = (int*)malloc(sizeof(int) * LZ_WINDOW);
+    if (!head || !prev) {
+        fprintf(stderr, "Error: Memory allocation failed for LZ77 tables\n");
+        exit(1);
+    }
+    for (unsigned int i = 0; i < (1u << LZ_HASH_BITS); i++) head[i] = -1;
+
+    putBits(w, 1, 1);  // BFINAL
+    putBits(w, 1, 2);  // BTYPE = fixed Huffman
+
+    size_t pos = 0;
+    while (pos < size) {
+        int best_length = 0;
+        int best_distance = 0;
+
+        if (pos + LZ_MIN_MATCH <= size) {
+            unsigned int h = hash3(data + pos);
+            int candidate = head[h];
+            int chain = 0;
+            size_t max_length = size - pos < LZ_MAX_MATCH ? size - pos : LZ_MAX_MATCH;
+
+            while (candidate >= 0 && pos - (size_t)candidate <= LZ_WINDOW - 1 && chain++ < LZ_MAX_CHAIN) {
+                size_t length = 0;
+                while (length < max_length && data[candidate + length] == data[pos + length]) length++;
+                if ((int)length > best_length) {
+                    best_length = (int)length;
+                    best_distance = (int)(pos - candidate);
+                    if (length == max_length) break;
+                }
+                candidate = prev[candidate % LZ_WINDOW];
+            }
+
+            prev[pos % LZ_WINDOW] = head[h];
+            head[h] = (int)pos;
+        }
+
+        if (best_length >= LZ_MIN_MATCH) {
+            putMatch(w, best_length, best_distance);
+            // Index the skipped positions so later matches can find them
+            for (size_t i = pos + 1; i < pos + best_length && i + LZ_MIN_MATCH <= size; i++) {
+                unsigned int h = hash3(data + i);
+                prev[i % LZ_WINDOW] = head[h];
+                head[h] = (int)i;
+            }
+            pos += best_length;
+        } else {
+            putLiteralSymbol(w, data[pos]);
+            pos++;
+        }
+    }
+
+    putLiteralSymbol(w, 256);  // End of block
+    flushBits(w);
+    free(head);
+    free(prev);
+}
+
+static unsigned int crc32Of(const unsigned char* data, size_t size) {
+    static unsigned int table[256];
+    if (table[1] == 0) {
+        for (unsigned int n = 0; n < 256; n++) {
+            unsigned int c = n;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+    }
+    unsigned int crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; i++) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+static void putLE32(BitWriter* w, unsigned int value) {
+    for (int i = 0; i < 4; i++) putByte(w, (unsigned char)(value >> (8 * i)));
+}
+
+/* gzip member with mtime 0 so repeated builds are byte-identical */
+static void gzipCompress(BitWriter* w, const unsigned char* data, size_t size) {
+    static const unsigned char header[10] = {0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 2, 0xFF};
+    for (int i = 0; i < 10; i++) putByte(w, header[i]);
+    deflateFixed(w, data, size);
+    putLE32(w, crc32Of(data, size));
+    putLE32(w, (unsigned int)size);
+}
+
+static unsigned long long fnv1a64(const unsigned char* data, size_t size) {
+    unsigned long long hash = 1469598103934665603ULL;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/* Collect embeddable files under dir (recursive) */
+static void collectFiles(const char* dir, const char* uri_prefix) {
+    DIR* handle = opendir(dir);
+    if (!handle) {
+        fprintf(stderr, "Error: Cannot open directory %s\n", dir);
+        exit(1);
+    }
+
+    struct dirent* entry;
+    while ((entry = readdir(handle)) != NULL) {
+        if (entry->d_name[0] == '.') continue;  // ., .., dotfiles
+
+        char disk_path[PACK_MAX_PATH];
+        char uri[PACK_MAX_PATH];
+        snprintf(disk_path, sizeof(disk_path), "%s/%s", dir, entry->d_name);
+        snprintf(uri, sizeof(uri), "%s/%s", uri_prefix, entry->d_name);
+
+        struct stat info;
+        if (stat(disk_path, &info) != 0) continue;
+
+        if (S_ISDIR(info.st_mode)) {
+            collectFiles(disk_path, uri);
+        } else if (findContentType(uri)) {
+            if (file_count == PACK_MAX_FILES) {
+                fprintf(stderr, "Error: More than %d web assets\n", PACK_MAX_FILES);
+                exit(1);
+            }
+            strcpy(files[file_count].uri, uri);
+            strcpy(files[file_count].disk_path, disk_path);
+            file_count++;
+        }
+    }
+    closedir(handle);
+}
+
+static int compareFiles(const void* a, const void* b) {
+    return strcmp(((const PackedFile*)a)->uri, ((const PackedFile*)b)->uri);
+}
+
+static unsigned char* readWholeFile(const char* path, size_t* size) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    unsigned char* data = (unsigned char*)malloc(length > 0 ? (size_t)length : 1);
+    if (data && fread(data, 1, (size_t)length, file) != (size_t)length) {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+    *size = (size_t)length;
+    return data;
+}
+
+static void writeArray(FILE* out, const char* name, const unsigned char* data, size_t size) {
+    fprintf(out, "static const unsigned char %s[] = {", name);
+    for (size_t i = 0; i < size; i++) {
+        fprintf(out, "%s%u,", (i % 24 == 0) ? "\n" : "", data[i]);
+    }
+    fprintf(out, "%s};\n", size == 0 ? "0" : "\n");
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: pack_web <web_dir> <output.c>\n");
+        return 1;
+    }
+
+    collectFiles(argv[1], "");
+    qsort(files, file_count, sizeof(PackedFile), compareFiles);  // Server binary-searches by URI
+
+    FILE* out = fopen(argv[2], "w");
+    if (!out) {
+        fprintf(stderr, "Error: Cannot write %s\n", argv[2]);
+        return 1;
+    }
+
+    fprintf(out, "/* Generated by tools/pack_web.c from %s - do not edit */\n", argv[1]);
+    fprintf(out, "#include <stddef.h>\n#include \"../include/web_assets.h\"\n\n");
+
+    size_t gzip_sizes[PACK_MAX_FILES];
+    size_t sizes[PACK_MAX_FILES];
+    unsigned long long hashes[PACK_MAX_FILES];
+    size_t total_raw = 0;
+    size_t total_packed = 0;
+
+    for (int i = 0; i < file_count; i++) {
+        unsigned char* data = readWholeFile(files[i].disk_path, &sizes[i]);
+        if (!data) {
+            fprintf(stderr, "Error: Cannot read %s\n", files[i].disk_path);
+            fclose(out);
+            return 1;
+        }
+
+        char name[32];
+        snprintf(name, sizeof(name), "asset_%d", i);
+        writeArray(out, name, data, sizes[i]);
+        hashes[i] = fnv1a64(data, sizes[i]);
+
+        // Keep the gzip variant only when it is clearly smaller (JPEG/PNG are not)
+        BitWriter gzip = {NULL, 0, 0, 0, 0};
+        gzipCompress(&gzip, data, sizes[i]);
+        gzip_sizes[i] = 0;
+        if (gzip.length * 10 < sizes[i] * 9) {
+            snprintf(name, sizeof(name), "asset_%d_gz", i);
+            writeArray(out, name, gzip.data, gzip.length);
+            gzip_sizes[i] = gzip.length;
+        }
+
+        total_raw += sizes[i];
+        total_packed += gzip_sizes[i] ? gzip_sizes[i] : sizes[i];
+        printf("  %-40s %9lu -> %9lu%s\n", files[i].uri, (unsigned long)sizes[i],
+               (unsigned long)(gzip_sizes[i] ? gzip_sizes[i] : sizes[i]), gzip_sizes[i] ? " (gzip)" : "");
+        free(gzip.data);
+        free(data);
+    }
+
+    fprintf(out, "\nconst WebAsset web_assets[] = {\n");
+    for (int i = 0; i < file_count; i++) {
+        fprintf(out, "    {\"%s\", \"%s\", \"\\\"%016llx\\\"\", \"\\\"%016llx-gz\\\"\",\n"
+                     "     asset_%d, %lu, ",
+                files[i].uri, findContentType(files[i].uri), hashes[i], hashes[i], i, (unsigned long)sizes[i]);
+        if (gzip_sizes[i]) fprintf(out, "asset_%d_gz, %lu},\n", i, (unsigned long)gzip_sizes[i]);
+        else fprintf(out, "NULL, 0},\n");
+    }
+    if (file_count == 0) fprintf(out, "    {\"\", \"\", \"\", \"\", NULL, 0, NULL, 0}\n");
+    fprintf(out, "};\nconst int web_asset_count = %d;\n", file_count);
+    fclose(out);
+
+    printf("Packed %d web assets: %lu bytes -> %lu bytes served\n", file_count,
+           (unsigned long)total_raw, (unsigned long)total_packed);
+    return 0;
+}
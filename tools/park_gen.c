@@ -0,0 +1,389 @@
+/* Synthetic Park Generator
+ *
+ * Writes rides.txt, visitors.txt and park_map.txt in the same CSV formats
+ * the park system loads, so large parks can be fed straight into the
+ * simulator and `make bench`. Output is fully determined by the seed.
+ *
+ * The walkway network is a jittered grid of junctions: a random spanning
+ * tree keeps it connected, a share of the remaining grid edges and at most
+ * one diagonal per cell are added back, so the map stays planar. Rides and
+ * the entrance (node 0) hang off junctions by short spur paths. Junction
+ * ids start at MAX_RIDES so they never collide with ride ids.
+ *
+ * Usage: park_gen [options]
+ *   --seed N          PRNG seed (default 1)
+ *   --rides N         Rides to generate, 1..MAX_RIDES-1 (default 40)
+ *   --visitors N      Visitors to generate (default 10000)
+ *   --junctions N     Walkway junctions (default 2500)
+ *   --premium PCT     Percent of visitors with premium tickets (default 20)
+ *   --thrill MODE     uniform | normal | bimodal (default normal)
+ *   --out DIR         Output directory (default data)
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../include/config.h"
+
+#define GEN_CELL_METERS 40        // Average spacing between junctions
+#define GEN_KEEP_GRID_PERCENT 55  // Non-tree grid edges added back
+#define GEN_DIAGONAL_PERCENT 15   // Cells that get a diagonal shortcut
+
+typedef enum {
+    THRILL_UNIFORM,
+    THRILL_NORMAL,
+    THRILL_BIMODAL
+} ThrillMode;
+
+typedef struct GenOptions {
+    unsigned int seed;
+    int rides;
+    int visitors;
+    int junctions;
+    int premium_percent;
+    ThrillMode thrill_mode;
+    char out_dir[MAX_PATH_LENGTH];
+} GenOptions;
+
+typedef struct GridEdge {
+    int a;
+    int b;
+} GridEdge;
+
+static unsigned int rng_state = 1;
+
+static const char* ride_adjectives[] = {
+    "Thunder", "Sky", "Mystic", "Crazy", "Spooky", "Super", "Wild", "Golden",
+    "Dragon", "Rocket", "Jungle", "Pirate", "Galaxy", "Cyclone", "Polar", "Volcano"
+};
+static const char* ride_nouns[] = {
+    "Coaster", "Carousel", "Wheel", "Rapids", "Drop Tower", "Swing", "Twister",
+    "Mansion", "Falls", "Spinner", "Express", "Loop"
+};
+static const char* first_names[] = {
+    "Alice", "Bob", "Charlie", "Diana", "Eve", "Frank", "Grace", "Henry",
+    "Ivy", "Jack", "Karen", "Leo", "Maya", "Noah", "Olivia", "Paul",
+    "Quinn", "Rosa", "Sam", "Tara", "Uma", "Victor", "Wendy", "Xavier"
+};
+static const char* last_names[] = {
+    "Johnson", "Smith", "Brown", "Prince", "Wilson", "Garcia", "Lee", "Patel",
+    "Nguyen", "Kim", "Lopez", "Miller", "Davis", "Clark", "Lewis", "Young"
+};
+
+#define COUNT_OF(a) ((int)(sizeof(a) / sizeof((a)[0])))
+
+/* xorshift32: same sequence on every platform, unlike rand() */
+static unsigned int genRandom() {
+    unsigned int x = rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng_state = x;
+    return x;
+}
+
+static int genRange(int low, int high) {
+    return low + (int)(genRandom() % (unsigned int)(high - low + 1));
+}
+
+static double genUnit() {
+    return (genRandom() >> 8) / 16777216.0;
+}
+
+/* Thrill level 1-10 drawn from the chosen distribution */
+static int genThrill(ThrillMode mode) {
+    int thrill;
+
+    switch (mode) {
+        case THRILL_UNIFORM:
+            thrill = genRange(MIN_THRILL_LEVEL, MAX_THRILL_LEVEL);
+            break;
+        case THRILL_BIMODAL: {
+            // Families around 3, thrill seekers around 8
+            double sum = genUnit() + genUnit() + genUnit() - 1.5;
+            thrill = (int)lround((genRandom() & 1 ? 8.0 : 3.0) + sum * 1.5);
+            break;
+        }
+        case THRILL_NORMAL:
+        default: {
+            // Irwin-Hall approximation of a normal around 5.5
+            double sum = 0.0;
+            for (int i = 0; i < 12; i++) sum += genUnit();
+            thrill = (int)lround(5.5 + (sum - 6.0) * 2.0);
+            break;
+        }
+    }
+
+    if (thrill < MIN_THRILL_LEVEL) thrill = MIN_THRILL_LEVEL;
+    if (thrill > MAX_THRILL_LEVEL) thrill = MAX_THRILL_LEVEL;
+    return thrill;
+}
+
+/* Union-find for the spanning tree */
+static int findRoot(int* parent, int x) {
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+static int joinSets(int* parent, int a, int b) {
+    int ra = findRoot(parent, a);
+    int rb = findRoot(parent, b);
+    if (ra == rb) return 0;
+    parent[ra] = rb;
+    return 1;
+}
+
+static int walkDistance(const double* x, const double* y, int a, int b) {
+    double dx = x[a] - x[b];
+    double dy = y[a] - y[b];
+    int meters = (int)lround(sqrt(dx * dx + dy * dy));
+    return meters > 0 ? meters : 1;
+}
+
+static FILE* openOutput(const GenOptions* opts, const char* name) {
+    char path[MAX_PATH_LENGTH * 2];
+    snprintf(path, sizeof(path), "%s/%s", opts->out_dir, name);
+
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Error: Could not open %s for writing\n", path);
+    }
+    return file;
+}
+
+/* rides.txt: id,name,capacity,thrill_level,wait_time */
+static int writeRides(const GenOptions* opts) {
+    FILE* file = openOutput(opts, "rides.txt");
+    if (!file) return 0;
+
+    int combos = COUNT_OF(ride_adjectives) * COUNT_OF(ride_nouns);
+    int start = genRange(0, combos - 1);
+
+    fprintf(file, "id,name,capacity,thrill_level,wait_time\n");
+    for (int id = 1; id <= opts->rides; id++) {
+        int combo = (start + (id - 1) * 7) % combos;  // 7 is coprime with combos
+        int thrill = genThrill(THRILL_UNIFORM);
+        int capacity = MIN_RIDE_CAPACITY + 2 * genRange(0, (MAX_RIDE_CAPACITY - MIN_RIDE_CAPACITY) / 2);
+        int wait = thrill * 3 + genRange(0, 20);  // Bigger thrills draw longer lines
+
+        fprintf(file, "%d,%s %s,%d,%d,%d\n", id,
+                ride_adjectives[combo / COUNT_OF(ride_nouns)],
+                ride_nouns[combo % COUNT_OF(ride_nouns)],
+                capacity, thrill, wait);
+    }
+
+    fclose(file);
+    return 1;
+}
+
+/* visitors.txt: id,name,thrill_preference,ticket_type */
+static int writeVisitors(const GenOptions* opts) {
+    FILE* file = openOutput(opts, "visitors.txt");
+    if (!file) return 0;
+
+    fprintf(file, "id,name,thrill_preference,ticket_type\n");
+    for (int i = 0; i < opts->visitors; i++) {
+        int premium = genRange(0, 99) < opts->premium_percent;
+        fprintf(file, "%d,%s %s,%d,%d\n", 1000 + i,
+                first_names[genRange(0, COUNT_OF(first_names) - 1)],
+                last_names[genRange(0, COUNT_OF(last_names) - 1)],
+                genThrill(opts->thrill_mode), premium);
+    }
+
+    fclose(file);
+    return 1;
+}
+
+/* Grid edge between junctions a and b, with both positions */
+static void writeWalkway(FILE* file, const double* x, const double* y, int a, int b) {
+    fprintf(file, "%d,%d,%d,%ld,%ld,%ld,%ld\n", MAX_RIDES + a, MAX_RIDES + b, walkDistance(x, y, a, b),
+            lround(x[a]), lround(y[a]), lround(x[b]), lround(y[b]));
+}
+
+/* Rides and the entrance sit at the end of a straight spur from junction j.
+ * The direction comes from the id (golden angle), not the generator, so
+ * adding positions left every seed's layout unchanged. */
+static void placeOnSpur(const double* x, const double* y, int j, int id, int spur, long* px, long* py) {
+    double angle = id * 2.39996322972865;
+    *px = lround(x[j] + cos(angle) * spur);
+    *py = lround(y[j] + sin(angle) * spur);
+}
+
+/* park_map.txt: ride1_id,ride2_id,distance,x1,y1,x2,y2 */
+static int writeParkMap(const GenOptions* opts) {
+    int cols = (int)ceil(sqrt((double)opts->junctions));
+    int rows = (opts->junctions + cols - 1) / cols;
+    int count = opts->junctions;
+
+    double* x = (double*)malloc(sizeof(double) * count);
+    double* y = (double*)malloc(sizeof(double) * count);
+    int* parent = (int*)malloc(sizeof(int) * count);
+    GridEdge* edges = (GridEdge*)malloc(sizeof(GridEdge) * 2 * count);
+    if (!x || !y || !parent || !edges) {
+        fprintf(stderr, "Error: Memory allocation failed for park map\n");
+        free(x); free(y); free(parent); free(edges);
+        return 0;
+    }
+
+    // Jittered grid positions (meters)
+    for (int j = 0; j < count; j++) {
+        x[j] = (j % cols) * GEN_CELL_METERS + (genUnit() - 0.5) * GEN_CELL_METERS * 0.6;
+        y[j] = (j / cols) * GEN_CELL_METERS + (genUnit() - 0.5) * GEN_CELL_METERS * 0.6;
+        parent[j] = j;
+    }
+
+    // Candidate grid edges, shuffled
+    int edge_count = 0;
+    for (int j = 0; j < count; j++) {
+        if (j % cols + 1 < cols && j + 1 < count) edges[edge_count++] = (GridEdge){j, j + 1};
+        if (j + cols < count) edges[edge_count++] = (GridEdge){j, j + cols};
+    }
+    for (int i = edge_count - 1; i > 0; i--) {
+        int k = genRange(0, i);
+        GridEdge tmp = edges[i];
+        edges[i] = edges[k];
+        edges[k] = tmp;
+    }
+
+    FILE* file = openOutput(opts, "park_map.txt");
+    if (!file) {
+        free(x); free(y); free(parent); free(edges);
+        return 0;
+    }
+
+    fprintf(file, "ride1_id,ride2_id,distance,x1,y1,x2,y2\n");
+
+    // Spanning tree first, then a share of the leftover edges for loops
+    for (int i = 0; i < edge_count; i++) {
+        int a = edges[i].a;
+        int b = edges[i].b;
+        if (joinSets(parent, a, b) || genRange(0, 99) < GEN_KEEP_GRID_PERCENT) {
+            writeWalkway(file, x, y, a, b);
+        }
+    }
+
+    // One diagonal per chosen cell keeps the map planar
+    for (int r = 0; r + 1 < rows; r++) {
+        for (int c = 0; c + 1 < cols; c++) {
+            int top_left = r * cols + c;
+            if (top_left + cols + 1 >= count || genRange(0, 99) >= GEN_DIAGONAL_PERCENT) continue;
+
+            int a = (genRandom() & 1) ? top_left : top_left + 1;
+            int b = (a == top_left) ? top_left + cols + 1 : top_left + cols;
+            writeWalkway(file, x, y, a, b);
+        }
+    }
+
+    // Entrance at the southern edge, rides spread over the grid
+    for (int id = 0; id <= opts->rides; id++) {
+        int spur = id == 0 ? genRange(20, 60) : genRange(10, 60);
+        int j = id == 0 ? genRange(0, cols - 1) : genRange(0, count - 1);
+        long px, py;
+        placeOnSpur(x, y, j, id, spur, &px, &py);
+        fprintf(file, "%d,%d,%d,%ld,%ld,%ld,%ld\n", id, MAX_RIDES + j, spur,
+                px, py, lround(x[j]), lround(y[j]));
+    }
+
+    fclose(file);
+    free(x);
+    free(y);
+    free(parent);
+    free(edges);
+    return 1;
+}
+
+static void printUsage() {
+    printf("Usage: park_gen [--seed N] [--rides N] [--visitors N] [--junctions N]\n");
+    printf("                [--premium PCT] [--thrill uniform|normal|bimodal] [--out DIR]\n");
+}
+
+static int parseOptions(int argc, char* argv[], GenOptions* opts) {
+    opts->seed = 1;
+    opts->rides = 40;
+    opts->visitors = 10000;
+    opts->junctions = 2500;
+    opts->premium_percent = 20;
+    opts->thrill_mode = THRILL_NORMAL;
+    strcpy(opts->out_dir, "data");
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "--help") == 0) {
+            printUsage();
+            exit(0);
+        }
+        if (!value) {
+            fprintf(stderr, "Error: Missing value for %s\n", arg);
+            return 0;
+        }
+
+        if (strcmp(arg, "--seed") == 0) {
+            opts->seed = (unsigned int)strtoul(value, NULL, 10);
+        } else if (strcmp(arg, "--rides") == 0) {
+            opts->rides = atoi(value);
+        } else if (strcmp(arg, "--visitors") == 0) {
+            opts->visitors = atoi(value);
+        } else if (strcmp(arg, "--junctions") == 0) {
+            opts->junctions = atoi(value);
+        } else if (strcmp(arg, "--premium") == 0) {
+            opts->premium_percent = atoi(value);
+        } else if (strcmp(arg, "--thrill") == 0) {
+            if (strcmp(value, "uniform") == 0) opts->thrill_mode = THRILL_UNIFORM;
+            else if (strcmp(value, "normal") == 0) opts->thrill_mode = THRILL_NORMAL;
+            else if (strcmp(value, "bimodal") == 0) opts->thrill_mode = THRILL_BIMODAL;
+            else {
+                fprintf(stderr, "Error: Unknown thrill mode '%s'\n", value);
+                return 0;
+            }
+        } else if (strcmp(arg, "--out") == 0) {
+            strncpy(opts->out_dir, value, MAX_PATH_LENGTH - 1);
+            opts->out_dir[MAX_PATH_LENGTH - 1] = '\0';
+        } else {
+            fprintf(stderr, "Error: Unknown option %s\n", arg);
+            return 0;
+        }
+        i++;
+    }
+
+    // Ride ids index fixed per-ride arrays in the park system
+    if (opts->rides < 1 || opts->rides >= MAX_RIDES) {
+        fprintf(stderr, "Error: --rides must be between 1 and %d\n", MAX_RIDES - 1);
+        return 0;
+    }
+    if (opts->visitors < 0 || opts->junctions < 1 ||
+        opts->junctions > MAX_GRAPH_NODES - MAX_RIDES) {
+        fprintf(stderr, "Error: --visitors must be >= 0 and --junctions 1..%d\n",
+                MAX_GRAPH_NODES - MAX_RIDES);
+        return 0;
+    }
+    if (opts->premium_percent < 0) opts->premium_percent = 0;
+    if (opts->premium_percent > 100) opts->premium_percent = 100;
+    if (opts->seed == 0) opts->seed = 1;  // xorshift must not start at zero
+
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    GenOptions opts;
+    if (!parseOptions(argc, argv, &opts)) {
+        printUsage();
+        return 1;
+    }
+
+    // Each file gets its own stream so changing one count doesn't reshuffle the others
+    rng_state = opts.seed;
+    if (!writeRides(&opts)) return 1;
+    rng_state = (opts.seed * 2654435761u) | 1;
+    if (!writeVisitors(&opts)) return 1;
+    rng_state = (opts.seed * 40503u + 7) | 1;
+    if (!writeParkMap(&opts)) return 1;
+
+    printf("Generated %d rides, %d visitors, %d junctions in %s/ (seed %u)\n",
+           opts.rides, opts.visitors, opts.junctions, opts.out_dir, opts.seed);
+    return 0;
+}
@@ -75,11 +75,12 @@ async function loadDashboard() {
         const stats = await statsRes.json();
         
         // Update dashboard stats
-        document.getElementById('total-visitors').textContent = visitors.length;
+        // The visitor list is paged; the park total comes from the stats
+        document.getElementById('total-visitors').textContent = stats.total_visitors;
         document.getElementById('total-rides').textContent = rides.filter(r => r.is_operational).length;
         document.getElementById('avg-wait').textContent = `${stats.avg_wait_time || 0} min`;
         document.getElementById('satisfaction').textContent = `${Math.round(stats.avg_satisfaction || 0)}%`;
-        document.getElementById('visitor-count').textContent = `Visitors: ${visitors.length}`;
+        document.getElementById('visitor-count').textContent = `Visitors: ${stats.total_visitors}`;
     } catch (error) {
         console.error('Error loading dashboard:', error);
         showNotification('Failed to load dashboard data', 'error');